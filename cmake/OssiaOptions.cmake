@@ -10,6 +10,7 @@ option(OSSIA_NO_SONAME "Set NO_SONAME property" ON)
 option(OSSIA_OSX_FAT_LIBRARIES "Build 32 and 64 bit fat libraries on OS X" OFF)
 option(OSSIA_OSX_RETROCOMPATIBILITY "Build for older OS X versions" OFF)
 option(OSSIA_DATAFLOW "Dataflow features" ON)
+option(OSSIA_AUDIO_FLOAT32 "Use 32-bit float samples in the dataflow audio ports (ABI-breaking)" OFF)
 option(OSSIA_EDITOR "Editor features" ON)
 option(OSSIA_GFX "Graphics features" ON)
 option(OSSIA_HIDE_ALL_SYMBOLS "Hide all symbols from the ossia lib" OFF)
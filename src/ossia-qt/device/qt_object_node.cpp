@@ -89,6 +89,7 @@ void qt_object_node::init(QObject& obj)
     std::move(
         children_vect.begin(), children_vect.end(),
         std::back_inserter(m_children));
+    children_changed();
   }
 }
 
@@ -116,6 +117,7 @@ void qt_object_node::childEvent(QChildEvent* event)
     {
       m_device.on_node_removing(**it);
       m_children.erase(it);
+      children_changed();
     }
   }
 }
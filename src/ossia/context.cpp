@@ -38,6 +38,12 @@ invalid_callback_error::~invalid_callback_error()
 {
 }
 
+detail::callback_send_frame*& detail::callback_send_stack() noexcept
+{
+  static thread_local callback_send_frame* top{};
+  return top;
+}
+
 static void ossia_global_init()
 {
   static bool init = false;
@@ -0,0 +1,88 @@
+#pragma once
+#include <ossia/dataflow/nodes/media.hpp>
+
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#define OSSIA_RESTRICT __restrict
+#elif defined(__GNUC__)
+#define OSSIA_RESTRICT __restrict__
+#else
+#define OSSIA_RESTRICT
+#endif
+
+/**
+ * \file audio_kernels.hpp
+ *
+ * Sample loops shared by the audio ports, the audio nodes and the audio
+ * protocols.
+ *
+ * They are written so that the compiler vectorizes them: the buffers must
+ * not overlap, and the gains are converted to the sample type of the
+ * destination beforehand so that float buffers are not processed as
+ * doubles.
+ *
+ * The source and destination sample types may differ, e.g. float device
+ * buffers and double audio ports.
+ */
+namespace ossia::audio_kernels
+{
+//! dst = src
+template <typename Src, typename Dst>
+inline void copy(
+    const Src* OSSIA_RESTRICT src, Dst* OSSIA_RESTRICT dst,
+    std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; i++)
+    dst[i] = Dst(src[i]);
+}
+
+//! dst = src * gain
+template <typename Src, typename Dst>
+inline void copy_gain(
+    const Src* OSSIA_RESTRICT src, Dst* OSSIA_RESTRICT dst, std::size_t n,
+    double gain) noexcept
+{
+  const Dst g = Dst(gain);
+  for (std::size_t i = 0; i < n; i++)
+    dst[i] = Dst(src[i]) * g;
+}
+
+//! dst += src
+template <typename Src, typename Dst>
+inline void mix(
+    const Src* OSSIA_RESTRICT src, Dst* OSSIA_RESTRICT dst,
+    std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; i++)
+    dst[i] += Dst(src[i]);
+}
+
+//! dst += src * gain
+template <typename Src, typename Dst>
+inline void mix_gain(
+    const Src* OSSIA_RESTRICT src, Dst* OSSIA_RESTRICT dst, std::size_t n,
+    double gain) noexcept
+{
+  const Dst g = Dst(gain);
+  for (std::size_t i = 0; i < n; i++)
+    dst[i] += Dst(src[i]) * g;
+}
+
+//! buf *= gain
+template <typename T>
+inline void gain(T* OSSIA_RESTRICT buf, std::size_t n, double gain) noexcept
+{
+  const T g = T(gain);
+  for (std::size_t i = 0; i < n; i++)
+    buf[i] *= g;
+}
+
+//! buf = 0
+template <typename T>
+inline void clear(T* OSSIA_RESTRICT buf, std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; i++)
+    buf[i] = T(0);
+}
+}
@@ -0,0 +1,551 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <ossia/dataflow/commit_dispatcher.hpp>
+#include <ossia/detail/algorithms.hpp>
+#include <ossia/detail/logger.hpp>
+#include <ossia/network/base/parameter.hpp>
+#include <ossia/network/base/protocol.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace ossia
+{
+struct commit_dispatcher::worker
+{
+  worker(ossia::net::protocol_base& p, std::size_t capacity)
+      : proto{p}, queue(capacity)
+  {
+    pending.reserve(capacity);
+    sorted.reserve(capacity);
+    bundle.reserve(capacity);
+    running = true;
+    thread = std::thread{[this] { run(); }};
+  }
+
+  ~worker()
+  {
+    stop();
+  }
+
+  // Control thread
+  void stop()
+  {
+    if (!thread.joinable())
+      return;
+
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      running = false;
+    }
+    wake.notify_one();
+    thread.join();
+  }
+
+  void sync()
+  {
+    const uint64_t closed = ticks.load(std::memory_order_acquire);
+    wake.notify_one();
+
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [&] {
+      return !running || finished.load(std::memory_order_acquire)
+             || sent_ticks.load(std::memory_order_acquire) >= closed;
+    });
+  }
+
+  void remove_parameter(const ossia::net::parameter_base& param)
+  {
+    // Waits if a bundle is being sent. The messages queued from now on
+    // cannot refer to the removed parameter.
+    std::lock_guard<std::mutex> lock{send_mutex};
+    tombstones.push_back({&param, enqueued.load(std::memory_order_acquire)});
+  }
+
+  void add_metrics(commit_dispatch_metrics& m) const noexcept
+  {
+    m.queued += queued.load(std::memory_order_relaxed);
+    m.dropped += dropped.load(std::memory_order_relaxed);
+    m.coalesced += coalesced.load(std::memory_order_relaxed);
+    m.sent += sent.load(std::memory_order_relaxed);
+    m.batches += batches.load(std::memory_order_relaxed);
+  }
+
+  void reset_metrics() noexcept
+  {
+    queued.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    coalesced.store(0, std::memory_order_relaxed);
+    sent.store(0, std::memory_order_relaxed);
+    batches.store(0, std::memory_order_relaxed);
+  }
+
+  // Execution thread
+  bool enqueue(const ossia::net::parameter_base& param) noexcept
+  {
+    queued.fetch_add(1, std::memory_order_relaxed);
+    if (queue.try_enqueue(&param))
+    {
+      enqueued.fetch_add(1, std::memory_order_release);
+      open = true;
+      return true;
+    }
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  void end_tick() noexcept
+  {
+    // nullptr closes the batch. If there is no room for it the messages will
+    // be sent with the ones of the next tick.
+    if (!open || !queue.try_enqueue(nullptr))
+      return;
+
+    enqueued.fetch_add(1, std::memory_order_release);
+    open = false;
+    ticks.fetch_add(1, std::memory_order_release);
+    // Does not lock: at worst the worker wakes up on its timeout
+    wake.notify_one();
+  }
+
+  //! The worker sends the messages of the closed batches, and stops
+  void retire() noexcept
+  {
+    if (retired)
+      return;
+    retired = true;
+
+    end_tick();
+    stopping.store(true, std::memory_order_release);
+    wake.notify_one();
+  }
+
+  // Worker thread
+  void run()
+  {
+    using namespace std::chrono_literals;
+    for (;;)
+    {
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        wake.wait_for(lock, 10ms, [&] {
+          return !running || stopping.load(std::memory_order_acquire)
+                 || ticks.load(std::memory_order_acquire)
+                        != sent_ticks.load(std::memory_order_relaxed);
+        });
+        if (!running || stopping.load(std::memory_order_acquire))
+          break;
+      }
+      process();
+    }
+
+    // Send what remains before stopping
+    process();
+
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      finished.store(true, std::memory_order_release);
+    }
+    done.notify_all();
+  }
+
+  void process()
+  {
+    const uint64_t closed = ticks.load(std::memory_order_acquire);
+
+    // Every message before the last nullptr can be sent
+    std::size_t ready = 0;
+    const ossia::net::parameter_base* p{};
+    while (queue.try_dequeue(p))
+    {
+      const uint64_t index = dequeued++;
+      if (p)
+        pending.push_back({p, index});
+      else
+        ready = pending.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{send_mutex};
+      if (!tombstones.empty())
+        ready = discard_removed(ready);
+
+      if (ready > 0)
+      {
+        send(ready);
+        pending.erase(pending.begin(), pending.begin() + ready);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (closed > sent_ticks.load(std::memory_order_relaxed))
+        sent_ticks.store(closed, std::memory_order_release);
+    }
+    done.notify_all();
+  }
+
+  // Removes the messages queued before their parameter was removed, and
+  // returns the new number of ready messages. Under send_mutex.
+  std::size_t discard_removed(std::size_t ready)
+  {
+    auto removed = [&](const entry& e) {
+      for (const auto& t : tombstones)
+        if (t.param == e.param && e.index < t.mark)
+          return true;
+      return false;
+    };
+
+    std::size_t kept = 0;
+    std::size_t kept_ready = 0;
+    for (std::size_t i = 0; i < pending.size(); i++)
+    {
+      if (removed(pending[i]))
+        continue;
+      if (i < ready)
+        kept_ready++;
+      pending[kept++] = pending[i];
+    }
+    dropped.fetch_add(pending.size() - kept, std::memory_order_relaxed);
+    pending.resize(kept);
+
+    // Once all the messages queued before the removal were seen, the
+    // address may be used by a new parameter
+    tombstones.erase(
+        std::remove_if(
+            tombstones.begin(), tombstones.end(),
+            [&](const auto& t) { return t.mark <= dequeued; }),
+        tombstones.end());
+
+    return kept_ready;
+  }
+
+  void send(std::size_t ready)
+  {
+    // Each parameter is sent once, in the order of its first message
+    sorted.clear();
+    for (std::size_t i = 0; i < ready; i++)
+      sorted.emplace_back(pending[i].param, i);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(
+        std::unique(
+            sorted.begin(), sorted.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.first == rhs.first;
+            }),
+        sorted.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.second < rhs.second;
+    });
+
+    bundle.clear();
+    for (const auto& [param, idx] : sorted)
+      bundle.push_back(param);
+
+    coalesced.fetch_add(ready - bundle.size(), std::memory_order_relaxed);
+
+    try
+    {
+      proto.push_bundle(bundle);
+      proto.flush();
+    }
+    catch (const std::exception& e)
+    {
+      ossia::logger().error("commit_dispatcher: {}", e.what());
+    }
+    catch (...)
+    {
+      ossia::logger().error("commit_dispatcher: error while sending");
+    }
+
+    sent.fetch_add(bundle.size(), std::memory_order_relaxed);
+    batches.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  struct entry
+  {
+    const ossia::net::parameter_base* param{};
+    //! Position in the queue, counting the batch ends
+    uint64_t index{};
+  };
+
+  struct tombstone
+  {
+    const ossia::net::parameter_base* param{};
+    //! Number of messages queued when the parameter was removed
+    uint64_t mark{};
+  };
+
+  ossia::net::protocol_base& proto;
+  ossia::spsc_queue<const ossia::net::parameter_base*> queue;
+
+  // Only used by the control thread
+  bool removed{};
+
+  // Only used by the execution thread
+  bool open{};
+  bool retired{};
+
+  // Only used by the worker thread
+  std::vector<entry> pending;
+  std::vector<std::pair<const ossia::net::parameter_base*, std::size_t>>
+      sorted;
+  std::vector<const ossia::net::parameter_base*> bundle;
+  uint64_t dequeued{};
+
+  // Held while a bundle is being sent
+  std::mutex send_mutex;
+  std::vector<tombstone> tombstones;
+
+  // Number of messages queued, batch ends included
+  std::atomic<uint64_t> enqueued{};
+
+  // Number of batches closed by the execution thread, and sent by the worker
+  std::atomic<uint64_t> ticks{};
+  std::atomic<uint64_t> sent_ticks{};
+
+  std::atomic<uint64_t> queued{};
+  std::atomic<uint64_t> dropped{};
+  std::atomic<uint64_t> coalesced{};
+  std::atomic<uint64_t> sent{};
+  std::atomic<uint64_t> batches{};
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool running{};
+  std::thread thread;
+
+  // Set by the execution thread when retiring the worker
+  std::atomic_bool stopping{};
+  // Set by the worker thread after its last bundle
+  std::atomic_bool finished{};
+  // Set by the execution thread once it does not refer to the worker anymore
+  std::atomic_bool released{};
+};
+
+commit_dispatcher::commit_dispatcher(std::size_t capacity)
+    : m_capacity{capacity}
+{
+}
+
+commit_dispatcher::~commit_dispatcher()
+{
+  clear();
+}
+
+commit_dispatcher::worker*
+commit_dispatcher::find(const net::protocol_base& proto) const noexcept
+{
+  if (m_current)
+    for (auto w : m_current->workers)
+      if (&w->proto == &proto)
+        return w;
+  return nullptr;
+}
+
+void commit_dispatcher::add_protocol(net::protocol_base& proto)
+{
+  collect();
+  for (auto& w : m_workers)
+    if (&w->proto == &proto && !w->removed)
+      return;
+
+  auto w = std::make_unique<worker>(proto, m_capacity);
+  {
+    ossia::lock_t lock{m_workersMutex};
+    m_workers.push_back(std::move(w));
+  }
+  publish();
+}
+
+void commit_dispatcher::remove_protocol(net::protocol_base& proto)
+{
+  collect();
+  auto it = ossia::find_if(m_workers, [&](const auto& w) {
+    return &w->proto == &proto && !w->removed;
+  });
+  if (it == m_workers.end())
+    return;
+
+  (*it)->removed = true;
+  m_removed.push_back(it->get());
+  publish();
+}
+
+void commit_dispatcher::remove_parameter(const net::parameter_base& param)
+{
+  auto& proto = param.get_node().get_device().get_protocol();
+
+  ossia::lock_t lock{m_workersMutex};
+  for (auto& w : m_workers)
+    if (&w->proto == &proto)
+      w->remove_parameter(param);
+}
+
+void commit_dispatcher::publish()
+{
+  auto t = std::make_unique<table>();
+  for (auto& w : m_workers)
+    if (!w->removed)
+      t->workers.push_back(w.get());
+  t->removed = m_removed;
+
+  table* previous = m_next.exchange(t.get(), std::memory_order_acq_rel);
+  if (previous)
+  {
+    // Never taken by the execution thread: its removed workers are in the
+    // new table too
+    ossia::remove_erase_if(
+        m_tables, [=](const auto& tbl) { return tbl.get() == previous; });
+  }
+  else if (m_lastPublished)
+  {
+    // Taken: the execution thread retires its removed workers
+    for (auto w : m_lastPublished->removed)
+      ossia::remove_erase(m_removed, w);
+  }
+
+  m_lastPublished = t.get();
+  m_tables.push_back(std::move(t));
+}
+
+void commit_dispatcher::collect()
+{
+  // The tables before the one in use cannot be taken anymore
+  const table* in_use = m_inUse.load(std::memory_order_acquire);
+  auto it = ossia::find_if(
+      m_tables, [=](const auto& tbl) { return tbl.get() == in_use; });
+  if (it != m_tables.end())
+    m_tables.erase(m_tables.begin(), it);
+
+  // The workers released by the execution thread have already stopped. They
+  // may still be in the removed list of a table which was not taken yet.
+  auto referenced = [&](const worker* w) {
+    for (auto& tbl : m_tables)
+      if (ossia::contains(tbl->removed, w))
+        return true;
+    return false;
+  };
+
+  ossia::lock_t lock{m_workersMutex};
+  for (auto w_it = m_workers.begin(); w_it != m_workers.end();)
+  {
+    auto& w = *w_it;
+    if (w->released.load(std::memory_order_acquire) && !referenced(w.get()))
+    {
+      w->stop();
+      w->add_metrics(m_removedMetrics);
+      ossia::remove_erase(m_removed, w.get());
+      w_it = m_workers.erase(w_it);
+    }
+    else
+    {
+      ++w_it;
+    }
+  }
+}
+
+void commit_dispatcher::clear()
+{
+  {
+    ossia::lock_t lock{m_workersMutex};
+    for (auto& w : m_workers)
+    {
+      // Sends the last messages
+      w->end_tick();
+      w->stop();
+      w->add_metrics(m_removedMetrics);
+    }
+    m_workers.clear();
+  }
+
+  m_removed.clear();
+  m_next.store(nullptr, std::memory_order_release);
+  m_inUse.store(nullptr, std::memory_order_release);
+  m_tables.clear();
+  m_lastPublished = nullptr;
+
+  m_current = nullptr;
+  m_stopping.clear();
+}
+
+void commit_dispatcher::update() noexcept
+{
+  if (table* t = m_next.exchange(nullptr, std::memory_order_acq_rel))
+  {
+    for (auto w : t->removed)
+    {
+      if (!w->retired)
+      {
+        w->retire();
+        m_stopping.push_back(w);
+      }
+    }
+    m_current = t;
+    m_inUse.store(t, std::memory_order_release);
+  }
+
+  for (auto it = m_stopping.begin(); it != m_stopping.end();)
+  {
+    if ((*it)->finished.load(std::memory_order_acquire))
+    {
+      (*it)->released.store(true, std::memory_order_release);
+      it = m_stopping.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+bool commit_dispatcher::stopped(const net::protocol_base& proto) noexcept
+{
+  if (find(proto))
+    return false;
+  for (auto w : m_stopping)
+    if (&w->proto == &proto)
+      return false;
+  return true;
+}
+
+bool commit_dispatcher::enqueue(const net::parameter_base& param) noexcept
+{
+  auto& proto = param.get_node().get_device().get_protocol();
+  if (auto w = find(proto))
+    return w->enqueue(param);
+  return false;
+}
+
+void commit_dispatcher::end_tick() noexcept
+{
+  if (m_current)
+    for (auto w : m_current->workers)
+      w->end_tick();
+}
+
+void commit_dispatcher::sync()
+{
+  ossia::lock_t lock{m_workersMutex};
+  for (auto& w : m_workers)
+    w->sync();
+}
+
+commit_dispatch_metrics commit_dispatcher::metrics() const noexcept
+{
+  ossia::lock_t lock{m_workersMutex};
+  commit_dispatch_metrics m = m_removedMetrics;
+  for (auto& w : m_workers)
+    w->add_metrics(m);
+  return m;
+}
+
+void commit_dispatcher::reset_metrics() noexcept
+{
+  ossia::lock_t lock{m_workersMutex};
+  m_removedMetrics = {};
+  for (auto& w : m_workers)
+    w->reset_metrics();
+}
+}
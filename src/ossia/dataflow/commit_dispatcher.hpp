@@ -0,0 +1,156 @@
+#pragma once
+#include <ossia/detail/config.hpp>
+#include <ossia/detail/lockfree_queue.hpp>
+#include <ossia/detail/mutex.hpp>
+#include <ossia/detail/small_vector.hpp>
+
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ossia
+{
+namespace net
+{
+class parameter_base;
+class protocol_base;
+}
+
+//! Counters of a commit_dispatcher, summed over all the protocols
+struct commit_dispatch_metrics
+{
+  //! Messages given to the dispatcher
+  uint64_t queued{};
+  //! Messages which did not fit in the queue of their protocol, or whose
+  //! parameter was removed before they were sent
+  uint64_t dropped{};
+  //! Messages merged with a later message to the same parameter
+  uint64_t coalesced{};
+  //! Parameters sent by the workers
+  uint64_t sent{};
+  //! Bundles sent by the workers
+  uint64_t batches{};
+};
+
+/**
+ * @brief Sends the messages of execution_state to the protocols from worker
+ * threads.
+ *
+ * Each protocol gets a worker thread and a single-producer queue. During a
+ * commit, the execution thread sets the local value of the parameters, and
+ * enqueues them with enqueue(); end_tick() closes the batch of the tick.
+ * The worker then sends each batch with protocol_base::push_bundle, followed
+ * by protocol_base::flush, so that a slow protocol does not block the
+ * execution thread nor the other protocols.
+ *
+ * enqueue() and end_tick() do not wait nor allocate: if a queue is full, the
+ * message is dropped and counted. A parameter written many times during a
+ * tick, or in ticks which were not sent yet, is only sent once with its
+ * latest value.
+ *
+ * The workers are started and joined by the control thread, in
+ * add_protocol and remove_protocol, which also build the table of workers
+ * used by the execution thread. The execution thread only takes the latest
+ * table in update(), and asks the workers which are not in it anymore to
+ * send their last messages and stop.
+ */
+class OSSIA_EXPORT commit_dispatcher
+{
+public:
+  //! Capacity of the queue of each protocol, in messages
+  explicit commit_dispatcher(std::size_t capacity = 4096);
+  ~commit_dispatcher();
+
+  commit_dispatcher(const commit_dispatcher&) = delete;
+  commit_dispatcher& operator=(const commit_dispatcher&) = delete;
+
+  /// To be called from the control thread ///
+
+  //! Starts a worker for a protocol, if there is none yet
+  void add_protocol(ossia::net::protocol_base& proto);
+
+  //! Removes the worker of a protocol from the table of the execution
+  //! thread. It is joined once it has sent its last messages, in a later
+  //! call to add_protocol, remove_protocol or clear.
+  void remove_protocol(ossia::net::protocol_base& proto);
+
+  /**
+   * @brief To call before a parameter is deleted.
+   *
+   * The messages of the parameter which are still queued are discarded.
+   * Only waits if the worker of its protocol is sending a bundle.
+   */
+  void remove_parameter(const ossia::net::parameter_base& param);
+
+  //! Stops and joins all the workers. The execution thread must not be
+  //! running.
+  void clear();
+
+  /// To be called from the execution thread ///
+
+  //! Takes the latest table of workers built by the control thread
+  void update() noexcept;
+
+  bool has_protocol(const ossia::net::protocol_base& proto) const noexcept
+  {
+    return find(proto) != nullptr;
+  }
+
+  //! True once a protocol has no worker anymore, and its previous worker
+  //! has sent its last messages: its execution can then be stopped.
+  bool stopped(const ossia::net::protocol_base& proto) noexcept;
+
+  //! Queues a parameter whose value was set, to be pushed to its protocol.
+  //! Returns false if the protocol has no worker or if its queue is full.
+  bool enqueue(const ossia::net::parameter_base& param) noexcept;
+
+  //! Marks the end of the messages of a tick: they can be sent
+  void end_tick() noexcept;
+
+  /// Thread-safe ///
+
+  //! Blocks until the workers have sent all the messages closed so far.
+  void sync();
+
+  commit_dispatch_metrics metrics() const noexcept;
+  void reset_metrics() noexcept;
+
+private:
+  struct worker;
+  struct table
+  {
+    std::vector<worker*> workers;
+    //! Removed since the last table taken by the execution thread
+    std::vector<worker*> removed;
+  };
+
+  worker* find(const ossia::net::protocol_base& proto) const noexcept;
+  void publish();
+  void collect();
+
+  std::size_t m_capacity{};
+
+  // Control thread; the mutex is there for sync() and the metrics
+  std::vector<std::unique_ptr<worker>> m_workers;
+  std::vector<worker*> m_removed;
+  mutable ossia::mutex_t m_workersMutex;
+
+  // Published tables, in order. Those before m_inUse are freed in collect()
+  std::vector<std::unique_ptr<table>> m_tables;
+  table* m_lastPublished{};
+
+  // Tables exchanged between the control and the execution thread
+  std::atomic<table*> m_next{};
+  std::atomic<table*> m_inUse{};
+
+  // Execution thread
+  table* m_current{};
+  ossia::small_vector<worker*, 4> m_stopping;
+
+  // Metrics of the workers which were removed
+  commit_dispatch_metrics m_removedMetrics;
+};
+}
@@ -3,6 +3,7 @@
 #include <ossia/detail/algorithms.hpp>
 #include <ossia/network/base/parameter.hpp>
 #include <ossia/dataflow/audio_port.hpp>
+#include <ossia/dataflow/audio_kernels.hpp>
 #include <ossia/dataflow/value_port.hpp>
 #include <ossia/dataflow/midi_port.hpp>
 namespace ossia
@@ -65,12 +66,7 @@ void mix(const audio_vector& src_vec, audio_vector& sink_vec)
   {
     auto& src = src_vec[chan];
     auto& sink = sink_vec[chan];
-    const std::size_t N = src.size();
-    auto src_p = src.data();
-    auto sink_p = sink.data();
-
-    for (std::size_t i = 0; i < N; i++)
-      sink_p[i] += src_p[i];
+    audio_kernels::mix(src.data(), sink.data(), src.size());
   }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <ossia/dataflow/dataflow_fwd.hpp>
+#include <ossia/dataflow/path_cache.hpp>
 #include <ossia/network/base/node.hpp>
 #include <ossia/network/common/path.hpp>
 
@@ -11,9 +12,11 @@ struct do_nothing_for_nodes {
   void operator()(ossia::net::node_base* node, bool) const noexcept { }
 };
 
-template <typename Fun, typename NodeFun, typename DeviceList_T>
+namespace detail
+{
+template <typename Resolve, typename Fun, typename NodeFun>
 bool apply_to_destination(
-    const destination_t& address, const DeviceList_T& devices, Fun f, NodeFun nf)
+    const destination_t& address, Resolve&& resolve, Fun& f, NodeFun& nf)
 {
   switch (address.which())
   {
@@ -27,16 +30,11 @@ bool apply_to_destination(
     // ossia::traversal::path
     case 1:
     {
-      std::vector<ossia::net::node_base*> roots{};
+      const std::vector<ossia::net::node_base*>& nodes
+          = resolve(*address.target<ossia::traversal::path>());
 
-      for (auto n : devices)
-        roots.push_back(&n->get_root_node());
-
-      auto& p = *address.target<ossia::traversal::path>();
-      ossia::traversal::apply(p, roots);
-
-      const bool unique = roots.size() == 1;
-      for (auto n : roots)
+      const bool unique = nodes.size() == 1;
+      for (auto n : nodes)
         if (auto addr = n->get_parameter())
           f(addr, unique);
         else
@@ -57,3 +55,59 @@ bool apply_to_destination(
   }
 }
 }
+
+/**
+ * @brief Nodes of the devices matching a path.
+ *
+ * The path is only matched again if the cache was filled for another
+ * pattern or another generation of the device trees.
+ */
+template <typename DeviceList_T>
+const std::vector<ossia::net::node_base*>& resolve_path(
+    const ossia::traversal::path& p, const DeviceList_T& devices,
+    uint64_t generation, path_cache& cache)
+{
+  if (cache.generation != generation || cache.pattern != p.pattern)
+  {
+    cache.nodes.clear();
+    for (auto n : devices)
+      cache.nodes.push_back(&n->get_root_node());
+
+    ossia::traversal::apply(p, cache.nodes);
+    cache.pattern = p.pattern;
+    cache.generation = generation;
+  }
+  return cache.nodes;
+}
+
+template <typename Fun, typename NodeFun, typename DeviceList_T>
+bool apply_to_destination(
+    const destination_t& address, const DeviceList_T& devices, Fun f, NodeFun nf)
+{
+  std::vector<ossia::net::node_base*> roots{};
+  return detail::apply_to_destination(
+      address,
+      [&](const ossia::traversal::path& p) -> auto& {
+        for (auto n : devices)
+          roots.push_back(&n->get_root_node());
+
+        ossia::traversal::apply(p, roots);
+        return roots;
+      },
+      f, nf);
+}
+
+//! Same as above, but paths are resolved through the cache of the port.
+template <typename Fun, typename NodeFun, typename DeviceList_T>
+bool apply_to_destination(
+    const destination_t& address, const DeviceList_T& devices,
+    uint64_t generation, path_cache& cache, Fun f, NodeFun nf)
+{
+  return detail::apply_to_destination(
+      address,
+      [&](const ossia::traversal::path& p) -> auto& {
+        return resolve_path(p, devices, generation, cache);
+      },
+      f, nf);
+}
+}
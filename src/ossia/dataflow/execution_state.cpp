@@ -18,6 +18,9 @@
 #include <ossia/network/midi/detail/midi_impl.hpp>
 #include <ossia/dataflow/typed_value.hpp>
 
+#include <algorithm>
+#include <tuple>
+
 namespace ossia
 {
 struct local_pull_visitor
@@ -192,17 +195,26 @@ struct global_pull_node_visitor
 
 execution_state::~execution_state()
 {
+  m_dispatcher.clear();
   for(auto dev : m_devices_exec)
     dev->get_protocol().stop_execution();
+  for(auto dev : m_devices_stopping)
+    dev->get_protocol().stop_execution();
 }
 
 void execution_state::clear_devices()
 {
+  for (auto dev : m_devices_edit)
+    disconnect_device(*dev);
   m_devices_edit.clear();
 
+  m_dispatcher.clear();
   for(auto dev : m_devices_exec)
     dev->get_protocol().stop_execution();
+  for(auto dev : m_devices_stopping)
+    dev->get_protocol().stop_execution();
   m_devices_exec.clear();
+  m_devices_stopping.clear();
 }
 
 execution_state::execution_state()
@@ -212,11 +224,21 @@ execution_state::execution_state()
   m_midiState.reserve(4);
 }
 
+// Audio and MIDI are sent sample-accurately from commit_common
+static bool is_dispatched(const ossia::net::protocol_base& proto) noexcept
+{
+  return !dynamic_cast<const ossia::audio_protocol*>(&proto)
+         && !dynamic_cast<const ossia::net::midi::midi_protocol*>(&proto);
+}
+
 void execution_state::register_device(net::device_base* d)
 {
   if (d)
   {
     m_devices_edit.push_back(d);
+    connect_device(*d);
+    if (m_dispatchedCommits && is_dispatched(d->get_protocol()))
+      m_dispatcher.add_protocol(d->get_protocol());
     m_device_change_queue.enqueue({device_operation::REGISTER, d});
   }
 }
@@ -226,10 +248,51 @@ void execution_state::unregister_device(net::device_base* d)
   if (d)
   {
     ossia::remove_erase(m_devices_edit, d);
+    disconnect_device(*d);
+    m_dispatcher.remove_protocol(d->get_protocol());
     m_device_change_queue.enqueue({device_operation::UNREGISTER, d});
   }
 }
 
+void execution_state::connect_device(net::device_base& d)
+{
+  d.on_node_created.connect<&execution_state::on_node_created>(*this);
+  d.on_node_removing.connect<&execution_state::on_node_removing>(*this);
+  d.on_parameter_removing.connect<&execution_state::on_parameter_removing>(
+      *this);
+  d.on_node_renamed.connect<&execution_state::on_node_renamed>(*this);
+}
+
+void execution_state::disconnect_device(net::device_base& d)
+{
+  d.on_node_created.disconnect<&execution_state::on_node_created>(*this);
+  d.on_node_removing.disconnect<&execution_state::on_node_removing>(*this);
+  d.on_parameter_removing
+      .disconnect<&execution_state::on_parameter_removing>(*this);
+  d.on_node_renamed.disconnect<&execution_state::on_node_renamed>(*this);
+}
+
+void execution_state::on_node_created(net::node_base&)
+{
+  m_treeGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void execution_state::on_node_removing(net::node_base&)
+{
+  m_treeGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void execution_state::on_parameter_removing(const net::parameter_base& p)
+{
+  // The workers of commit_dispatched must not send the parameter anymore
+  m_dispatcher.remove_parameter(p);
+}
+
+void execution_state::on_node_renamed(net::node_base&, std::string)
+{
+  m_treeGeneration.fetch_add(1, std::memory_order_release);
+}
+
 void execution_state::register_parameter(net::parameter_base& p)
 {
   auto device = &p.get_node().get_device();
@@ -237,7 +300,7 @@ void execution_state::register_parameter(net::parameter_base& p)
   {
     if (&q.device == device)
     {
-      q.reg(p);
+      q.reg(p, receivedValuesPolicy);
       break;
     }
   }
@@ -284,6 +347,18 @@ void execution_state::unregister_midi_parameter(net::midi::midi_protocol& p)
   }
 }
 
+message_queue_stats execution_state::received_values_stats() const noexcept
+{
+  message_queue_stats res;
+  for (auto& mq : m_valueQueues)
+  {
+    auto st = mq.stats();
+    res.dropped += st.dropped;
+    res.coalesced += st.coalesced;
+  }
+  return res;
+}
+
 void execution_state::get_new_values()
 {
   for (auto it = m_receivedValues.begin(), end = m_receivedValues.end();
@@ -352,7 +427,25 @@ void execution_state::register_port(const inlet& port)
 
 void execution_state::register_port(const outlet& port)
 {
-  // nothing to do
+  // Gives a slot to the written parameter ahead of the execution
+  auto addr = port.address.target<ossia::net::parameter_base*>();
+  if (!addr)
+    return;
+
+  OSSIA_EXEC_STATE_LOCK_WRITE(*this);
+  if (port.target<ossia::value_port>())
+  {
+    m_valueState.slot(*addr);
+  }
+  else if (port.target<ossia::audio_port>())
+  {
+    if (auto ap = dynamic_cast<ossia::audio_parameter*>(*addr))
+      m_audioState.slot(ap);
+  }
+  else if (port.target<ossia::midi_port>())
+  {
+    m_midiState.slot(*addr);
+  }
 }
 
 
@@ -408,28 +501,54 @@ void execution_state::unregister_port(const outlet& port)
 
 void execution_state::apply_device_changes()
 {
+  m_dispatcher.update();
+
   device_operation op;
   while (m_device_change_queue.try_dequeue(op))
   {
     switch (op.operation)
     {
       case device_operation::REGISTER:
+        if (ossia::contains(m_devices_stopping, op.device))
+        {
+          ossia::remove_erase(m_devices_stopping, op.device);
+          op.device->get_protocol().stop_execution();
+        }
         op.device->get_protocol().start_execution();
         m_devices_exec.push_back(op.device);
         m_valueQueues.emplace_back(*op.device);
         break;
       case device_operation::UNREGISTER:
       {
-        op.device->get_protocol().stop_execution();
         ossia::remove_erase(m_devices_exec, op.device);
         auto it = ossia::find_if(
             m_valueQueues, [&](auto& mq) { return &mq.device == op.device; });
         if (it != m_valueQueues.end())
           m_valueQueues.erase(it);
 
+        // The worker of commit_dispatched may still be sending its last
+        // messages
+        m_devices_stopping.push_back(op.device);
         break;
       }
     }
+
+    // The paths may now match nodes of other devices
+    m_treeGeneration.fetch_add(1, std::memory_order_release);
+  }
+
+  for (auto it = m_devices_stopping.begin(); it != m_devices_stopping.end();)
+  {
+    auto& proto = (*it)->get_protocol();
+    if (m_dispatcher.stopped(proto))
+    {
+      proto.stop_execution();
+      it = m_devices_stopping.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
 }
 void execution_state::begin_tick()
@@ -484,7 +603,7 @@ to_state_element(ossia::net::parameter_base& p, const ossia::typed_value& v)
 
 void execution_state::commit_common()
 {
-  for (auto& elt : m_audioState)
+  for (auto& elt : m_audioState.dirty())
   {
     assert(elt.first);
     elt.first->push_value(elt.second);
@@ -495,7 +614,7 @@ void execution_state::commit_common()
     }
   }
 
-  for (auto& elt : m_midiState)
+  for (auto& elt : m_midiState.dirty())
   {
     if (!elt.second.empty())
     {
@@ -511,6 +630,18 @@ void execution_state::commit_common()
       elt.second.clear();
     }
   }
+
+  m_valueState.clear_dirty();
+  m_audioState.clear_dirty();
+  m_midiState.clear_dirty();
+
+  for (auto dev : m_devices_exec)
+  {
+    // The workers of commit_dispatched flush their protocol themselves
+    auto& proto = dev->get_protocol();
+    if (!m_dispatcher.has_protocol(proto))
+      proto.flush();
+  }
 }
 
 void execution_state::advance_tick(std::size_t t)
@@ -544,8 +675,8 @@ void execution_state::advance_tick(std::size_t t)
 void execution_state::commit_merged()
 {
   // int i = 0;
-  for (auto it = m_valueState.begin(), end = m_valueState.end(); it != end;
-       ++it)
+  auto dirty = m_valueState.dirty();
+  for (auto it = dirty.begin(), end = dirty.end(); it != end; ++it)
   {
     switch (it->second.size())
     {
@@ -579,8 +710,8 @@ void execution_state::commit()
 {
   state_flatten_visitor<ossia::flat_vec_state, false, true> vis{
       m_commitOrderedState};
-  for (auto it = m_valueState.begin(), end = m_valueState.end(); it != end;
-       ++it)
+  auto dirty = m_valueState.dirty();
+  for (auto it = dirty.begin(), end = dirty.end(); it != end; ++it)
   {
     switch (it->second.size())
     {
@@ -611,87 +742,170 @@ void execution_state::commit()
   commit_common();
 }
 
-void execution_state::commit_priorized()
+void execution_state::commit_sorted(bool priorized)
 {
-  // Here we use the priority of each node
-  ossia::flat_map<
-      std::tuple<ossia::net::priority, int64_t, int>,
-      std::vector<ossia::state_element>>
-      m_priorizedMessagesCache;
-  for (auto it = m_valueState.begin(), end = m_valueState.end(); it != end;
-       ++it)
+  m_commitArena.clear();
+  m_commitEntries.clear();
+
+  state_flatten_visitor<ossia::flat_vec_state, false, true> vis{
+      m_commitOrderedState};
+  auto dirty = m_valueState.dirty();
+  for (auto it = dirty.begin(), end = dirty.end(); it != end; ++it)
   {
+    if (it->second.empty())
+      continue;
+
     m_commitOrderedState.clear();
     m_commitOrderedState.reserve(it->second.size());
-    state_flatten_visitor<ossia::flat_vec_state, false, true> vis{
-        m_commitOrderedState};
 
-    int64_t cur_ts = 0; // timestamp
-    int cur_ms = 0;     // message stamp
-    int cur_prio = 0;
-    if (const auto& p = ossia::net::get_priority(it->first->get_node()))
-      cur_prio = *p;
+    commit_entry entry;
+    if (priorized)
+    {
+      if (const auto& p = ossia::net::get_priority(it->first->get_node()))
+        entry.priority = *p;
+    }
 
     for (auto& val : it->second)
     {
-      cur_ms = std::max(cur_ms, val.second);
-      cur_ts = std::max(cur_ts, val.first.timestamp);
+      entry.message_stamp = std::max(entry.message_stamp, val.second);
+      entry.timestamp = std::max(entry.timestamp, val.first.timestamp);
       vis(to_state_element(*it->first, std::move(val.first)));
     }
 
-    auto& idx
-        = m_priorizedMessagesCache[std::make_tuple(cur_prio, cur_ts, cur_ms)];
+    entry.first = m_commitArena.size();
     for (auto& e : m_commitOrderedState)
-      idx.push_back(std::move(e));
+      m_commitArena.push_back(std::move(e));
+    entry.last = m_commitArena.size();
+    m_commitEntries.push_back(entry);
 
     it->second.clear();
   }
 
-  for (auto& vec : m_priorizedMessagesCache.container)
+  // Messages with the same key keep the order of m_valueState
+  std::sort(
+      m_commitEntries.begin(), m_commitEntries.end(),
+      [](const commit_entry& lhs, const commit_entry& rhs) {
+        return std::tie(
+                   lhs.priority, lhs.timestamp, lhs.message_stamp, lhs.first)
+               < std::tie(
+                   rhs.priority, rhs.timestamp, rhs.message_stamp, rhs.first);
+      });
+
+  for (const auto& entry : m_commitEntries)
   {
-    for (auto& mess : vec.second)
-      ossia::launch(mess);
-    vec.second.clear();
+    for (std::size_t i = entry.first; i < entry.last; i++)
+      ossia::launch(m_commitArena[i]);
   }
+  m_commitArena.clear();
 
   commit_common();
 }
 
+void execution_state::commit_priorized()
+{
+  // Here we use the priority of each node
+  commit_sorted(true);
+}
+
 void execution_state::commit_ordered()
 {
   // TODO same for midi
-  // m_flatMessagesCache.reserve(m_valueState.size());
-  for (auto it = m_valueState.begin(), end = m_valueState.end(); it != end;
-       ++it)
+  commit_sorted(false);
+}
+
+namespace
+{
+struct dispatch_resolve_visitor
+{
+  ossia::value operator()(ossia::state& st) const
   {
-    m_commitOrderedState.clear();
-    m_commitOrderedState.reserve(it->second.size());
-    state_flatten_visitor<ossia::flat_vec_state, false, true> vis{
-        m_commitOrderedState};
+    st.launch();
+    return {};
+  }
 
-    int64_t cur_ts = 0; // timestamp
-    int cur_ms = 0;     // message stamp
-    for (auto& val : it->second)
-    {
-      cur_ms = std::max(cur_ms, val.second);
-      cur_ts = std::max(cur_ts, val.first.timestamp);
-      vis(to_state_element(*it->first, std::move(val.first)));
-    }
+  template <typename T>
+  ossia::value operator()(T& msg) const
+  {
+    return msg.resolve();
+  }
 
-    auto& idx = m_flatMessagesCache[std::make_pair(cur_ts, cur_ms)];
-    for (auto& e : m_commitOrderedState)
-      idx.push_back(std::move(e));
+  ossia::value operator()() const
+  {
+    return {};
+  }
+};
+}
 
-    it->second.clear();
+void execution_state::set_dispatched_commits(bool b)
+{
+  m_dispatchedCommits = b;
+  for (auto dev : m_devices_edit)
+  {
+    auto& proto = dev->get_protocol();
+    if (b && is_dispatched(proto))
+      m_dispatcher.add_protocol(proto);
+    else if (!b)
+      m_dispatcher.remove_protocol(proto);
+  }
+}
+
+void execution_state::dispatch(
+    ossia::net::parameter_base& param, ossia::value&& v)
+{
+  if (!v.valid())
+    return;
+
+  auto& proto = param.get_node().get_device().get_protocol();
+  if (!m_dispatcher.has_protocol(proto))
+  {
+    param.push_value(std::move(v));
+    return;
   }
 
-  for (auto& vec : m_flatMessagesCache.container)
+  // The local value and the callbacks are updated right away, the worker of
+  // the protocol sends the latest value of the parameter.
+  if (param.set_value(std::move(v)).valid())
+    m_dispatcher.enqueue(param);
+}
+
+void execution_state::commit_dispatched()
+{
+  m_dispatcher.update();
+
+  state_flatten_visitor<ossia::flat_vec_state, false, true> vis{
+      m_commitOrderedState};
+  auto dirty = m_valueState.dirty();
+  for (auto it = dirty.begin(), end = dirty.end(); it != end; ++it)
   {
-    for (auto& mess : vec.second)
-      ossia::launch(mess);
-    vec.second.clear();
+    auto& param = *it->first;
+    switch (it->second.size())
+    {
+      case 0:
+        continue;
+      case 1:
+      {
+        dispatch(
+            param,
+            to_state_element(param, std::move(it->second[0].first))
+                .resolve());
+        break;
+      }
+      default:
+      {
+        m_commitOrderedState.clear();
+        m_commitOrderedState.reserve(it->second.size());
+        for (auto& val : it->second)
+          vis(to_state_element(param, std::move(val.first)));
+
+        for (auto& elt : m_commitOrderedState)
+          dispatch(param, ossia::apply(dispatch_resolve_visitor{}, elt));
+      }
+    }
+
+    it->second.clear();
   }
 
+  m_dispatcher.end_tick();
   commit_common();
 }
 
@@ -905,7 +1119,7 @@ void execution_state::insert(const ossia::state& v)
 
 static bool is_in(
     net::parameter_base& other,
-    const ossia::fast_hash_map<
+    const ossia::slot_map<
         ossia::net::parameter_base*,
         value_vector<std::pair<typed_value, int>>>& container)
 {
@@ -916,7 +1130,7 @@ static bool is_in(
 }
 static bool is_in(
     net::parameter_base& other,
-    const ossia::fast_hash_map<
+    const ossia::slot_map<
         ossia::net::parameter_base*, value_vector<rtmidi::message>>& container)
 {
   auto it = container.find(&other);
@@ -926,8 +1140,7 @@ static bool is_in(
 }
 static bool is_in(
     net::parameter_base& other,
-    const ossia::fast_hash_map<ossia::audio_parameter*, audio_port>&
-        container)
+    const ossia::slot_map<ossia::audio_parameter*, audio_port>& container)
 {
   // TODO dangerous
   auto it = container.find(static_cast<ossia::audio_parameter*>(&other));
@@ -1,12 +1,16 @@
 #pragma once
+#include <ossia/dataflow/commit_dispatcher.hpp>
 #include <ossia/dataflow/dataflow_fwd.hpp>
 #include <ossia/dataflow/value_vector.hpp>
 #include <ossia/detail/flat_map.hpp>
 #include <ossia/detail/hash_map.hpp>
 #include <ossia/detail/mutex.hpp>
 #include <ossia/detail/ptr_set.hpp>
+#include <ossia/detail/slot_map.hpp>
 #include <ossia/editor/state/flat_vec_state.hpp>
 #include <ossia/network/base/device.hpp>
+#include <ossia/network/base/message_queue.hpp>
+#include <ossia/network/base/node_attributes.hpp>
 #include <ossia/network/midi/midi_device.hpp>
 #include <ossia/network/midi/midi_protocol.hpp>
 
@@ -16,6 +20,7 @@
 #include <rtmidi17/message.hpp>
 #endif
 
+#include <atomic>
 #include <cstdint>
 #if SIZE_MAX == 0xFFFFFFFF // 32-bit
 #include <ossia/dataflow/audio_port.hpp>
@@ -26,7 +31,6 @@
 #include <smallfun.hpp>
 namespace ossia
 {
-class message_queue;
 class audio_parameter;
 struct typed_value;
 struct timed_value;
@@ -78,6 +82,16 @@ struct OSSIA_EXPORT execution_state : public Nano::Observer
   {
     return m_devices_exec;
   }
+  /**
+   * @brief Incremented when the trees of the execution devices change.
+   *
+   * Used to know when the path_cache of the ports must be refreshed.
+   */
+  uint64_t tree_generation() const noexcept
+  {
+    return m_treeGeneration.load(std::memory_order_acquire);
+  }
+
   ossia::net::node_base* find_node(std::string_view name) const noexcept
   {
     for (auto dev : m_devices_exec)
@@ -104,8 +118,40 @@ struct OSSIA_EXPORT execution_state : public Nano::Observer
   void commit_priorized();
   void commit_merged();
   void commit_ordered();
+
+  /**
+   * @brief Sets the values of the parameters, and sends them to their
+   * protocols from worker threads.
+   *
+   * Each protocol gets its own worker, which sends the messages of a tick
+   * with a single push_bundle: a slow device does not block the execution
+   * thread. The audio and MIDI protocols are still written to in the
+   * execution thread.
+   *
+   * The workers are started by set_dispatched_commits.
+   *
+   * \see commit_dispatcher
+   */
+  void commit_dispatched();
+
+  //! Starts or stops the workers of commit_dispatched, for the registered
+  //! devices and the ones registered later. To call from the control thread.
+  void set_dispatched_commits(bool);
   void commit_common();
 
+  //! Counters of the messages sent by commit_dispatched
+  commit_dispatch_metrics dispatch_metrics() const noexcept
+  {
+    return m_dispatcher.metrics();
+  }
+
+  //! Blocks until the workers of commit_dispatched have sent the messages of
+  //! the ticks committed so far
+  void sync_dispatched()
+  {
+    m_dispatcher.sync();
+  }
+
   void advance_tick(std::size_t);
   void apply_device_changes();
 
@@ -132,6 +178,10 @@ struct OSSIA_EXPORT execution_state : public Nano::Observer
 
   bool in_local_scope(ossia::net::parameter_base& other) const;
 
+  //! Values lost by the queues of the parameters read by the event inlets.
+  //! To call from the execution thread.
+  message_queue_stats received_values_stats() const noexcept;
+
   int sampleRate{44100};
   int bufferSize{64};
   double modelToSamplesRatio{1.};
@@ -140,16 +190,22 @@ struct OSSIA_EXPORT execution_state : public Nano::Observer
   double start_date{}; // in ns, for vst
   double cur_date{};
 
+  //! How the values received between two ticks by the parameters read by
+  //! the event inlets are queued. Applies to the parameters registered
+  //! afterwards.
+  message_queue_policy receivedValuesPolicy{};
+
   // private:// disabled due to tests, but for some reason can't make friend
   // work
   // using value_state_impl = ossia::flat_multimap<int64_t,
   // std::pair<ossia::value, int>>;
-  ossia::fast_hash_map<
+  // Each parameter written to gets a slot; the commits only go through the
+  // slots written since the previous commit.
+  ossia::slot_map<
       ossia::net::parameter_base*, value_vector<std::pair<typed_value, int>>>
       m_valueState;
-  ossia::fast_hash_map<ossia::audio_parameter*, audio_port> m_audioState;
-  ossia::fast_hash_map<
-      ossia::net::parameter_base*, value_vector<rtmidi::message>>
+  ossia::slot_map<ossia::audio_parameter*, audio_port> m_audioState;
+  ossia::slot_map<ossia::net::parameter_base*, value_vector<rtmidi::message>>
       m_midiState;
 
   mutable shared_mutex_t mutex;
@@ -158,12 +214,26 @@ private:
   void get_new_values();
   void clear_local_state();
 
+  void commit_sorted(bool priorized);
+  void dispatch(ossia::net::parameter_base& param, ossia::value&& v);
+
   void register_parameter(ossia::net::parameter_base& p);
   void unregister_parameter(ossia::net::parameter_base& p);
   void register_midi_parameter(net::midi::midi_protocol& p);
   void unregister_midi_parameter(net::midi::midi_protocol& p);
+
+  void on_node_created(ossia::net::node_base&);
+  void on_node_removing(ossia::net::node_base&);
+  void on_parameter_removing(const ossia::net::parameter_base&);
+  void on_node_renamed(ossia::net::node_base&, std::string);
+  void connect_device(ossia::net::device_base& d);
+  void disconnect_device(ossia::net::device_base& d);
+  std::atomic<uint64_t> m_treeGeneration{};
+
   ossia::small_vector<ossia::net::device_base*, 4> m_devices_edit;
   ossia::small_vector<ossia::net::device_base*, 4> m_devices_exec;
+  // Unregistered, waiting for their worker before stop_execution
+  ossia::small_vector<ossia::net::device_base*, 4> m_devices_stopping;
   struct device_operation
   {
     enum
@@ -185,11 +255,25 @@ private:
 
   ossia::mono_state m_monoState;
   ossia::flat_vec_state m_commitOrderedState;
-  ossia::flat_map<std::pair<int64_t, int>, std::vector<ossia::state_element>>
-      m_flatMessagesCache;
+
+  // Messages of a tick, sorted by commit_ordered and commit_priorized.
+  // Only cleared between ticks so that steady-state commits do not allocate.
+  struct commit_entry
+  {
+    ossia::net::priority priority{};
+    int64_t timestamp{};
+    int message_stamp{};
+    std::size_t first{}; // range of the messages in m_commitArena
+    std::size_t last{};
+  };
+  std::vector<ossia::state_element> m_commitArena;
+  std::vector<commit_entry> m_commitEntries;
 
   int m_msgIndex{};
 
+  ossia::commit_dispatcher m_dispatcher;
+  bool m_dispatchedCommits{};
+
   friend struct local_pull_visitor;
   friend struct global_pull_visitor;
   friend struct global_pull_node_visitor;
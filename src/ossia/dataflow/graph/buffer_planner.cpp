@@ -0,0 +1,196 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <ossia/dataflow/graph/buffer_planner.hpp>
+#include <ossia/dataflow/for_each_port.hpp>
+#include <ossia/dataflow/graph_edge.hpp>
+#include <ossia/dataflow/graph_node.hpp>
+#include <ossia/dataflow/port.hpp>
+#include <ossia/detail/hash_map.hpp>
+
+#include <cassert>
+#include <functional>
+#include <queue>
+
+namespace ossia
+{
+audio_buffer_planner::audio_buffer_planner() = default;
+audio_buffer_planner::~audio_buffer_planner() = default;
+
+void audio_buffer_planner::plan(const std::vector<graph_node*>& nodes)
+{
+  const auto N = uint32_t(nodes.size());
+
+  ossia::fast_hash_map<const graph_node*, uint32_t> position;
+  position.reserve(N);
+  for (uint32_t i = 0; i < N; i++)
+    position[nodes[i]] = i;
+
+  // Live ranges of the ports, sorted by start
+  struct live_range
+  {
+    ossia::audio_vector* port{};
+    uint32_t start{};
+    uint32_t end{};
+  };
+  std::vector<live_range> ranges;
+
+  for (uint32_t i = 0; i < N; i++)
+  {
+    const graph_node& node = *nodes[i];
+
+    // An inlet is filled in init_node and cleared in teardown_node
+    for_each_inlet(node, [&](inlet& in) {
+      if (in.which() == ossia::audio_port::which)
+        ranges.push_back({&in.cast<ossia::audio_port>().samples, i, i});
+    });
+
+    // An outlet is read by the inlets of the following nodes it is
+    // connected to. Delayed connections and addresses are written to in
+    // teardown_node.
+    for_each_outlet(node, [&](outlet& out) {
+      if (out.which() != ossia::audio_port::which)
+        return;
+
+      uint32_t end = i;
+      for (const graph_edge* edge : out.targets)
+      {
+        switch (edge->con.which())
+        {
+          case 0: // immediate_glutton_connection
+          case 1: // immediate_strict_connection
+            if (auto it = position.find(edge->in_node.get());
+                it != position.end())
+              end = std::max(end, it->second);
+            break;
+          default:
+            break;
+        }
+      }
+      ranges.push_back({&out.cast<ossia::audio_port>().samples, i, end});
+    });
+  }
+
+  // Linear scan allocation: a buffer is free again after the end of the
+  // range it was given to.
+  using active_t = std::pair<uint32_t, uint32_t>; // end, buffer
+  std::priority_queue<active_t, std::vector<active_t>, std::greater<>>
+      active;
+  std::vector<uint32_t> free_buffers;
+  std::vector<std::size_t> channels;
+  std::vector<uint32_t> buffer_of(ranges.size());
+
+  for (std::size_t r = 0; r < ranges.size(); r++)
+  {
+    const auto& range = ranges[r];
+    while (!active.empty() && active.top().first < range.start)
+    {
+      free_buffers.push_back(active.top().second);
+      active.pop();
+    }
+
+    uint32_t buffer{};
+    if (free_buffers.empty())
+    {
+      buffer = uint32_t(channels.size());
+      channels.push_back(0);
+    }
+    else
+    {
+      buffer = free_buffers.back();
+      free_buffers.pop_back();
+    }
+
+    buffer_of[r] = buffer;
+    channels[buffer] = std::max(channels[buffer], range.port->size());
+    active.push({range.end, buffer});
+  }
+
+  // Execution steps
+  m_steps.assign(N, step{});
+  m_acquire.clear();
+  m_release.clear();
+  m_acquire.reserve(ranges.size());
+  m_release.resize(ranges.size());
+
+  std::vector<uint32_t> release_count(N + 1);
+  for (const auto& range : ranges)
+    release_count[range.end + 1]++;
+  for (uint32_t i = 0; i < N; i++)
+    release_count[i + 1] += release_count[i];
+
+  for (uint32_t i = 0; i < N; i++)
+  {
+    m_steps[i].release_begin = release_count[i];
+    m_steps[i].release_end = release_count[i];
+  }
+
+  std::size_t r = 0;
+  for (uint32_t i = 0; i < N; i++)
+  {
+    auto& s = m_steps[i];
+    s.acquire_begin = uint32_t(m_acquire.size());
+    for (; r < ranges.size() && ranges[r].start == i; r++)
+    {
+      const auto& range = ranges[r];
+      const binding b{range.port, buffer_of[r], uint32_t(m_acquire.size())};
+      m_acquire.push_back(b);
+      m_release[m_steps[range.end].release_end++] = b;
+
+      // Between two ticks the ports do not need any memory: it is in the
+      // pool.
+      for (auto& chan : *range.port)
+        ossia::audio_channel{}.swap(chan);
+    }
+    s.acquire_end = uint32_t(m_acquire.size());
+  }
+
+  // The buffers already allocated are kept. They are not resized during
+  // the execution: a port with more channels makes the plan outdated.
+  m_pool.resize(channels.size());
+  for (std::size_t b = 0; b < channels.size(); b++)
+  {
+    const auto n = std::max(channels[b], min_channels);
+    if (m_pool[b].size() < n)
+      m_pool[b].resize(n);
+  }
+
+#if !defined(NDEBUG)
+  for (const auto& b : m_acquire)
+    assert(m_pool[b.buffer].size() >= b.port->size());
+#endif
+
+  m_owner.assign(m_pool.size(), no_owner);
+  m_pending.clear();
+  m_pending.reserve(m_acquire.size());
+  m_outdated = false;
+}
+
+void audio_buffer_planner::clear()
+{
+  invalidate();
+  m_pool.clear();
+  m_owner.clear();
+}
+
+void audio_buffer_planner::invalidate() noexcept
+{
+  m_steps.clear();
+  m_acquire.clear();
+  m_release.clear();
+  m_pending.clear();
+  for (auto& owner : m_owner)
+    owner = no_owner;
+  m_outdated = false;
+}
+
+void audio_buffer_planner::finish()
+{
+  for (uint32_t id : m_pending)
+  {
+    const auto& binding = m_acquire[id];
+    if (m_owner[binding.buffer] == id)
+      release(binding);
+  }
+  m_pending.clear();
+}
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <ossia/dataflow/nodes/media.hpp>
+#include <ossia/detail/config.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <vector>
+
+namespace ossia
+{
+class graph_node;
+
+/**
+ * @brief Shares the audio buffers of the ports of a graph.
+ *
+ * The audio data of a port is only meaningful during a short part of a
+ * tick: an inlet is filled just before its node runs and cleared just
+ * after, and an outlet is written by its node and read by the inlets it is
+ * connected to, which all run later in the tick.
+ *
+ * plan() computes these live ranges along the execution order of the
+ * nodes, and assigns each port to one of a small pool of buffers, like a
+ * register allocator: two ports can share a buffer if their live ranges
+ * do not overlap. During the execution, acquire() lends the buffers of the
+ * pool to the ports of a node before it runs, and release() takes them
+ * back once the data of a port is not needed anymore.
+ *
+ * The buffers are exchanged channel per channel, with swaps: this does not
+ * allocate, and the number of channels of each port is not changed.
+ * Between two ticks, the ports hold empty buffers and the allocated memory
+ * is in the pool, whose size only depends on the width of the graph.
+ *
+ * Only valid if the nodes are executed one after the other, in the order
+ * given to plan(). Nodes can be skipped: the ports of a node which does
+ * not run are not given a buffer.
+ *
+ * The buffers are sized in plan() from the channels the ports have then,
+ * with at least min_channels channels, since many nodes only set the
+ * channels of their ports when they first run.
+ * If a node adds more channels to a port while it runs, the extra channels
+ * keep their own memory and the plan becomes outdated(). The plan is not
+ * computed during the execution: the graph does it at its next change.
+ */
+class OSSIA_EXPORT audio_buffer_planner
+{
+public:
+  //! Channels of each buffer of the pool, at least
+  static const constexpr std::size_t min_channels = 2;
+
+  audio_buffer_planner();
+  ~audio_buffer_planner();
+  audio_buffer_planner(const audio_buffer_planner&) = delete;
+  audio_buffer_planner& operator=(const audio_buffer_planner&) = delete;
+
+  //! Computes the buffers of the audio ports of nodes, in execution order.
+  //! Not real-time safe.
+  void plan(const std::vector<graph_node*>& nodes);
+
+  //! Forgets the plan, and frees the buffers.
+  void clear();
+
+  //! Forgets the ports of the plan but keeps the buffers.
+  //! To call when a node is removed, since the plan refers to its ports.
+  void invalidate() noexcept;
+
+  //! True if a port had more channels than its buffer since the last plan
+  bool outdated() const noexcept { return m_outdated; }
+
+  //! To call just before the node at index i of the plan executes
+  void acquire(std::size_t i) noexcept
+  {
+    if (i >= m_steps.size())
+      return;
+
+    const auto& s = m_steps[i];
+    for (uint32_t b = s.acquire_begin; b < s.acquire_end; b++)
+    {
+      auto& binding = m_acquire[b];
+
+      // The previous port of this buffer was not released if the last node
+      // reading it did not run: its data is not needed anymore.
+      if (auto prev = m_owner[binding.buffer]; prev != no_owner)
+        release(m_acquire[prev]);
+
+      exchange(*binding.port, m_pool[binding.buffer]);
+      m_owner[binding.buffer] = binding.id;
+      m_pending.push_back(binding.id);
+    }
+  }
+
+  //! To call just after the node at index i of the plan has executed
+  void release(std::size_t i) noexcept
+  {
+    if (i >= m_steps.size())
+      return;
+
+    const auto& s = m_steps[i];
+    for (uint32_t b = s.release_begin; b < s.release_end; b++)
+    {
+      auto& binding = m_release[b];
+      if (m_owner[binding.buffer] == binding.id)
+        release(binding);
+    }
+  }
+
+  //! To call at the end of each tick: gives back the buffers which were
+  //! not released, e.g. if a node threw or if the node reading an outlet
+  //! did not run.
+  void finish();
+
+  //! Number of nodes in the plan
+  std::size_t size() const noexcept { return m_steps.size(); }
+
+  //! Number of audio ports in the plan
+  std::size_t ports() const noexcept { return m_acquire.size(); }
+
+  //! Number of buffers the ports share
+  std::size_t buffers() const noexcept { return m_pool.size(); }
+
+private:
+  struct step
+  {
+    uint32_t acquire_begin{};
+    uint32_t acquire_end{};
+    uint32_t release_begin{};
+    uint32_t release_end{};
+  };
+
+  struct binding
+  {
+    ossia::audio_vector* port{};
+    uint32_t buffer{};
+    //! Index of the port in m_acquire
+    uint32_t id{};
+  };
+
+  static void
+  exchange(ossia::audio_vector& port, ossia::audio_vector& buffer) noexcept
+  {
+    const std::size_t n = std::min(port.size(), buffer.size());
+    for (std::size_t c = 0; c < n; c++)
+      port[c].swap(buffer[c]);
+  }
+
+  void release(const binding& b) noexcept
+  {
+    auto& port = *b.port;
+    auto& buffer = m_pool[b.buffer];
+
+    // The node added channels while it ran: they are not exchanged, and
+    // the next plan sizes the buffer for them.
+    if (buffer.size() < port.size())
+      m_outdated = true;
+
+    for (auto& chan : port)
+      chan.clear();
+    exchange(port, buffer);
+    m_owner[b.buffer] = no_owner;
+  }
+
+  std::vector<step> m_steps;
+  std::vector<binding> m_acquire;
+  std::vector<binding> m_release;
+  std::vector<ossia::audio_vector> m_pool;
+
+  //! For each buffer of the pool, the port which currently holds it
+  static const constexpr uint32_t no_owner = UINT32_MAX;
+  std::vector<uint32_t> m_owner;
+  std::vector<uint32_t> m_pending;
+
+  bool m_outdated{};
+};
+}
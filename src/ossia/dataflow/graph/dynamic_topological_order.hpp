@@ -0,0 +1,243 @@
+#pragma once
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+namespace ossia
+{
+/**
+ * @brief Topological order of a DAG, maintained across edits.
+ *
+ * Implements the dynamic topological sort algorithm of Pearce & Kelly:
+ * when an edge is added, only the vertices between its two ends in the
+ * current order are visited and reordered. Removing an edge never
+ * invalidates the order.
+ *
+ * Vertices are numbered like the vertices of a boost::adjacency_list
+ * with vecS storage: removing a vertex renumbers the following ones.
+ *
+ * Edges are (before, after) pairs: order() lists each vertex after
+ * all the vertices which must come before it.
+ */
+class dynamic_topological_order
+{
+public:
+  std::size_t size() const noexcept
+  {
+    return m_ord.size();
+  }
+
+  //! Vertices, in topological order
+  const std::vector<int>& order() const noexcept
+  {
+    return m_order;
+  }
+
+  //! Position of a vertex in order()
+  int position(int v) const noexcept
+  {
+    return m_ord[v];
+  }
+
+  //! Adds a vertex at the end of the order, and returns it.
+  int add_vertex()
+  {
+    const int v = int(m_ord.size());
+    m_ord.push_back(v);
+    m_order.push_back(v);
+    m_succ.emplace_back();
+    m_pred.emplace_back();
+    m_visited.push_back(false);
+    return v;
+  }
+
+  //! Removes a vertex and its edges. Vertices after it are renumbered.
+  void remove_vertex(int v)
+  {
+    for (int w : m_succ[v])
+      erase_all(m_pred[w], v);
+    for (int w : m_pred[v])
+      erase_all(m_succ[w], v);
+
+    m_succ.erase(m_succ.begin() + v);
+    m_pred.erase(m_pred.begin() + v);
+    for (auto* adj : {&m_succ, &m_pred})
+      for (auto& edges : *adj)
+        for (int& w : edges)
+          if (w > v)
+            w--;
+
+    m_order.erase(m_order.begin() + m_ord[v]);
+    m_ord.pop_back();
+    m_visited.pop_back();
+    for (std::size_t i = 0; i < m_order.size(); i++)
+    {
+      int& w = m_order[i];
+      if (w > v)
+        w--;
+      m_ord[w] = int(i);
+    }
+  }
+
+  /**
+   * @brief Adds an edge, and reorders the vertices if needed.
+   *
+   * @return false if the edge would create a cycle: it is not added then.
+   */
+  bool add_edge(int before, int after)
+  {
+    if (before == after)
+      return false;
+
+    const int lb = m_ord[after];
+    const int ub = m_ord[before];
+    if (ub > lb)
+    {
+      // Vertices reachable from "after" which are not after "before" yet
+      if (!visit_forward(after, ub))
+      {
+        reset_visited();
+        return false;
+      }
+      // Vertices reaching "before" which are not before "after" yet
+      visit_backward(before, lb);
+      reorder();
+      reset_visited();
+    }
+
+    m_succ[before].push_back(after);
+    m_pred[after].push_back(before);
+    return true;
+  }
+
+  //! Removes one (before, after) edge, if there is one.
+  void remove_edge(int before, int after)
+  {
+    auto& succ = m_succ[before];
+    auto it = std::find(succ.begin(), succ.end(), after);
+    if (it == succ.end())
+      return;
+    succ.erase(it);
+
+    auto& pred = m_pred[after];
+    pred.erase(std::find(pred.begin(), pred.end(), before));
+  }
+
+  void clear()
+  {
+    m_ord.clear();
+    m_order.clear();
+    m_succ.clear();
+    m_pred.clear();
+    m_visited.clear();
+  }
+
+private:
+  static void erase_all(std::vector<int>& vec, int v)
+  {
+    vec.erase(std::remove(vec.begin(), vec.end(), v), vec.end());
+  }
+
+  bool visit_forward(int start, int ub)
+  {
+    m_forward.clear();
+    m_stack.clear();
+    m_visited[start] = true;
+    m_stack.push_back(start);
+    while (!m_stack.empty())
+    {
+      const int n = m_stack.back();
+      m_stack.pop_back();
+      m_forward.push_back(n);
+
+      for (int w : m_succ[n])
+      {
+        const int ord = m_ord[w];
+        if (ord == ub)
+          return false;
+        if (ord < ub && !m_visited[w])
+        {
+          m_visited[w] = true;
+          m_stack.push_back(w);
+        }
+      }
+    }
+    return true;
+  }
+
+  void visit_backward(int start, int lb)
+  {
+    m_backward.clear();
+    m_stack.clear();
+    m_visited[start] = true;
+    m_stack.push_back(start);
+    while (!m_stack.empty())
+    {
+      const int n = m_stack.back();
+      m_stack.pop_back();
+      m_backward.push_back(n);
+
+      for (int w : m_pred[n])
+      {
+        if (m_ord[w] > lb && !m_visited[w])
+        {
+          m_visited[w] = true;
+          m_stack.push_back(w);
+        }
+      }
+    }
+  }
+
+  // The backward set goes before the forward set, in the positions
+  // that both of them were occupying.
+  void reorder()
+  {
+    auto by_ord = [this](int a, int b) { return m_ord[a] < m_ord[b]; };
+    std::sort(m_backward.begin(), m_backward.end(), by_ord);
+    std::sort(m_forward.begin(), m_forward.end(), by_ord);
+
+    m_positions.clear();
+    for (int v : m_backward)
+      m_positions.push_back(m_ord[v]);
+    for (int v : m_forward)
+      m_positions.push_back(m_ord[v]);
+    std::sort(m_positions.begin(), m_positions.end());
+
+    std::size_t i = 0;
+    for (auto* set : {&m_backward, &m_forward})
+    {
+      for (int v : *set)
+      {
+        const int pos = m_positions[i++];
+        m_ord[v] = pos;
+        m_order[pos] = v;
+      }
+    }
+  }
+
+  void reset_visited()
+  {
+    for (int v : m_forward)
+      m_visited[v] = false;
+    for (int v : m_backward)
+      m_visited[v] = false;
+    for (int v : m_stack)
+      m_visited[v] = false;
+    m_forward.clear();
+    m_backward.clear();
+    m_stack.clear();
+  }
+
+  std::vector<int> m_ord;   // vertex -> position
+  std::vector<int> m_order; // position -> vertex
+  std::vector<std::vector<int>> m_succ;
+  std::vector<std::vector<int>> m_pred;
+
+  // Scratch space for add_edge
+  std::vector<uint8_t> m_visited;
+  std::vector<int> m_forward;
+  std::vector<int> m_backward;
+  std::vector<int> m_stack;
+  std::vector<int> m_positions;
+};
+}
@@ -39,8 +39,11 @@ make_graph_impl(const ossia::graph_setup_options& opt)
       using graph_type = graph_static<bfs_update, exec_t>;
 
       auto g = std::make_shared<graph_type>();
+      g->set_buffer_planning(opt.buffer_planning);
       g->tick_fun.set_logger(opt.log);
       g->tick_fun.set_bench(opt.bench);
+      g->tick_fun.set_profiler(opt.profiler);
+      g->set_profiler(opt.profiler);
       return g;
     }
     else if (sched == ossia::graph_setup_options::StaticFixed)
@@ -48,8 +51,11 @@ make_graph_impl(const ossia::graph_setup_options& opt)
       using graph_type = graph_static<simple_update, exec_t>;
 
       auto g = std::make_shared<graph_type>();
+      g->set_buffer_planning(opt.buffer_planning);
       g->tick_fun.set_logger(opt.log);
       g->tick_fun.set_bench(opt.bench);
+      g->tick_fun.set_profiler(opt.profiler);
+      g->set_profiler(opt.profiler);
       return g;
     }
     else // if(sched == ossia::graph_setup_options::StaticTC)
@@ -57,12 +63,20 @@ make_graph_impl(const ossia::graph_setup_options& opt)
       using graph_type = graph_static<tc_update<fast_tc>, exec_t>;
 
       auto g = std::make_shared<graph_type>();
+      g->set_buffer_planning(opt.buffer_planning);
       g->tick_fun.set_logger(opt.log);
       g->tick_fun.set_bench(opt.bench);
+      g->tick_fun.set_profiler(opt.profiler);
+      g->set_profiler(opt.profiler);
       return g;
     }
   };
-  if (opt.bench && opt.log)
+  if (opt.profiler)
+  {
+    // Also logs and benchmarks the nodes if opt.log and opt.bench are set
+    return setup(wrap_type<ossia::static_exec_profiler>{});
+  }
+  else if (opt.bench && opt.log)
   {
     return setup(wrap_type<ossia::static_exec_logger_bench>{});
   }
@@ -91,36 +105,54 @@ make_graph_par_impl(const ossia::graph_setup_options& opt)
   if (sched == ossia::graph_setup_options::StaticBFS)
   {
     using graph_type
-        = graph_static<cpptf_update<bfs_update>, cpptf_exec>;
+        = graph_static<parallel_update<bfs_update>, parallel_exec>;
 
     auto g = std::make_shared<graph_type>();
 
+    // The nodes do not run in a fixed order
+    g->set_buffer_planning(false);
     g->update_fun.logger = opt.log;
     g->update_fun.perf_map = opt.bench;
+    g->update_fun.profiler = opt.profiler;
+    g->set_profiler(opt.profiler);
+    if (opt.threads > 0)
+      g->update_fun.set_thread_count(opt.threads);
 
     return g;
   }
   else if (sched == ossia::graph_setup_options::StaticTC)
   {
     using graph_type
-        = graph_static<cpptf_update<tc_update<fast_tc>>, cpptf_exec>;
+        = graph_static<parallel_update<tc_update<fast_tc>>, parallel_exec>;
 
     auto g = std::make_shared<graph_type>();
 
+    // The nodes do not run in a fixed order
+    g->set_buffer_planning(false);
     g->update_fun.logger = opt.log;
     g->update_fun.perf_map = opt.bench;
+    g->update_fun.profiler = opt.profiler;
+    g->set_profiler(opt.profiler);
+    if (opt.threads > 0)
+      g->update_fun.set_thread_count(opt.threads);
 
     return g;
   }
   else if (sched == ossia::graph_setup_options::StaticFixed)
   {
     using graph_type
-        = graph_static<cpptf_update<simple_update>, cpptf_exec>;
+        = graph_static<parallel_update<simple_update>, parallel_exec>;
 
     auto g = std::make_shared<graph_type>();
 
+    // The nodes do not run in a fixed order
+    g->set_buffer_planning(false);
     g->update_fun.logger = opt.log;
     g->update_fun.perf_map = opt.bench;
+    g->update_fun.profiler = opt.profiler;
+    g->set_profiler(opt.profiler);
+    if (opt.threads > 0)
+      g->update_fun.set_thread_count(opt.threads);
 
     return g;
   }
@@ -300,6 +300,7 @@ public:
             *logger);
 
       finish_nodes(m_nodes);
+      m_activated.clear();
     }
     catch (const boost::not_a_dag&)
     {
@@ -10,6 +10,7 @@ class logger;
 namespace ossia
 {
 struct bench_map;
+class node_profiler;
 class time_interval;
 class OSSIA_EXPORT graph_interface
 {
@@ -18,7 +19,9 @@ public:
   virtual void add_node(ossia::node_ptr) = 0;
   virtual void remove_node(const ossia::node_ptr&) = 0;
 
-  virtual void connect(ossia::edge_ptr) = 0;
+  //! Returns false if the edge is null or would create a cycle:
+  //! it is not added then.
+  virtual bool connect(ossia::edge_ptr) = 0;
   virtual void disconnect(const ossia::edge_ptr&) = 0;
   virtual void disconnect(ossia::graph_edge*) = 0;
 
@@ -58,8 +61,15 @@ struct graph_setup_options
   } merge{};
 
   bool parallel{};
+  //! Number of threads of the parallel graph. 0 is the number of cores.
+  int threads{};
   std::shared_ptr<spdlog::logger> log{};
   std::shared_ptr<bench_map> bench{};
+  //! If set, the execution time of every node is recorded in it
+  std::shared_ptr<node_profiler> profiler{};
+  //! Share the audio buffers of the ports which are not used at the same
+  //! time. Only for the graphs which are not parallel.
+  bool buffer_planning{true};
 };
 
 struct tick_setup_options
@@ -9,6 +9,8 @@
 
 #include <boost/range/algorithm/lexicographical_compare.hpp>
 
+#include <utility>
+
 namespace ossia
 {
 
@@ -128,11 +130,44 @@ struct init_node_visitor
     }
   }
 
+  /**
+   * @brief Gives the audio buffers of the outlet to the inlet.
+   *
+   * Only done when the inlet is the only consumer of the outlet and the
+   * outlet its only producer, e.g. in a chain of effects: the outlet is
+   * done with its data (teardown_outlet already ran) and would be cleared
+   * before being written again. The inlet, empty until now, gives its
+   * buffers back to the outlet, so that nothing is allocated.
+   *
+   * The channels are exchanged one by one, so that both ports keep their
+   * channel count: when it differs, the data is copied instead.
+   */
+  static bool forward(outlet& out, inlet& in)
+  {
+    if (in.sources.size() != 1 || out.targets.size() != 1)
+      return false;
+    if (out.which() != 0 || in.which() != 0)
+      return false;
+
+    auto& src = out.cast<ossia::audio_port>().samples;
+    auto& sink = in.cast<ossia::audio_port>().samples;
+    if (sink.size() != src.size())
+      return false;
+    for (auto& chan : sink)
+      if (!chan.empty())
+        return false;
+
+    for (std::size_t i = 0; i < src.size(); i++)
+      std::swap(src[i], sink[i]);
+    return true;
+  }
+
   bool operator()(immediate_glutton_connection) const
   {
     if (edge.out_node->enabled())
     {
-      copy(*edge.out, in);
+      if (!forward(*edge.out, in))
+        copy(*edge.out, in);
       return false;
     }
     else
@@ -146,7 +181,8 @@ struct init_node_visitor
   {
     // if it's a strict connection then the other node
     // is necessarily enabled
-    copy(*edge.out, in);
+    if (!forward(*edge.out, in))
+      copy(*edge.out, in);
     return false;
   }
 
@@ -3,109 +3,64 @@
 #if defined(OSSIA_PARALLEL)
 #include <ossia/detail/hash_map.hpp>
 #include <ossia/dataflow/graph/graph_static.hpp>
-/*
-#include <tbb/flow_graph.h>
+#include <ossia/dataflow/graph/task_graph_executor.hpp>
 
 namespace ossia
 {
-
 struct parallel_exec;
+
+/**
+ * @brief Update policy of the work-stealing parallel graph.
+ *
+ * Runs the sequential update (Impl), then converts its dependency graph
+ * into a dense task graph for \ref task_graph_executor : vertex i of
+ * the sub-graph is task i. No allocation happens at execution time.
+ */
 template <typename Impl>
 struct parallel_update
 {
 public:
-  using cont_node = tbb::flow::continue_node<tbb::flow::continue_msg>;
   std::shared_ptr<spdlog::logger> logger;
   std::shared_ptr<bench_map> perf_map;
+  std::shared_ptr<node_profiler> profiler;
 
   template <typename Graph_T>
   parallel_update(Graph_T& g) : impl{g}
   {
   }
 
-  void update_graph(ossia::node_map& nodes, ossia::graph_t& graph)
+  void set_thread_count(int threads)
   {
-    namespace tbf = tbb::flow;
-    flow_nodes.clear();
-    start_nodes.clear();
-    nodes_with_incoming_edges.clear();
-
-    flow_graph.~graph();
-    new (&flow_graph) tbf::graph;
+    executor.set_thread_count(threads);
+  }
 
-    if (logger)
-    {
-      if (perf_map)
-      {
-        for (const auto& n : nodes)
-        {
-          graph_node* node = n.first.get();
-          (*perf_map)[node] = std::nullopt;
-          flow_nodes.insert({node, std::make_unique<cont_node>(
-                                       flow_graph, node_exec_logger_bench{
-                                                       cur_state, *perf_map,
-                                                       *logger, *node})});
-        }
-      }
-      else
-      {
-        for (auto n : nodes)
-        {
-          graph_node* node = n.first.get();
-          flow_nodes.insert(
-              {node,
-               std::make_unique<cont_node>(
-                   flow_graph, node_exec_logger{cur_state, *logger, *node})});
-        }
-      }
-    }
-    else
+  void update_graph(const ossia::graph_t& graph)
+  {
+    const std::size_t num_nodes = boost::num_vertices(graph);
+    nodes.resize(num_nodes);
+    for (std::size_t i = 0; i < num_nodes; i++)
     {
-      for (auto n : nodes)
-      {
-        graph_node* node = n.first.get();
-        flow_nodes.insert(
-            {node, std::make_unique<cont_node>(
-                       flow_graph, node_exec{cur_state, *node})});
-      }
+      nodes[i] = graph[i].get();
+      if (perf_map && (logger || profiler))
+        (*perf_map)[nodes[i]] = std::nullopt;
     }
 
-    for (auto n : nodes)
+    // An edge (n1, n2) in the graph means that n2 executes before n1
+    precedences.clear();
+    for (auto edge : boost::make_iterator_range(boost::edges(graph)))
     {
-      graph_node* n1 = n.first.get();
-      for (auto m : nodes)
-      {
-        graph_node* n2 = m.first.get();
-        if (n2 != n1)
-        {
-          if (boost::edge(n.second, m.second, graph).second)
-          {
-            tbf::make_edge(*flow_nodes[n2], *flow_nodes[n1]);
-            nodes_with_incoming_edges.push_back(n1);
-          }
-        }
-      }
+      precedences.emplace_back(
+          int(boost::target(edge, graph)), int(boost::source(edge, graph)));
     }
 
-    for (auto n : nodes)
-    {
-      if (!ossia::contains(nodes_with_incoming_edges, n.first.get()))
-        start_nodes.push_back(n.first.get());
-    }
-
-    start_node
-        = std::make_unique<tbf::broadcast_node<tbf::continue_msg>>(flow_graph);
-    for (auto node : start_nodes)
-    {
-      tbf::make_edge(*start_node, *flow_nodes[node]);
-    }
+    executor.set_graph(num_nodes, precedences);
   }
 
   template <typename Graph_T, typename DevicesT>
   void operator()(Graph_T& g, const DevicesT& devices)
   {
     impl(g, devices);
-    update_graph(g.m_nodes, impl.m_sub_graph);
+    update_graph(impl.m_sub_graph);
   }
 
 private:
@@ -113,12 +68,10 @@ private:
 
   Impl impl;
   execution_state* cur_state{};
-  std::unique_ptr<tbb::flow::broadcast_node<tbb::flow::continue_msg>> start_node;
-  std::vector<graph_node*> nodes_with_incoming_edges;
 
-  tbb::flow::graph flow_graph;
-  ossia::fast_hash_map<graph_node*, std::unique_ptr<cont_node>> flow_nodes;
-  std::vector<graph_node*> start_nodes;
+  std::vector<graph_node*> nodes;
+  std::vector<std::pair<int, int>> precedences;
+  task_graph_executor executor;
 };
 
 struct parallel_exec
@@ -128,21 +81,66 @@ struct parallel_exec
   {
   }
 
+  template <typename T>
+  void set_logger(const T&)
+  {
+  }
+  template <typename T>
+  void set_bench(const T&)
+  {
+  }
+  template <typename T>
+  void set_profiler(const T&)
+  {
+  }
+
   template <typename Graph_T, typename Impl>
   void operator()(
       Graph_T& g, parallel_update<Impl>& self, ossia::execution_state& e,
       const std::vector<ossia::graph_node*>&)
   {
     self.cur_state = &e;
-    self.start_node->try_put(tbb::flow::continue_msg{});
-    self.flow_graph.wait_for_all();
+
+    if (self.profiler)
+    {
+      auto exec = [&](int task) {
+        node_exec_profiler{
+            self.cur_state, *self.profiler, *self.nodes[task],
+            self.logger.get(), self.perf_map.get()}();
+      };
+      self.executor.run(exec);
+    }
+    else if (self.logger)
+    {
+      if (self.perf_map)
+      {
+        auto exec = [&](int task) {
+          node_exec_logger_bench{
+              self.cur_state, *self.perf_map, *self.logger,
+              *self.nodes[task]}();
+        };
+        self.executor.run(exec);
+      }
+      else
+      {
+        auto exec = [&](int task) {
+          node_exec_logger{self.cur_state, *self.logger, *self.nodes[task]}();
+        };
+        self.executor.run(exec);
+      }
+    }
+    else
+    {
+      auto exec
+          = [&](int task) { node_exec{self.cur_state, *self.nodes[task]}(); };
+      self.executor.run(exec);
+    }
   }
 };
 
 using parallel_tc_graph
     = graph_static<parallel_update<tc_update<fast_tc>>, parallel_exec>;
 }
-*/
 #endif
 
 #if __has_include(<taskflow/taskflow.hpp>)
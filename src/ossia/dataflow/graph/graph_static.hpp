@@ -1,11 +1,13 @@
 ﻿#pragma once
 #include <ossia/dataflow/bench_map.hpp>
+#include <ossia/dataflow/graph/buffer_planner.hpp>
 #include <ossia/dataflow/graph/graph_interface.hpp>
 #include <ossia/dataflow/graph/graph_utils.hpp>
 #include <ossia/dataflow/graph/node_executors.hpp>
 #include <ossia/dataflow/graph/transitive_closure.hpp>
 #include <ossia/editor/scenario/execution_log.hpp>
 #include <ossia/detail/flat_map.hpp>
+#include <ossia/detail/hash_map.hpp>
 
 #include <boost/circular_buffer.hpp>
 #include <boost/graph/transitive_closure.hpp>
@@ -30,40 +32,32 @@ public:
     clear();
   }
 
+  void remove_node(const node_ptr& n) override
+  {
+    // The buffer plan refers to the ports of the node
+    m_buffers.invalidate();
+    graph_base::remove_node(n);
+  }
+
+  void clear() override
+  {
+    m_buffers.invalidate();
+    graph_base::clear();
+  }
+
   void sort_all_nodes(const graph_t& gr)
   {
     try
     {
       // Get a total order on nodes
       m_all_nodes.clear();
-      m_all_nodes.reserve(m_nodes.size());
 
       // TODO this should be doable with a single vector
       m_topo_order_cache.clear();
       m_topo_order_cache.reserve(m_nodes.size());
       boost::topological_sort(gr, std::back_inserter(m_topo_order_cache));
 
-      // First put the ones without any I/O (most likely states)
-      for (auto vtx : m_topo_order_cache)
-      {
-        auto node = gr[vtx].get();
-        assert(node);
-        if(node->root_inputs().empty() && node->root_outputs().empty())
-        {
-          m_all_nodes.push_back(node);
-        }
-      }
-      // Then the others
-      for (auto vtx : m_topo_order_cache)
-      {
-        auto node = gr[vtx].get();
-        assert(node);
-
-        if(!(node->root_inputs().empty() && node->root_outputs().empty()))
-        {
-          m_all_nodes.push_back(node);
-        }
-      }
+      set_all_nodes(gr, m_topo_order_cache);
     }
     catch (...)
     {
@@ -73,6 +67,36 @@ public:
     }
   }
 
+  //! Sets m_all_nodes from vertices in execution order
+  template <typename Vertices>
+  void set_all_nodes(const graph_t& gr, const Vertices& order)
+  {
+    m_all_nodes.clear();
+    m_all_nodes.reserve(m_nodes.size());
+
+    // First put the ones without any I/O (most likely states)
+    for (auto vtx : order)
+    {
+      auto node = gr[vtx].get();
+      assert(node);
+      if (node->root_inputs().empty() && node->root_outputs().empty())
+      {
+        m_all_nodes.push_back(node);
+      }
+    }
+    // Then the others
+    for (auto vtx : order)
+    {
+      auto node = gr[vtx].get();
+      assert(node);
+
+      if (!(node->root_inputs().empty() && node->root_outputs().empty()))
+      {
+        m_all_nodes.push_back(node);
+      }
+    }
+  }
+
   void state(execution_state& e) override
   {
     try
@@ -80,38 +104,71 @@ public:
       if (m_dirty)
       {
         update_fun(*this, e.exec_devices());
-        m_enabled_cache.clear();
+        if (m_plan_buffers)
+          m_buffers.plan(m_all_nodes);
+        else
+          m_buffers.clear();
+
+        m_positions.clear();
+        m_positions.reserve(m_all_nodes.size());
+        for (std::size_t i = 0; i < m_all_nodes.size(); i++)
+          m_positions[m_all_nodes[i]] = uint32_t(i);
+
+        m_active.reserve(m_all_nodes.size());
+        m_active_nodes.reserve(m_all_nodes.size());
+        m_active_positions.reserve(m_all_nodes.size());
+        m_enabled_cache.container.reserve(m_all_nodes.size());
+
+        // The labels are only fetched when the graph changes
+        if (m_profiler)
+          m_profiler->set_nodes(m_all_nodes);
         m_dirty = false;
       }
 
-      // Filter disabled nodes (through strict relationships).
-      m_enabled_cache.container.reserve(m_nodes.size());
-
-      for (auto node : m_all_nodes)
+      // Only the nodes requested since the last tick are looked at
+      m_active.clear();
+      for (auto node : m_activated)
       {
-        ossia::graph_node& ptr = *node;
-        if (ptr.enabled())
-        {
-          m_enabled_cache.insert(&ptr);
-        }
-        else
+        if (node->enabled())
         {
-          auto it = m_enabled_cache.find(&ptr);
-          if (it != m_enabled_cache.end())
-            m_enabled_cache.erase(it);
+          if (auto it = m_positions.find(node); it != m_positions.end())
+            m_active.emplace_back(it->second, node);
         }
       }
+      ossia::sort(m_active);
+      m_active.erase(std::unique(m_active.begin(), m_active.end()), m_active.end());
+
+      // Filter disabled nodes (through strict relationships).
+      auto& enabled = m_enabled_cache.container;
+      enabled.clear();
+      for (auto [pos, node] : m_active)
+        enabled.push_back(node);
+      ossia::sort(enabled);
 
       disable_strict_nodes_rec(m_enabled_cache, m_disabled_cache);
 
-      tick_fun(*this, update_fun, e, m_all_nodes);
+      // The nodes to execute, in execution order
+      m_active_nodes.clear();
+      m_active_positions.clear();
+      for (auto [pos, node] : m_active)
+      {
+        if (node->enabled())
+        {
+          m_active_nodes.push_back(node);
+          m_active_positions.push_back(pos);
+        }
+      }
+
+      tick_fun(*this, update_fun, e, m_active_nodes);
+      m_buffers.finish();
 
 #if defined(OSSIA_EXECUTION_LOG)
       auto log = g_exec_log.log_executed_nodes(m_graph, m_all_nodes);
 #endif
 
 
-      finish_nodes(m_nodes);
+      finish_nodes(m_activated);
+      m_activated.clear();
     }
     catch (const boost::not_a_dag&)
     {
@@ -128,6 +185,36 @@ public:
   {
     return m_graph;
   }
+
+  //! The audio buffers of the ports, shared according to m_all_nodes.
+  //! The executors must call acquire and release around each node.
+  audio_buffer_planner& buffers() noexcept
+  {
+    return m_buffers;
+  }
+
+  //! Position in m_all_nodes of each node given to the executor
+  const std::vector<uint32_t>& active_positions() const noexcept
+  {
+    return m_active_positions;
+  }
+
+  //! Enabled by default. Must be disabled if the nodes are not executed in
+  //! the order of m_all_nodes, e.g. by the parallel executor.
+  void set_buffer_planning(bool b)
+  {
+    m_plan_buffers = b;
+    m_dirty = true;
+  }
+
+  //! The profiler of the executor, which gets the nodes when the graph
+  //! changes
+  void set_profiler(std::shared_ptr<node_profiler> p)
+  {
+    m_profiler = std::move(p);
+    m_dirty = true;
+  }
+
   std::vector<graph_node*> m_all_nodes;
 
 protected:
@@ -141,6 +228,17 @@ private:
   node_flat_set m_disabled_cache;
   std::vector<graph_vertex_t> m_topo_order_cache;
 
+  // Enabled nodes of the current tick
+  ossia::fast_hash_map<graph_node*, uint32_t> m_positions;
+  std::vector<std::pair<uint32_t, graph_node*>> m_active;
+  std::vector<graph_node*> m_active_nodes;
+  std::vector<uint32_t> m_active_positions;
+
+  audio_buffer_planner m_buffers;
+  bool m_plan_buffers{true};
+
+  std::shared_ptr<node_profiler> m_profiler;
+
   friend class ::DataflowTest;
 };
 
@@ -155,7 +253,9 @@ struct simple_update
   template <typename Graph_T, typename DevicesT>
   void operator()(Graph_T& g, const DevicesT& devices)
   {
-    g.sort_all_nodes(g.m_graph);
+    if (g.m_order.size() != boost::num_vertices(g.m_graph))
+      g.rebuild_order();
+    g.set_all_nodes(g.m_graph, g.m_order.order());
   }
 };
 
@@ -173,68 +273,43 @@ public:
   void operator()(Graph_T& g, const DevicesT& devices)
   {
     auto& m_graph = g.m_graph;
-    auto& m_nodes = g.m_nodes;
-    auto& m_all_nodes = g.m_all_nodes;
     const auto N = boost::num_vertices(m_graph);
-    // m_color.clear();
-    // m_color.reserve(N);
+    if (g.m_order.size() != N)
+      g.rebuild_order();
+
     m_sub_graph = m_graph;
+    m_sub_order = g.m_order;
 
-    g.sort_all_nodes(m_graph);
-    // m_active_nodes is in topo order
+    // Only the nodes bound to addresses can get implicit dependencies
+    m_inputs.resize(N);
+    m_outputs.resize(N);
+    m_addressed.clear();
+    for (int vtx : g.m_order.order())
+    {
+      graph_util::collect_address_parameters(
+          *m_graph[vtx], devices, m_inputs[vtx], m_outputs[vtx]);
+      if (!m_inputs[vtx].empty() || !m_outputs[vtx].empty())
+        m_addressed.push_back(vtx);
+    }
 
-    for (std::size_t i = 0; i < N; i++)
+    // m_addressed is in topo order.
+    // An implicit dependency is only added if it does not contradict the
+    // existing ones: m_sub_order rejects the edges which create cycles.
+    const std::size_t A = m_addressed.size();
+    for (std::size_t i = 0; i < A; i++)
     {
-      ossia::graph_node* n1 = m_all_nodes[i];
-      for (std::size_t j = i + 1; j < N; j++)
+      const int v1 = m_addressed[i];
+      for (std::size_t j = i + 1; j < A; j++)
       {
-        ossia::graph_node* n2 = m_all_nodes[j];
-
-        auto source_vtx = m_nodes.find(n1)->second;
-        auto sink_vtx = m_nodes.find(n2)->second;
-        if (find_path(source_vtx, sink_vtx, m_sub_graph))
-          continue;
-        if (find_path(sink_vtx, source_vtx, m_sub_graph))
-          continue;
-
-        if (graph_util::find_address_connection(*n1, *n2, devices))
-        {
-          auto src_it = m_nodes.find(n1);
-          auto sink_it = m_nodes.find(n2);
-          assert(src_it != m_nodes.end());
-          assert(sink_it != m_nodes.end());
-          auto edge = ossia::make_edge(
-              ossia::dependency_connection{}, ossia::outlet_ptr{},
-              ossia::inlet_ptr{}, src_it->first, sink_it->first);
-          boost::add_edge(sink_it->second, src_it->second, edge, m_sub_graph);
-
-#if defined(OSSIA_GRAPH_DEBUG)
-          auto all_nodes_old = std::move(m_all_nodes);
-          m_all_nodes.clear();
-          sort_all_nodes(sub_graph);
-          m_all_nodes = std::move(all_nodes_old);
-#endif
-        }
-        else if (graph_util::find_address_connection(*n2, *n1, devices))
-        {
-          auto src_it = m_nodes.find(n2);
-          auto sink_it = m_nodes.find(n1);
-          auto edge = ossia::make_edge(
-              ossia::dependency_connection{}, ossia::outlet_ptr{},
-              ossia::inlet_ptr{}, src_it->first, sink_it->first);
-          boost::add_edge(sink_it->second, src_it->second, edge, m_sub_graph);
-
-#if defined(OSSIA_GRAPH_DEBUG)
-          auto all_nodes_old = std::move(m_all_nodes);
-          m_all_nodes.clear();
-          sort_all_nodes(sub_graph);
-          m_all_nodes = std::move(all_nodes_old);
-#endif
-        }
+        const int v2 = m_addressed[j];
+        if (intersects(m_outputs[v1], m_inputs[v2]))
+          add_dependency(v1, v2);
+        else if (intersects(m_outputs[v2], m_inputs[v1]))
+          add_dependency(v2, v1);
       }
     }
 
-    g.sort_all_nodes(m_sub_graph);
+    g.set_all_nodes(m_sub_graph, m_sub_order.order());
   }
 
   bool find_path(graph_vertex_t source, graph_vertex_t sink, graph_t& graph)
@@ -267,6 +342,41 @@ public:
   graph_t m_sub_graph;
 
 private:
+  static bool intersects(
+      const std::vector<ossia::net::parameter_base*>& lhs,
+      const std::vector<ossia::net::parameter_base*>& rhs) noexcept
+  {
+    auto i = lhs.begin();
+    auto j = rhs.begin();
+    while (i != lhs.end() && j != rhs.end())
+    {
+      if (*i < *j)
+        ++i;
+      else if (*j < *i)
+        ++j;
+      else
+        return true;
+    }
+    return false;
+  }
+
+  // The node at "source" writes an address that the node at "sink" reads
+  void add_dependency(int source, int sink)
+  {
+    if (!m_sub_order.add_edge(source, sink))
+      return;
+
+    auto edge = ossia::make_edge(
+        ossia::dependency_connection{}, ossia::outlet_ptr{},
+        ossia::inlet_ptr{}, m_sub_graph[source], m_sub_graph[sink]);
+    boost::add_edge(sink, source, edge, m_sub_graph);
+  }
+
+  dynamic_topological_order m_sub_order;
+  std::vector<std::vector<ossia::net::parameter_base*>> m_inputs;
+  std::vector<std::vector<ossia::net::parameter_base*>> m_outputs;
+  std::vector<int> m_addressed;
+
   boost::circular_buffer<graph_vertex_t> m_queue;
 
   using pmap_type = decltype(boost::make_two_bit_color_map_fast(
@@ -4,6 +4,7 @@
 #include <ossia/dataflow/dataflow.hpp>
 #include <ossia/dataflow/execution_state.hpp>
 #include <ossia/dataflow/graph/breadth_first_search.hpp>
+#include <ossia/dataflow/graph/dynamic_topological_order.hpp>
 #include <ossia/dataflow/graph/graph_interface.hpp>
 #include <ossia/dataflow/graph/graph_ordering.hpp>
 #include <ossia/dataflow/graph_edge.hpp>
@@ -12,6 +13,7 @@
 #include <ossia/dataflow/port.hpp>
 #include <ossia/detail/algorithms.hpp>
 #include <ossia/detail/flat_set.hpp>
+#include <ossia/detail/logger.hpp>
 #include <ossia/detail/ptr_set.hpp>
 #include <ossia/editor/scenario/time_value.hpp>
 
@@ -119,7 +121,7 @@ struct OSSIA_EXPORT graph_util
   static void pull_from_parameter(inlet& in, execution_state& e)
   {
     apply_to_destination(
-        in.address, e.exec_devices(),
+        in.address, e.exec_devices(), e.tree_generation(), in.address_cache,
         [&](ossia::net::parameter_base* addr, bool) {
           if (in.scope & port::scope_t::local)
           {
@@ -395,6 +397,18 @@ struct OSSIA_EXPORT graph_util
     });
   }
 
+  static void finish_nodes(const std::vector<graph_node*>& nodes)
+  {
+    for (auto node : nodes)
+    {
+      ossia::graph_node& n = *node;
+      n.set_executed(false);
+      n.disable();
+
+      for_each_outlet(n, [] (auto& out) { out.visit(clear_data{}); });
+    }
+  }
+
   static void finish_nodes(const node_map& nodes)
   {
     for (auto& node : nodes)
@@ -430,6 +444,33 @@ struct OSSIA_EXPORT graph_util
       });
     });
   }
+
+  //! The parameters read and written by a node, sorted: two nodes have an
+  //! address connection if the outputs of one intersect the inputs of the
+  //! other.
+  template <typename DevicesT>
+  static void collect_address_parameters(
+      const ossia::graph_node& node, const DevicesT& devices,
+      std::vector<ossia::net::parameter_base*>& inputs,
+      std::vector<ossia::net::parameter_base*>& outputs)
+  {
+    inputs.clear();
+    outputs.clear();
+    for_each_inlet(node, [&](auto& inlet) {
+      apply_to_destination(
+          inlet.address, devices,
+          [&](ossia::net::parameter_base* p, bool) { inputs.push_back(p); },
+          do_nothing_for_nodes{});
+    });
+    for_each_outlet(node, [&](auto& outlet) {
+      apply_to_destination(
+          outlet.address, devices,
+          [&](ossia::net::parameter_base* p, bool) { outputs.push_back(p); },
+          do_nothing_for_nodes{});
+    });
+    ossia::sort(inputs);
+    ossia::sort(outputs);
+  }
 };
 
 struct OSSIA_EXPORT graph_base : graph_interface
@@ -480,8 +521,15 @@ struct OSSIA_EXPORT graph_base : graph_interface
     // bench[n.get()];
 
     auto vtx = boost::add_vertex(n, m_graph);
+    m_order.add_vertex();
     // m_nodes.insert({std::move(n), vtx});
     m_node_list.push_back(n.get());
+
+    // So that request() does not allocate
+    m_activated.reserve(2 * m_node_list.size());
+    n->set_activation_list(&m_activated);
+    if (n->enabled())
+      m_activated.push_back(n.get());
     m_dirty = true;
     recompute_maps();
     return vtx;
@@ -495,7 +543,7 @@ struct OSSIA_EXPORT graph_base : graph_interface
     }
   }
 
-  void remove_node(const node_ptr& n) final override
+  void remove_node(const node_ptr& n) override
   {
     for_each_inlet(*n, [&] (auto& port) {
       auto s = port.sources;
@@ -516,16 +564,19 @@ struct OSSIA_EXPORT graph_base : graph_interface
       {
         boost::clear_vertex(it->second, m_graph);
         boost::remove_vertex(it->second, m_graph);
+        m_order.remove_vertex(int(it->second));
 
         recompute_maps();
       }
       // no need to erase it since it won't be here after recompute_maps
     }
     ossia::remove_one(m_node_list, n.get());
+    n->set_activation_list(nullptr);
+    ossia::remove_erase(m_activated, n.get());
     m_dirty = true;
   }
 
-  void connect(std::shared_ptr<graph_edge> edge) final override
+  bool connect(std::shared_ptr<graph_edge> edge) final override
   {
     if (edge)
     {
@@ -544,11 +595,20 @@ struct OSSIA_EXPORT graph_base : graph_interface
       else
         out_vtx = it2->second;
 
-      // TODO check that two edges can be added
+      // The order is checked first so that m_graph stays a DAG
+      if (!m_order.add_edge(int(out_vtx), int(in_vtx)))
+      {
+        edge->clear();
+        ossia::logger().error("graph_base::connect: the edge creates a cycle");
+        return false;
+      }
+
       boost::add_edge(in_vtx, out_vtx, edge, m_graph);
       recompute_maps();
       m_dirty = true;
+      return true;
     }
+    return false;
   }
 
   void disconnect(const std::shared_ptr<graph_edge>& edge) final override
@@ -567,6 +627,9 @@ struct OSSIA_EXPORT graph_base : graph_interface
         auto edg = boost::edges(m_graph);
         if (std::find(edg.first, edg.second, it->second) != edg.second)
         {
+          m_order.remove_edge(
+              int(boost::target(it->second, m_graph)),
+              int(boost::source(it->second, m_graph)));
           boost::remove_edge(it->second, m_graph);
           recompute_maps();
         }
@@ -576,7 +639,7 @@ struct OSSIA_EXPORT graph_base : graph_interface
     }
   }
 
-  void clear() final override
+  void clear() override
   {
     // TODO clear all the connections, ports, etc, to ensure that there is no
     // shared_ptr loop
@@ -586,13 +649,33 @@ struct OSSIA_EXPORT graph_base : graph_interface
     }
     for (auto& node : m_nodes)
     {
+      node.first->set_activation_list(nullptr);
       node.first->clear();
     }
     m_dirty = true;
     m_nodes.clear();
     m_node_list.clear();
+    m_activated.clear();
     m_edges.clear();
     m_graph.clear();
+    m_order.clear();
+  }
+
+  //! Recomputes m_order, if m_graph was modified without going through
+  //! graph_base.
+  void rebuild_order()
+  {
+    m_order.clear();
+    const auto N = boost::num_vertices(m_graph);
+    for (std::size_t i = 0; i < N; i++)
+      m_order.add_vertex();
+
+    auto edges = boost::edges(m_graph);
+    for (auto it = edges.first; it != edges.second; ++it)
+    {
+      m_order.add_edge(
+          int(boost::target(*it, m_graph)), int(boost::source(*it, m_graph)));
+    }
   }
 
   void mark_dirty() final override
@@ -609,8 +692,17 @@ struct OSSIA_EXPORT graph_base : graph_interface
   edge_map m_edges;
   std::vector<ossia::graph_node*> m_node_list;
 
+  //! The nodes which were requested since the last tick, pushed by
+  //! graph_node::request. May contain duplicates and nodes which were
+  //! disabled since.
+  std::vector<ossia::graph_node*> m_activated;
+
   graph_t m_graph;
 
+  //! Execution order of the vertices of m_graph, kept up-to-date by the
+  //! edits above: an edge (in, out) of m_graph orders out before in.
+  dynamic_topological_order m_order;
+
   bool m_dirty{};
 };
 }
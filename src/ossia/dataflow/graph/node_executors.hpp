@@ -1,5 +1,6 @@
 #pragma once
 #include <ossia/dataflow/graph/graph_utils.hpp>
+#include <ossia/dataflow/graph/node_profiler.hpp>
 
 namespace ossia
 {
@@ -125,6 +126,47 @@ struct node_exec_logger_bench
   }
 };
 
+struct node_exec_profiler
+{
+  execution_state*& g;
+  node_profiler& profiler;
+  graph_node& node;
+
+  // Set if logging or benchmarking were also requested
+  spdlog::logger* logger{};
+  bench_map* perf{};
+
+  void operator()()
+  try
+  {
+    const bool measure = perf && perf->measure;
+    if (node.enabled())
+    {
+      assert(graph_util::can_execute(node, *g));
+
+      auto t0 = node_profiler::clock::now();
+      if (logger && node.logged())
+        graph_util::exec_node(node, *g, *logger);
+      else
+        graph_util::exec_node(node, *g);
+      auto t1 = node_profiler::clock::now();
+      profiler.record(node, t0, t1);
+      if (measure)
+        (*perf)[&node]
+            = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+                  .count();
+    }
+    else if (measure)
+    {
+      (*perf)[&node] = 0;
+    }
+  }
+  catch(...)
+  {
+    std::cerr << "Error while executing a node\n";
+  }
+};
+
 struct static_exec
 {
   template <typename Graph_T>
@@ -140,6 +182,10 @@ struct static_exec
   void set_bench(const T&)
   {
   }
+  template <typename T>
+  void set_profiler(const T&)
+  {
+  }
 
   template <typename Graph_T, typename Impl_T>
   void operator()(
@@ -147,13 +193,18 @@ struct static_exec
       std::vector<graph_node*>& active_nodes)
   try
   {
-    for (auto node : active_nodes)
+    auto& buffers = g.buffers();
+    auto& positions = g.active_positions();
+    for (std::size_t i = 0; i < active_nodes.size(); i++)
     {
+      auto node = active_nodes[i];
+      buffers.acquire(positions[i]);
       if (node->enabled())
       {
         assert(graph_util::can_execute(*node, e));
         graph_util::exec_node(*node, e);
       }
+      buffers.release(positions[i]);
     }
   }
   catch(...)
@@ -179,6 +230,10 @@ struct static_exec_bench
   {
     perf = t;
   }
+  template <typename T>
+  void set_profiler(const T&)
+  {
+  }
 
   template <typename Graph_T, typename Impl_T>
   void operator()(
@@ -186,11 +241,15 @@ struct static_exec_bench
       std::vector<graph_node*>& active_nodes)
   try
   {
+    auto& buffers = g.buffers();
+    auto& positions = g.active_positions();
     auto& p = *perf;
     if (p.measure)
     {
-      for (auto node : active_nodes)
+      for (std::size_t i = 0; i < active_nodes.size(); i++)
       {
+        auto node = active_nodes[i];
+        buffers.acquire(positions[i]);
         if (node->enabled())
         {
           assert(graph_util::can_execute(*node, e));
@@ -205,17 +264,21 @@ struct static_exec_bench
         {
           p[node] = 0;
         }
+        buffers.release(positions[i]);
       }
     }
     else
     {
-      for (auto node : active_nodes)
+      for (std::size_t i = 0; i < active_nodes.size(); i++)
       {
+        auto node = active_nodes[i];
+        buffers.acquire(positions[i]);
         if (node->enabled())
         {
           assert(graph_util::can_execute(*node, e));
           graph_util::exec_node(*node, e);
         }
+        buffers.release(positions[i]);
       }
     }
   }
@@ -240,6 +303,10 @@ struct static_exec_logger
   void set_bench(const T& t)
   {
   }
+  template <typename T>
+  void set_profiler(const T&)
+  {
+  }
 
   std::shared_ptr<bench_map> perf;
   std::shared_ptr<spdlog::logger> logger;
@@ -249,8 +316,12 @@ struct static_exec_logger
       std::vector<graph_node*>& active_nodes)
   try
   {
-    for (auto node : active_nodes)
+    auto& buffers = g.buffers();
+    auto& positions = g.active_positions();
+    for (std::size_t i = 0; i < active_nodes.size(); i++)
     {
+      auto node = active_nodes[i];
+      buffers.acquire(positions[i]);
       if (node->enabled())
       {
         assert(graph_util::can_execute(*node, e));
@@ -259,6 +330,7 @@ struct static_exec_logger
         else
           graph_util::exec_node(*node, e, *logger);
       }
+      buffers.release(positions[i]);
     }
   }
   catch(...)
@@ -279,6 +351,10 @@ struct static_exec_logger_bench
   {
     perf = t;
   }
+  template <typename T>
+  void set_profiler(const T&)
+  {
+  }
 
   std::shared_ptr<bench_map> perf;
   std::shared_ptr<spdlog::logger> logger;
@@ -293,11 +369,15 @@ struct static_exec_logger_bench
       std::vector<graph_node*>& active_nodes)
   try
   {
+    auto& buffers = g.buffers();
+    auto& positions = g.active_positions();
     auto& p = *perf;
     if (p.measure)
     {
-      for (auto node : active_nodes)
+      for (std::size_t i = 0; i < active_nodes.size(); i++)
       {
+        auto node = active_nodes[i];
+        buffers.acquire(positions[i]);
         if (node->enabled())
         {
           assert(graph_util::can_execute(*node, e));
@@ -315,12 +395,15 @@ struct static_exec_logger_bench
         {
           p[node] = 0;
         }
+        buffers.release(positions[i]);
       }
     }
     else
     {
-      for (auto node : active_nodes)
+      for (std::size_t i = 0; i < active_nodes.size(); i++)
       {
+        auto node = active_nodes[i];
+        buffers.acquire(positions[i]);
         if (node->enabled())
         {
           assert(graph_util::can_execute(*node, e));
@@ -329,7 +412,80 @@ struct static_exec_logger_bench
           else
             graph_util::exec_node(*node, e, *logger);
         }
+        buffers.release(positions[i]);
+      }
+    }
+  }
+  catch(...)
+  {
+    std::cerr << "Error while executing a node\n";
+  }
+};
+
+struct static_exec_profiler
+{
+  template <typename Graph_T>
+  static_exec_profiler(Graph_T&)
+  {
+  }
+
+  template <typename T>
+  void set_logger(const T& t)
+  {
+    logger = t;
+  }
+  template <typename T>
+  void set_bench(const T& t)
+  {
+    perf = t;
+  }
+  template <typename T>
+  void set_profiler(const T& t)
+  {
+    profiler = t;
+  }
+
+  std::shared_ptr<node_profiler> profiler;
+  // Optional: the profiler also logs and benchmarks the nodes if they are set
+  std::shared_ptr<spdlog::logger> logger;
+  std::shared_ptr<bench_map> perf;
+
+  template <typename Graph_T, typename Impl_T>
+  void operator()(
+      Graph_T& g, Impl_T& impl, execution_state& e,
+      std::vector<graph_node*>& active_nodes)
+  try
+  {
+    auto& buffers = g.buffers();
+    auto& positions = g.active_positions();
+    auto& p = *profiler;
+
+    auto* log = logger.get();
+    const bool measure = perf && perf->measure;
+    for (std::size_t i = 0; i < active_nodes.size(); i++)
+    {
+      auto node = active_nodes[i];
+      buffers.acquire(positions[i]);
+      if (node->enabled())
+      {
+        assert(graph_util::can_execute(*node, e));
+        auto t0 = node_profiler::clock::now();
+        if (log && node->logged())
+          graph_util::exec_node(*node, e, *log);
+        else
+          graph_util::exec_node(*node, e);
+        auto t1 = node_profiler::clock::now();
+        p.record(*node, t0, t1);
+        if (measure)
+          (*perf)[node]
+              = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+                    .count();
+      }
+      else if (measure)
+      {
+        (*perf)[node] = 0;
       }
+      buffers.release(positions[i]);
     }
   }
   catch(...)
@@ -0,0 +1,249 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <ossia/dataflow/graph/node_profiler.hpp>
+#include <ossia/dataflow/graph_node.hpp>
+#include <ossia/detail/json.hpp>
+
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <ostream>
+
+namespace ossia
+{
+node_profiler::node_profiler(std::size_t capacity)
+{
+  std::size_t sz = 1;
+  while (sz < capacity)
+    sz *= 2;
+
+  m_slots = std::make_unique<slot[]>(sz);
+  m_mask = sz - 1;
+  m_trace.reserve(sz);
+}
+
+node_profiler::~node_profiler() = default;
+
+void node_profiler::set_nodes(const std::vector<graph_node*>& nodes)
+{
+  node_list l;
+  l.labels.reserve(nodes.size());
+  for (auto node : nodes)
+    l.labels.emplace_back(node, node->label());
+
+  // The events of the previous ticks are all written at this point
+  l.head = m_head.load(std::memory_order_acquire);
+  m_nodeLists.enqueue(std::move(l));
+}
+
+void node_profiler::collect()
+{
+  node_list l;
+  while (m_nodeLists.try_dequeue(l))
+    m_pendingNodeLists.push_back(std::move(l));
+
+  // The events before a change of the graph are read with the previous
+  // nodes, so that a node with the address of a removed one does not get its
+  // statistics
+  std::size_t applied = 0;
+  for (auto& nodes : m_pendingNodeLists)
+  {
+    if (!collect_until(nodes.head))
+      break;
+    apply(nodes);
+    applied++;
+  }
+  m_pendingNodeLists.erase(
+      m_pendingNodeLists.begin(), m_pendingNodeLists.begin() + applied);
+
+  if (m_pendingNodeLists.empty())
+    collect_until(m_head.load(std::memory_order_acquire));
+}
+
+void node_profiler::apply(node_list& nodes)
+{
+  ossia::fast_hash_map<const graph_node*, std::string> labels;
+  labels.reserve(nodes.labels.size());
+  for (auto& [node, label] : nodes.labels)
+    labels.emplace(node, std::move(label));
+
+  for (auto it = m_data.begin(); it != m_data.end();)
+  {
+    auto new_it = labels.find(it->first);
+    auto old_it = m_labels.find(it->first);
+    const bool removed = new_it == labels.end()
+                         || (old_it != m_labels.end()
+                             && old_it->second != new_it->second);
+    if (removed)
+      it = m_data.erase(it);
+    else
+      ++it;
+  }
+
+  m_labels = std::move(labels);
+}
+
+bool node_profiler::collect_until(const uint64_t head)
+{
+  if (m_tail >= head)
+    return true;
+
+  const uint64_t capacity = m_mask + 1;
+  if (head - m_tail > capacity)
+  {
+    m_dropped.fetch_add(head - m_tail - capacity, std::memory_order_relaxed);
+    m_tail = head - capacity;
+  }
+
+  for (; m_tail < head; ++m_tail)
+  {
+    slot& s = m_slots[m_tail & m_mask];
+    const uint64_t expected = 2 * m_tail + 2;
+    const uint64_t seq = s.seq.load(std::memory_order_acquire);
+    if (seq < expected)
+    {
+      // Still being written: come back later
+      return false;
+    }
+
+    node_profile_event ev;
+    ev.node = s.node.load(std::memory_order_relaxed);
+    ev.start = s.start.load(std::memory_order_relaxed);
+    ev.duration = s.duration.load(std::memory_order_relaxed);
+    ev.thread = s.thread.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (seq != expected || s.seq.load(std::memory_order_relaxed) != seq)
+    {
+      // Overwritten by a newer event
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    auto& d = m_data[ev.node];
+    if (d.count == 0)
+    {
+      d.min = ev.duration;
+      d.max = ev.duration;
+      d.window.reserve(percentile_window);
+    }
+    d.count++;
+    d.total += ev.duration;
+    d.min = std::min(d.min, ev.duration);
+    d.max = std::max(d.max, ev.duration);
+    if (d.window.size() < percentile_window)
+      d.window.push_back(ev.duration);
+    else
+      d.window[d.window_pos] = ev.duration;
+    d.window_pos = (d.window_pos + 1) % percentile_window;
+
+    if (m_trace.size() < capacity)
+      m_trace.push_back(ev);
+    else
+      m_trace[m_tracePos] = ev;
+    m_tracePos = (m_tracePos + 1) % capacity;
+  }
+  return true;
+}
+
+std::vector<node_statistics> node_profiler::statistics()
+{
+  ossia::lock_t lock{m_readMutex};
+  collect();
+
+  std::vector<node_statistics> res;
+  res.reserve(m_data.size());
+
+  std::vector<int64_t> sorted;
+  for (const auto& [node, d] : m_data)
+  {
+    node_statistics st;
+    st.node = node;
+    if (auto it = m_labels.find(node); it != m_labels.end())
+      st.label = it->second;
+    st.count = d.count;
+    st.total = d.total;
+    st.min = d.min;
+    st.max = d.max;
+
+    sorted = d.window;
+    std::sort(sorted.begin(), sorted.end());
+    if (!sorted.empty())
+    {
+      auto percentile = [&](double p) {
+        return sorted[std::size_t(p * double(sorted.size() - 1))];
+      };
+      st.p50 = percentile(0.50);
+      st.p95 = percentile(0.95);
+      st.p99 = percentile(0.99);
+    }
+    res.push_back(std::move(st));
+  }
+
+  std::sort(res.begin(), res.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.total > rhs.total;
+  });
+  return res;
+}
+
+void node_profiler::write_chrome_trace(std::ostream& stream)
+{
+  stream << chrome_trace();
+}
+
+std::string node_profiler::chrome_trace()
+{
+  ossia::lock_t lock{m_readMutex};
+  collect();
+
+  rapidjson::StringBuffer buf;
+  rapidjson::Writer<rapidjson::StringBuffer> writer{buf};
+
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+
+  // Oldest event first
+  const std::size_t n = m_trace.size();
+  const std::size_t first = n < m_mask + 1 ? 0 : m_tracePos;
+  for (std::size_t i = 0; i < n; i++)
+  {
+    const auto& ev = m_trace[(first + i) % n];
+
+    writer.StartObject();
+    writer.Key("name");
+    if (auto it = m_labels.find(ev.node);
+        it != m_labels.end() && !it->second.empty())
+      writer.String(it->second.data(), it->second.size());
+    else
+      writer.String("node");
+    writer.Key("ph");
+    writer.String("X");
+    // Chrome traces are in microseconds
+    writer.Key("ts");
+    writer.Double(double(ev.start) / 1000.);
+    writer.Key("dur");
+    writer.Double(double(ev.duration) / 1000.);
+    writer.Key("pid");
+    writer.Int(0);
+    writer.Key("tid");
+    writer.Uint(ev.thread);
+    writer.EndObject();
+  }
+
+  writer.EndArray();
+  writer.EndObject();
+
+  return std::string{buf.GetString(), buf.GetSize()};
+}
+
+void node_profiler::reset()
+{
+  ossia::lock_t lock{m_readMutex};
+  m_tail = m_head.load(std::memory_order_acquire);
+  m_dropped.store(0, std::memory_order_relaxed);
+  m_data.clear();
+  m_trace.clear();
+  m_tracePos = 0;
+}
+}
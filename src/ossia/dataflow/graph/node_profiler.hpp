@@ -0,0 +1,177 @@
+#pragma once
+#include <ossia/detail/config.hpp>
+#include <ossia/detail/hash_map.hpp>
+#include <ossia/detail/lockfree_queue.hpp>
+#include <ossia/detail/mutex.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ossia
+{
+class graph_node;
+
+//! One execution of a node
+struct node_profile_event
+{
+  const graph_node* node{};
+  //! Nanoseconds since the creation of the profiler
+  int64_t start{};
+  int64_t duration{};
+  uint32_t thread{};
+};
+
+//! Execution time of a node, over the events collected so far
+struct node_statistics
+{
+  const graph_node* node{};
+  std::string label;
+  uint64_t count{};
+  int64_t total{};
+  int64_t min{};
+  int64_t max{};
+  //! Percentiles over the last node_profiler::percentile_window executions
+  int64_t p50{};
+  int64_t p95{};
+  int64_t p99{};
+};
+
+/**
+ * @brief Records the execution time of each node of a graph.
+ *
+ * record() is wait-free and does not allocate: it can be called from the
+ * audio thread, and from the threads of the parallel executor.
+ * The events go in a fixed-size ring buffer, which is read by
+ * statistics() and write_chrome_trace() from another thread.
+ * If the reader is too slow, the oldest events are overwritten and
+ * counted in dropped().
+ *
+ * The node pointers are never dereferenced by the reader: the labels
+ * come from set_nodes(), called by the graph when it changes.
+ * The statistics of the nodes which left the graph are forgotten then.
+ *
+ * \see static_exec_profiler
+ */
+class OSSIA_EXPORT node_profiler
+{
+public:
+  using clock = std::chrono::steady_clock;
+  static const constexpr std::size_t percentile_window = 1024;
+
+  //! The capacity is rounded up to a power of two
+  explicit node_profiler(std::size_t capacity = 65536);
+  ~node_profiler();
+
+  node_profiler(const node_profiler&) = delete;
+  node_profiler& operator=(const node_profiler&) = delete;
+
+  void record(
+      const graph_node& node, clock::time_point t0,
+      clock::time_point t1) noexcept
+  {
+    const uint64_t idx = m_head.fetch_add(1, std::memory_order_relaxed);
+    slot& s = m_slots[idx & m_mask];
+
+    // Seqlock: odd while the slot is being written
+    s.seq.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.node.store(&node, std::memory_order_relaxed);
+    s.start.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - m_epoch)
+            .count(),
+        std::memory_order_relaxed);
+    s.duration.store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+            .count(),
+        std::memory_order_relaxed);
+    s.thread.store(current_thread(), std::memory_order_relaxed);
+    s.seq.store(2 * idx + 2, std::memory_order_release);
+  }
+
+  /**
+   * @brief Sets the nodes of the graph, with their labels.
+   *
+   * Does not lock: the list is passed to the reader through a queue.
+   * It allocates though, so it is only called when the graph changes.
+   */
+  void set_nodes(const std::vector<graph_node*>& nodes);
+
+  //! Statistics of the nodes of the graph, sorted by total time.
+  std::vector<node_statistics> statistics();
+
+  //! The latest events, in the Chrome trace event format (chrome://tracing)
+  void write_chrome_trace(std::ostream& stream);
+  std::string chrome_trace();
+
+  //! Number of events overwritten before they could be read
+  uint64_t dropped() const noexcept
+  {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+  //! Forgets all the events and statistics
+  void reset();
+
+private:
+  struct slot
+  {
+    std::atomic<uint64_t> seq{};
+    std::atomic<const graph_node*> node{};
+    std::atomic<int64_t> start{};
+    std::atomic<int64_t> duration{};
+    std::atomic<uint32_t> thread{};
+  };
+
+  struct node_data
+  {
+    uint64_t count{};
+    int64_t total{};
+    int64_t min{};
+    int64_t max{};
+    std::vector<int64_t> window;
+    std::size_t window_pos{};
+  };
+
+  static uint32_t current_thread() noexcept
+  {
+    return uint32_t(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  }
+
+  //! The nodes of the graph from the event at index head on
+  struct node_list
+  {
+    uint64_t head{};
+    std::vector<std::pair<const graph_node*, std::string>> labels;
+  };
+
+  // Moves the new events of the ring buffer to the reader-side data.
+  // m_readMutex must be locked.
+  void collect();
+
+  // Moves the events before the index head. Returns false if one of them
+  // is still being written.
+  bool collect_until(uint64_t head);
+  void apply(node_list& nodes);
+
+  std::unique_ptr<slot[]> m_slots;
+  std::size_t m_mask{};
+  const clock::time_point m_epoch{clock::now()};
+  alignas(64) std::atomic<uint64_t> m_head{};
+  std::atomic<uint64_t> m_dropped{};
+  ossia::spsc_queue<node_list> m_nodeLists;
+
+  ossia::mutex_t m_readMutex;
+  uint64_t m_tail{};
+  ossia::fast_hash_map<const graph_node*, node_data> m_data;
+  ossia::fast_hash_map<const graph_node*, std::string> m_labels;
+  std::vector<node_list> m_pendingNodeLists;
+  std::vector<node_profile_event> m_trace;
+  std::size_t m_tracePos{};
+};
+}
@@ -0,0 +1,349 @@
+#pragma once
+#include <ossia/detail/thread.hpp>
+
+#include <atomicops.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cinttypes>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ossia
+{
+/**
+ * @brief Bounded work-stealing deque (Chase-Lev).
+ *
+ * The owner pushes and pops at the bottom, the other threads steal at the
+ * top. The capacity is fixed and the deque is reset before each run:
+ * as a task is pushed at most once per run, the indices never wrap.
+ */
+class task_deque
+{
+public:
+  void resize(std::size_t capacity)
+  {
+    m_tasks = std::make_unique<std::atomic<int>[]>(capacity);
+    m_capacity = capacity;
+    reset();
+  }
+
+  void reset() noexcept
+  {
+    m_top.store(0, std::memory_order_relaxed);
+    m_bottom.store(0, std::memory_order_relaxed);
+  }
+
+  //! Only called by the owner
+  void push(int task) noexcept
+  {
+    const int64_t b = m_bottom.load(std::memory_order_relaxed);
+    assert(b < int64_t(m_capacity));
+    m_tasks[b].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  //! Only called by the owner. Returns -1 if empty.
+  int pop() noexcept
+  {
+    const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+      return -1;
+    }
+
+    int task = m_tasks[b].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+      // Last element: race with the thieves
+      if (!m_top.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst,
+              std::memory_order_relaxed))
+        task = -1;
+      m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  //! Called by any thread. Returns -1 if empty or if the steal failed.
+  int steal() noexcept
+  {
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return -1;
+
+    const int task = m_tasks[t].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return -1;
+    return task;
+  }
+
+private:
+  alignas(64) std::atomic<int64_t> m_top{};
+  alignas(64) std::atomic<int64_t> m_bottom{};
+  std::unique_ptr<std::atomic<int>[]> m_tasks;
+  std::size_t m_capacity{};
+};
+
+/**
+ * @brief Runs a static graph of tasks on a pool of threads.
+ *
+ * Tasks are integers in [0; N). The graph is set with set_graph, which is
+ * the only place where memory is allocated: run() can be called from
+ * the audio thread.
+ *
+ * The thread calling run() takes part in the execution, the
+ * thread_count() - 1 others are worker threads.
+ * Every thread has its own deque: a task whose last dependency completes
+ * is pushed on the deque of the thread which completed it, and idle threads
+ * steal from the others. Between two runs, the workers spin for a short
+ * while and then sleep on a semaphore.
+ *
+ * run() never locks: it only posts the semaphore when some workers sleep,
+ * which is a system call per sleeping worker. This only happens when the
+ * previous run is more than max_spins yields away.
+ */
+class task_graph_executor
+{
+public:
+  //! Number of idle iterations before a worker goes to sleep
+  static const constexpr int max_spins = 10000;
+
+  //! 0 threads means std::thread::hardware_concurrency()
+  explicit task_graph_executor(int threads = 0)
+  {
+    set_thread_count(threads);
+  }
+
+  task_graph_executor(const task_graph_executor&) = delete;
+  task_graph_executor& operator=(const task_graph_executor&) = delete;
+
+  ~task_graph_executor()
+  {
+    stop_workers();
+  }
+
+  int thread_count() const noexcept
+  {
+    return int(m_queues.size());
+  }
+
+  //! Must not be called during run()
+  void set_thread_count(int threads)
+  {
+    if (threads <= 0)
+      threads = std::max(1, int(std::thread::hardware_concurrency()));
+
+    stop_workers();
+
+    m_queues = std::vector<task_deque>(threads);
+    for (auto& q : m_queues)
+      q.resize(m_numTasks);
+
+    m_running.store(true, std::memory_order_release);
+    for (int i = 1; i < threads; i++)
+    {
+      m_workers.emplace_back([this, i] { worker_loop(i); });
+      ossia::set_thread_realtime(m_workers.back());
+    }
+  }
+
+  /**
+   * @brief Sets the dependencies between the tasks.
+   *
+   * Each pair (a, b) means that a must have completed before b starts.
+   * Must not be called during run().
+   */
+  void set_graph(
+      std::size_t num_tasks, const std::vector<std::pair<int, int>>& precedences)
+  {
+    m_numTasks = num_tasks;
+    m_inDegree.assign(num_tasks, 0);
+    m_offsets.assign(num_tasks + 1, 0);
+    m_successors.resize(precedences.size());
+
+    for (auto [before, after] : precedences)
+    {
+      m_offsets[before + 1]++;
+      m_inDegree[after]++;
+    }
+    for (std::size_t i = 0; i < num_tasks; i++)
+      m_offsets[i + 1] += m_offsets[i];
+
+    std::vector<int> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    for (auto [before, after] : precedences)
+      m_successors[cursor[before]++] = after;
+
+    m_roots.clear();
+    for (std::size_t i = 0; i < num_tasks; i++)
+      if (m_inDegree[i] == 0)
+        m_roots.push_back(int(i));
+
+    m_pending = std::make_unique<std::atomic<int>[]>(num_tasks);
+    for (auto& q : m_queues)
+      q.resize(num_tasks);
+  }
+
+  /**
+   * @brief Runs all the tasks once, in an order compatible with the graph.
+   *
+   * f(int) is called concurrently from several threads and must not throw.
+   * Returns when all the tasks have completed.
+   */
+  template <typename F>
+  void run(F& f)
+  {
+    if (m_numTasks == 0)
+      return;
+
+    m_ctx = &f;
+    m_fun = [](void* ctx, int task) { (*static_cast<F*>(ctx))(task); };
+
+    for (std::size_t i = 0; i < m_numTasks; i++)
+      m_pending[i].store(m_inDegree[i], std::memory_order_relaxed);
+    for (auto& q : m_queues)
+      q.reset();
+    for (int root : m_roots)
+      m_queues[0].push(root);
+    m_remaining.store(int(m_numTasks), std::memory_order_relaxed);
+
+    if (m_workers.empty())
+    {
+      work(0);
+      return;
+    }
+
+    m_tick.fetch_add(1, std::memory_order_seq_cst);
+    m_inTick.store(true, std::memory_order_seq_cst);
+    if (const int sleeping = m_sleeping.load(std::memory_order_seq_cst))
+      m_wakeup.signal(sleeping);
+
+    work(0);
+
+    // Wait for the workers which may still be looking at this run's data
+    m_inTick.store(false, std::memory_order_seq_cst);
+    while (m_active.load(std::memory_order_seq_cst) > 0)
+      std::this_thread::yield();
+  }
+
+private:
+  void work(int self) noexcept
+  {
+    auto& own = m_queues[self];
+    const int n = int(m_queues.size());
+    while (m_remaining.load(std::memory_order_acquire) > 0)
+    {
+      int task = own.pop();
+      for (int i = 1; task == -1 && i < n; i++)
+        task = m_queues[(self + i) % n].steal();
+
+      if (task == -1)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      m_fun(m_ctx, task);
+
+      for (int k = m_offsets[task]; k < m_offsets[task + 1]; k++)
+      {
+        const int next = m_successors[k];
+        if (m_pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+          own.push(next);
+      }
+
+      m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  void worker_loop(int self)
+  {
+    uint64_t last_tick = 0;
+    int spins = 0;
+    auto has_work = [&] {
+      return m_inTick.load(std::memory_order_seq_cst)
+             && m_tick.load(std::memory_order_seq_cst) != last_tick;
+    };
+
+    while (m_running.load(std::memory_order_acquire))
+    {
+      if (!has_work())
+      {
+        if (++spins < max_spins)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+
+        // Either run() sees this worker sleeping and wakes it up,
+        // or the worker sees the new run here.
+        // A worker woken for a run it already took part in
+        // just goes back to spinning.
+        spins = 0;
+        m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        if (!has_work() && m_running.load(std::memory_order_seq_cst))
+          m_wakeup.wait();
+        m_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        continue;
+      }
+
+      spins = 0;
+      m_active.fetch_add(1, std::memory_order_seq_cst);
+      const uint64_t tick = m_tick.load(std::memory_order_seq_cst);
+      if (m_inTick.load(std::memory_order_seq_cst))
+        work(self);
+      last_tick = tick;
+      m_active.fetch_sub(1, std::memory_order_seq_cst);
+    }
+  }
+
+  void stop_workers()
+  {
+    m_running.store(false, std::memory_order_seq_cst);
+    if (!m_workers.empty())
+      m_wakeup.signal(int(m_workers.size()));
+    for (auto& t : m_workers)
+      t.join();
+    m_workers.clear();
+
+    // Tokens left by the workers which were not sleeping
+    while (m_wakeup.tryWait())
+      ;
+  }
+
+  // The graph, in compressed sparse row form
+  std::size_t m_numTasks{};
+  std::vector<int> m_inDegree;
+  std::vector<int> m_offsets;
+  std::vector<int> m_successors;
+  std::vector<int> m_roots;
+
+  // State of the current run
+  std::unique_ptr<std::atomic<int>[]> m_pending;
+  std::vector<task_deque> m_queues;
+  void* m_ctx{};
+  void (*m_fun)(void*, int){};
+  alignas(64) std::atomic_int m_remaining{};
+
+  // Synchronization with the workers
+  std::vector<std::thread> m_workers;
+  moodycamel::spsc_sema::LightweightSemaphore m_wakeup;
+  std::atomic_bool m_running{};
+  std::atomic_bool m_inTick{};
+  std::atomic<uint64_t> m_tick{};
+  std::atomic_int m_active{};
+  std::atomic_int m_sleeping{};
+};
+}
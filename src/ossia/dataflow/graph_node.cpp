@@ -165,7 +165,8 @@ bool graph_node::has_local_inputs(const execution_state& st) const noexcept
 
       // TODO optimize by stopping when found
       apply_to_destination(
-          inlet.address, st.exec_devices(),
+          inlet.address, st.exec_devices(), st.tree_generation(),
+          inlet.address_cache,
           [&](ossia::net::parameter_base* addr, bool) {
             if (!b || st.in_local_scope(*addr))
               b = true;
@@ -225,6 +226,9 @@ void graph_node::request(const token_request& req) noexcept
   }
   */
 
+  if (requested_tokens.empty() && m_activations)
+    m_activations->push_back(this);
+
   requested_tokens.push_back(std::move(req));
 }
 
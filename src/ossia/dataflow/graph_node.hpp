@@ -13,6 +13,7 @@
 #include <ossia/detail/string_view.hpp>
 #include <ossia/editor/scenario/time_value.hpp>
 
+#include <vector>
 
 namespace ossia
 {
@@ -132,8 +133,17 @@ public:
     m_executed = b;
   }
 
+  //! Adds a token to execute in the next tick.
+  //! The first one of a tick notifies the graph the node is in.
   void request(const ossia::token_request& req) noexcept;
 
+  //! Set by the graph the node is added to: the node puts itself in this
+  //! list when it gets enabled.
+  void set_activation_list(std::vector<graph_node*>* list) noexcept
+  {
+    m_activations = list;
+  }
+
   void disable() noexcept
   {
     requested_tokens.clear();
@@ -158,6 +168,7 @@ public:
   }
 
   virtual void all_notes_off() noexcept;
+  //! Use request() to add tokens, so that the graph knows about the node
   token_request_vec requested_tokens;
 
 protected:
@@ -167,6 +178,7 @@ protected:
   bool m_executed{};
 
 private:
+  std::vector<graph_node*>* m_activations{};
   bool m_start_discontinuous{};
   bool m_end_discontinuous{};
   bool m_logging{};
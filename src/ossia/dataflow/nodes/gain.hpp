@@ -1,4 +1,5 @@
 #pragma once
+#include <ossia/dataflow/audio_kernels.hpp>
 #include <ossia/dataflow/graph_node.hpp>
 #include <ossia/dataflow/port.hpp>
 
@@ -50,16 +51,18 @@ public:
       auto* output = out[i].data();
       if (cur_chan_size < last_pos)
       {
-        for (int64_t j = first_pos; j < cur_chan_size; j++)
-          output[j] = gain * input[j];
+        if (first_pos < cur_chan_size)
+          audio_kernels::copy_gain(
+              input + first_pos, output + first_pos,
+              cur_chan_size - first_pos, gain);
 
-        for (int64_t j = cur_chan_size; j < last_pos; j++)
-          output[j] = 0.;
+        audio_kernels::clear(
+            output + cur_chan_size, last_pos - cur_chan_size);
       }
       else
       {
-        for (int64_t j = first_pos; j < last_pos; j++)
-          out[i][j] = gain * input[j];
+        audio_kernels::copy_gain(
+            input + first_pos, output + first_pos, N, gain);
       }
     }
   }
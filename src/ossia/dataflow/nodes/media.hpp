@@ -1,13 +1,25 @@
 #pragma once
 
 #include <memory>
+#include <ossia/detail/config.hpp>
+#include <ossia/detail/pod_vector.hpp>
 #include <ossia/detail/small_vector.hpp>
 #include <gsl/span>
 
 namespace ossia
 {
 // Used in nodes
+#if defined(OSSIA_AUDIO_FLOAT32)
+// Same format as the audio devices: no conversion, and twice as many samples
+// per SIMD register. The channels are aligned for the audio_kernels.
+using audio_bus_sample = float;
+static const constexpr std::size_t audio_alignment = 64;
+using audio_channel = ossia::aligned_pod_vector<float, audio_alignment>;
+#else
+using audio_bus_sample = double;
+static const constexpr std::size_t audio_alignment = alignof(double);
 using audio_channel = ossia::small_pod_vector<double, 256>;
+#endif
 using audio_vector = ossia::small_vector<audio_channel, 2>;
 
 
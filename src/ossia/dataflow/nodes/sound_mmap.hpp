@@ -1,6 +1,7 @@
 #pragma once
 #include <ossia/audio/audio_parameter.hpp>
 #include <ossia/audio/drwav_handle.hpp>
+#include <ossia/dataflow/audio_kernels.hpp>
 #include <ossia/dataflow/graph_node.hpp>
 #include <ossia/dataflow/port.hpp>
 #include <ossia/dataflow/nodes/sound.hpp>
@@ -168,7 +169,7 @@ public:
     }
 
     for(int i = 0; i < channels; i++)
-      std::copy_n(audio_array[i], samples_to_write, audio_array_base[i]);
+      audio_kernels::copy(audio_array[i], audio_array_base[i], samples_to_write);
   }
 
   void fetch_audio(int64_t start, int64_t samples_to_write, float** audio_array) noexcept
@@ -1,4 +1,5 @@
 #pragma once
+#include <ossia/dataflow/audio_kernels.hpp>
 #include <ossia/dataflow/nodes/sound.hpp>
 #include <ossia/dataflow/graph_node.hpp>
 
@@ -91,26 +92,16 @@ public:
 
         if(file_duration >= start + samples_to_write + m_start_offset_samples)
         {
-          for(int k = 0, pos = start + m_start_offset_samples;
-              k < samples_to_write;
-              k++, pos++)
-          {
-            dst[k] = src[pos];
-          }
+          audio_kernels::copy(
+              src.data() + start + m_start_offset_samples, dst,
+              samples_to_write);
         }
         else
         {
           const int max = ossia::clamp(file_duration - (start + m_start_offset_samples), (int64_t)0, samples_to_write);
-          for(int k = 0, pos = start + m_start_offset_samples;
-              k < max;
-              k++, pos++)
-          {
-            dst[k] = src[pos];
-          }
-          for(int k = max; k < samples_to_write; k++)
-          {
-            dst[k] = 0;
-          }
+          audio_kernels::copy(
+              src.data() + start + m_start_offset_samples, dst, max);
+          audio_kernels::clear(dst + max, samples_to_write - max);
         }
       }
     }
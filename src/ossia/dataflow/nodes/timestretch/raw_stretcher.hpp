@@ -37,7 +37,7 @@ struct raw_stretcher
   {
     if (t.forward())
     {
-      double** output = (double**)alloca(sizeof(double*) * chan);
+      auto output = (ossia::audio_bus_sample**)alloca(sizeof(ossia::audio_bus_sample*) * chan);
       for (std::size_t i = 0; i < chan; i++)
         output[i] = ap.samples[i].data() + samples_offset;
 
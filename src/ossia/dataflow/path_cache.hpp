@@ -0,0 +1,37 @@
+#pragma once
+#include <cinttypes>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ossia
+{
+namespace net
+{
+class node_base;
+}
+
+/**
+ * @brief Nodes matched by the traversal::path address of a port.
+ *
+ * Matching a path walks the device trees: the result is kept until
+ * the pattern changes, or until the trees of the execution devices change
+ * (see execution_state::tree_generation).
+ *
+ * Only the nodes are kept, so that parameters created or removed on these
+ * nodes are still seen.
+ */
+struct path_cache
+{
+  std::vector<ossia::net::node_base*> nodes;
+  std::string pattern;
+  uint64_t generation{std::numeric_limits<uint64_t>::max()};
+
+  void clear() noexcept
+  {
+    nodes.clear();
+    pattern.clear();
+    generation = std::numeric_limits<uint64_t>::max();
+  }
+};
+}
@@ -2,6 +2,7 @@
 // it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <ossia/audio/audio_parameter.hpp>
+#include <ossia/dataflow/audio_kernels.hpp>
 #include <ossia/dataflow/dataflow.hpp>
 #include <ossia/dataflow/execution_state.hpp>
 #include <ossia/dataflow/port.hpp>
@@ -139,7 +140,7 @@ struct outlet_inserter
 void outlet::write(execution_state& e)
 {
   apply_to_destination(
-      address, e.exec_devices(),
+      address, e.exec_devices(), e.tree_generation(), address_cache,
       [&](ossia::net::parameter_base* addr, bool unique) {
         if (unique)
         {
@@ -236,14 +237,8 @@ void process_audio_out_mono(ossia::audio_port& i, ossia::audio_outlet& audio_out
 
   ensure_vector_sizes(i.samples, audio_out.data.samples);
 
-  const auto N = i.samples[0].size();
-  const auto i_ptr = i.samples[0].data();
-  const auto o_ptr  = o.samples[0].data();
-
-  for(std::size_t sample = 0; sample < N; sample++)
-  {
-    o_ptr[sample] = i_ptr[sample] * g;
-  }
+  audio_kernels::copy_gain(
+      i.samples[0].data(), o.samples[0].data(), i.samples[0].size(), g);
 }
 
 void process_audio_out_general(ossia::audio_port& i, ossia::audio_outlet& audio_out)
@@ -266,19 +261,9 @@ void process_audio_out_general(ossia::audio_port& i, ossia::audio_outlet& audio_
 
     const auto vol = audio_out.pan[chan] * g;
     if(vol == 1.)
-    {
-      for(std::size_t sample = 0; sample < N; sample++)
-      {
-        o_ptr[sample] = i_ptr[sample];
-      }
-    }
+      audio_kernels::copy(i_ptr, o_ptr, N);
     else
-    {
-      for(std::size_t sample = 0; sample < N; sample++)
-      {
-        o_ptr[sample] = i_ptr[sample] * vol;
-      }
-    }
+      audio_kernels::copy_gain(i_ptr, o_ptr, N, vol);
   }
 }
 
@@ -290,13 +275,7 @@ void process_audio_out_mono(ossia::audio_outlet& audio_out)
   if(g == 1.)
     return;
 
-  const auto N = o.samples[0].size();
-  const auto o_ptr  = o.samples[0].data();
-
-  for(std::size_t sample = 0; sample < N; sample++)
-  {
-    o_ptr[sample] *= g;
-  }
+  audio_kernels::gain(o.samples[0].data(), o.samples[0].size(), g);
 }
 
 void process_audio_out_general(ossia::audio_outlet& audio_out)
@@ -310,17 +289,10 @@ void process_audio_out_general(ossia::audio_outlet& audio_out)
 
   for(auto chan = 0U; chan < C; chan++)
   {
-    auto N = o.samples[chan].size();
-
-    auto o_ptr  = o.samples[chan].data();
-
     const auto vol = audio_out.pan[chan] * g;
     if(vol == 1.)
       continue;
-    for(std::size_t sample = 0; sample < N; sample++)
-    {
-      o_ptr[sample] *= vol;
-    }
+    audio_kernels::gain(o.samples[chan].data(), o.samples[chan].size(), vol);
   }
 }
 
@@ -3,6 +3,7 @@
 #include <ossia/dataflow/value_port.hpp>
 #include <ossia/dataflow/audio_port.hpp>
 #include <ossia/dataflow/midi_port.hpp>
+#include <ossia/dataflow/path_cache.hpp>
 #include <ossia/network/common/path.hpp>
 #include <ossia/detail/algorithms.hpp>
 
@@ -86,6 +87,8 @@ public:
   virtual void post_process();
 
   destination_t address;
+  //! Nodes matching address, when it is a path
+  mutable path_cache address_cache;
   ossia::small_vector<graph_edge*, 2> sources;
   ossia::small_vector<value_inlet*, 2> child_inlets;
 
@@ -152,6 +155,8 @@ public:
   auto& cables() const noexcept { return targets; }
 
   destination_t address;
+  //! Nodes matching address, when it is a path
+  mutable path_cache address_cache;
   ossia::small_vector<graph_edge*, 2> targets;
   ossia::small_vector<value_inlet*, 2> child_inlets;
 
@@ -1,9 +1,14 @@
 #pragma once
 #include <ossia/detail/config.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 /**
  * \file callback_container.hpp
@@ -28,6 +33,19 @@ struct OSSIA_EXPORT invalid_callback_error final : public std::logic_error
   }
 };
 
+namespace detail
+{
+//! A send() in progress in the current thread
+struct callback_send_frame
+{
+  const void* container{};
+  callback_send_frame* prev{};
+};
+
+//! The innermost send() in progress in the current thread
+OSSIA_EXPORT callback_send_frame*& callback_send_stack() noexcept;
+}
+
 template <typename T>
 /**
  * @brief The callback_container class
@@ -39,6 +57,12 @@ template <typename T>
  *
  * This allows to cleanly stop listening when there are no callbacks.
  *
+ * send() does not lock: it goes through an immutable list of the
+ * callbacks, which add_callback, remove_callback, etc. replace under the
+ * mutex. The callbacks themselves are shared with these lists, so that a
+ * callback which holds some state is not copied. Once a callback is removed, the functions which remove callbacks
+ * wait for the send() calls which may still call it, except when called
+ * from one of these callbacks: a callback can thus add or remove callbacks.
  */
 class callback_container
 {
@@ -47,34 +71,53 @@ public:
   callback_container(const callback_container& other)
   {
     std::lock_guard<std::mutex> lck{other.m_mutx};
-    m_callbacks = other.m_callbacks;
+    copy_callbacks(other.m_callbacks);
+    publish();
   }
   callback_container(callback_container&& other) noexcept
   {
+    // The snapshot of other goes along with its callbacks: nothing is
+    // allocated
     std::lock_guard<std::mutex> lck{other.m_mutx};
     m_callbacks = std::move(other.m_callbacks);
+    other.m_callbacks.clear();
+    m_snapshot.store(other.m_snapshot.exchange(nullptr));
   }
   callback_container& operator=(const callback_container& other)
   {
-    std::lock_guard<std::mutex> lck{other.m_mutx};
-    m_callbacks = other.m_callbacks;
+    {
+      std::scoped_lock lck{m_mutx, other.m_mutx};
+      copy_callbacks(other.m_callbacks);
+      publish();
+    }
+    synchronize();
     return *this;
   }
   callback_container& operator=(callback_container&& other) noexcept
   {
-    std::lock_guard<std::mutex> lck{other.m_mutx};
-    m_callbacks = std::move(other.m_callbacks);
+    {
+      std::scoped_lock lck{m_mutx, other.m_mutx};
+      m_callbacks = std::move(other.m_callbacks);
+      other.m_callbacks.clear();
+      retire(m_snapshot.exchange(other.m_snapshot.exchange(nullptr)));
+    }
+    synchronize();
     return *this;
   }
 
-  virtual ~callback_container() = default;
+  virtual ~callback_container()
+  {
+    delete m_snapshot.load(std::memory_order_relaxed);
+    free_retired(m_retired);
+  }
 
   /**
    * @brief impl How the callbackas are stored.
    * A list is used since iterators to other callbacks
    * must not be invalidated upon removal.
+   * Each callback is shared with the snapshots which send() iterates on.
    */
-  using impl = typename std::list<T>;
+  using impl = typename std::list<std::shared_ptr<T>>;
   using iterator = typename impl::iterator;
 
   /**
@@ -88,7 +131,9 @@ public:
     if (cb)
     {
       std::lock_guard<std::mutex> lck{m_mutx};
-      auto it = m_callbacks.insert(m_callbacks.begin(), std::move(cb));
+      auto it = m_callbacks.insert(
+          m_callbacks.begin(), std::make_shared<T>(std::move(cb)));
+      publish();
       if (m_callbacks.size() == 1)
         on_first_callback_added();
       return it;
@@ -105,10 +150,14 @@ public:
    */
   void remove_callback(iterator it)
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    if (m_callbacks.size() == 1)
-      on_removing_last_callback();
-    m_callbacks.erase(it);
+    {
+      std::lock_guard<std::mutex> lck{m_mutx};
+      if (m_callbacks.size() == 1)
+        on_removing_last_callback();
+      m_callbacks.erase(it);
+      publish();
+    }
+    synchronize();
   }
 
 
@@ -117,13 +166,21 @@ public:
    */
   void replace_callback(iterator it, T&& cb)
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    *m_callbacks.erase(it, it) = std::move(cb);
+    {
+      std::lock_guard<std::mutex> lck{m_mutx};
+      *m_callbacks.erase(it, it) = std::make_shared<T>(std::move(cb));
+      publish();
+    }
+    synchronize();
   }
   void replace_callbacks(impl&& cbs)
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    m_callbacks = std::move(cbs);
+    {
+      std::lock_guard<std::mutex> lck{m_mutx};
+      m_callbacks = std::move(cbs);
+      publish();
+    }
+    synchronize();
   }
 
   class disabled_callback
@@ -147,12 +204,16 @@ public:
 
   disabled_callback disable_callback(iterator it)
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
+    std::unique_lock<std::mutex> lck{m_mutx};
     disabled_callback dis{*this};
 
     // TODO should we also call on_removing_last_blah ?
     // I don't think so : it's supposed to be a short operation
     m_callbacks.erase(it);
+    publish();
+    lck.unlock();
+
+    synchronize();
     return dis;
   }
 
@@ -162,8 +223,8 @@ public:
    */
   std::size_t callback_count() const
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    return m_callbacks.size();
+    auto s = m_snapshot.load(std::memory_order_acquire);
+    return s ? s->callbacks.size() : 0;
   }
 
   /**
@@ -172,8 +233,7 @@ public:
    */
   bool callbacks_empty() const
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    return m_callbacks.empty();
+    return m_snapshot.load(std::memory_order_acquire) == nullptr;
   }
 
   /**
@@ -183,11 +243,14 @@ public:
   template <typename... Args>
   void send(Args&&... args)
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    for (auto& callback : m_callbacks)
+    read_guard guard{*this};
+    if (auto s = m_snapshot.load())
     {
-      if (callback)
-        callback(std::forward<Args>(args)...);
+      for (auto& callback : s->callbacks)
+      {
+        if (*callback)
+          (*callback)(std::forward<Args>(args)...);
+      }
     }
   }
 
@@ -196,10 +259,14 @@ public:
    */
   void callbacks_clear()
   {
-    std::lock_guard<std::mutex> lck{m_mutx};
-    if (!m_callbacks.empty())
-      on_removing_last_callback();
-    m_callbacks.clear();
+    {
+      std::lock_guard<std::mutex> lck{m_mutx};
+      if (!m_callbacks.empty())
+        on_removing_last_callback();
+      m_callbacks.clear();
+      publish();
+    }
+    synchronize();
   }
 
 protected:
@@ -227,7 +294,116 @@ protected:
   }
 
 private:
+  //! What send() iterates on
+  struct snapshot
+  {
+    std::vector<std::shared_ptr<T>> callbacks;
+    snapshot* next_retired{};
+  };
+
+  //! Counts the send() calls in progress, and marks the current thread
+  struct read_guard
+  {
+    explicit read_guard(callback_container& c) noexcept
+        : readers{c.m_readers[c.m_epoch.load() & 1]}
+        , top{detail::callback_send_stack()}
+        , frame{&c, top}
+    {
+      readers.fetch_add(1);
+      top = &frame;
+    }
+    ~read_guard()
+    {
+      top = frame.prev;
+      readers.fetch_sub(1, std::memory_order_release);
+    }
+    std::atomic<uint32_t>& readers;
+    detail::callback_send_frame*& top;
+    detail::callback_send_frame frame;
+  };
+
+  //! To call with m_mutx locked, after each change of m_callbacks
+  void publish()
+  {
+    snapshot* s{};
+    if (!m_callbacks.empty())
+    {
+      s = new snapshot;
+      s->callbacks.assign(m_callbacks.begin(), m_callbacks.end());
+    }
+
+    retire(m_snapshot.exchange(s));
+  }
+
+  //! To call with m_mutx locked, with a snapshot which was replaced
+  void retire(snapshot* prev) noexcept
+  {
+    if (prev)
+    {
+      prev->next_retired = m_retired;
+      m_retired = prev;
+    }
+
+    // A send() which starts now sees the new snapshot: the replaced ones can
+    // go if no send() is in progress.
+    if (m_readers[0].load() == 0 && m_readers[1].load() == 0)
+      free_retired(m_retired);
+  }
+
+  //! To call with m_mutx locked. The callbacks are copied, not shared.
+  void copy_callbacks(const impl& other)
+  {
+    m_callbacks.clear();
+    for (auto& cb : other)
+      m_callbacks.push_back(std::make_shared<T>(*cb));
+  }
+
+  //! To call without m_mutx locked, after removing callbacks: waits for the
+  //! send() calls which may still use them.
+  void synchronize()
+  {
+    for (auto f = detail::callback_send_stack(); f; f = f->prev)
+    {
+      // Called from a callback of this container: the replaced snapshots
+      // will be freed by a later change.
+      if (f->container == this)
+        return;
+    }
+
+    snapshot* retired{};
+    {
+      std::lock_guard<std::mutex> lck{m_mutx};
+      retired = m_retired;
+      m_retired = nullptr;
+    }
+
+    // New calls to send() go to the other counter, so that each one drains
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      m_epoch.store(i ^ 1);
+      while (m_readers[i].load() != 0)
+        std::this_thread::yield();
+    }
+
+    free_retired(retired);
+  }
+
+  static void free_retired(snapshot*& s) noexcept
+  {
+    while (s)
+    {
+      auto next = s->next_retired;
+      delete s;
+      s = next;
+    }
+  }
+
   impl m_callbacks;
   mutable std::mutex m_mutx;
+
+  std::atomic<snapshot*> m_snapshot{};
+  std::atomic<uint32_t> m_readers[2]{};
+  std::atomic<uint32_t> m_epoch{};
+  snapshot* m_retired{};
 };
 }
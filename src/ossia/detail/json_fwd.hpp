@@ -9,4 +9,10 @@ class GenericStringBuffer;
 template <typename CharType>
 struct UTF8;
 using StringBuffer = GenericStringBuffer<UTF8<char>, CrtAllocator>;
+template <typename BaseAllocator>
+class MemoryPoolAllocator;
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericDocument;
+using Document = GenericDocument<
+    UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator>;
 }
@@ -2,6 +2,7 @@
 #include <cinttypes>
 #include <cstddef>
 #include <cstdlib>
+#include <new>
 #include <vector>
 
 #include <type_traits>
@@ -80,8 +81,51 @@ struct pod_allocator
   }
 };
 #endif
+//! Like pod_allocator, but the memory is aligned on Align bytes (e.g. for SIMD)
+template <class T, std::size_t Align>
+struct aligned_pod_allocator
+{
+  using value_type = T;
+  template <class U>
+  struct rebind
+  {
+    using other = aligned_pod_allocator<U, Align>;
+  };
+
+  aligned_pod_allocator() noexcept = default;
+  aligned_pod_allocator(const aligned_pod_allocator&) noexcept = default;
+  aligned_pod_allocator(aligned_pod_allocator&&) noexcept = default;
+  aligned_pod_allocator& operator=(const aligned_pod_allocator&) noexcept = default;
+  aligned_pod_allocator& operator=(aligned_pod_allocator&&) noexcept = default;
+  template <class U>
+  aligned_pod_allocator(const aligned_pod_allocator<U, Align>&) noexcept
+  {
+  }
+
+  static inline T* allocate(std::size_t num)
+  {
+    static_assert(std::is_standard_layout_v<T> && std::is_trivial_v<T>, "can only be used with POD types");
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0, "invalid alignment");
+    return static_cast<T*>(::operator new(sizeof(T) * num, std::align_val_t{Align}));
+  }
+  static inline void deallocate(T* p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t{Align});
+  }
+  friend inline bool operator==(aligned_pod_allocator, aligned_pod_allocator) noexcept
+  {
+    return true;
+  }
+  friend inline bool operator!=(aligned_pod_allocator, aligned_pod_allocator) noexcept
+  {
+    return false;
+  }
+};
+
 template <typename T>
 using pod_vector = std::vector<T, pod_allocator<T>>;
+template <typename T, std::size_t Align>
+using aligned_pod_vector = std::vector<T, aligned_pod_allocator<T, Align>>;
 
 using int_vector = pod_vector<int>;
 using float_vector = pod_vector<float>;
@@ -0,0 +1,199 @@
+#pragma once
+#include <ossia/detail/hash_map.hpp>
+
+#include <cinttypes>
+#include <utility>
+#include <vector>
+
+namespace ossia
+{
+/**
+ * @brief Map whose values are stored contiguously, in dense integer slots.
+ *
+ * A key gets a slot the first time it is seen, and keeps it afterwards.
+ * Besides the usual map-like interface, the slots written through
+ * operator[] since the last call to clear_dirty() are tracked, so that
+ * they can be processed without going through all the keys:
+ *
+ * \code
+ * for (auto& [k, v] : map.dirty())
+ *   process(k, v);
+ * map.clear_dirty();
+ * \endcode
+ */
+template <typename K, typename V>
+class slot_map
+{
+public:
+  using value_type = std::pair<K, V>;
+  using container_type = std::vector<value_type>;
+  using iterator = typename container_type::iterator;
+  using const_iterator = typename container_type::const_iterator;
+
+  class dirty_range
+  {
+  public:
+    class iterator
+    {
+    public:
+      iterator(container_type& c, const std::size_t* it) noexcept
+          : m_container{&c}
+          , m_it{it}
+      {
+      }
+
+      value_type& operator*() const noexcept
+      {
+        return (*m_container)[*m_it];
+      }
+      value_type* operator->() const noexcept
+      {
+        return &(*m_container)[*m_it];
+      }
+      iterator& operator++() noexcept
+      {
+        ++m_it;
+        return *this;
+      }
+      bool operator==(const iterator& other) const noexcept
+      {
+        return m_it == other.m_it;
+      }
+      bool operator!=(const iterator& other) const noexcept
+      {
+        return m_it != other.m_it;
+      }
+
+    private:
+      container_type* m_container{};
+      const std::size_t* m_it{};
+    };
+
+    dirty_range(container_type& c, const std::vector<std::size_t>& d) noexcept
+        : m_container{c}
+        , m_dirty{d}
+    {
+    }
+
+    iterator begin() const noexcept
+    {
+      return {m_container, m_dirty.data()};
+    }
+    iterator end() const noexcept
+    {
+      return {m_container, m_dirty.data() + m_dirty.size()};
+    }
+    std::size_t size() const noexcept
+    {
+      return m_dirty.size();
+    }
+    bool empty() const noexcept
+    {
+      return m_dirty.empty();
+    }
+
+  private:
+    container_type& m_container;
+    const std::vector<std::size_t>& m_dirty;
+  };
+
+  void reserve(std::size_t n)
+  {
+    m_slots.reserve(n);
+    m_values.reserve(n);
+    m_isDirty.reserve(n);
+    m_dirty.reserve(n);
+  }
+
+  //! Returns the slot of a key, and gives it one if it has none yet.
+  std::size_t slot(const K& k)
+  {
+    auto it = m_slots.find(k);
+    if (it != m_slots.end())
+      return it->second;
+
+    const std::size_t s = m_values.size();
+    m_values.emplace_back(k, V{});
+    m_isDirty.push_back(false);
+    m_slots.emplace(k, s);
+    return s;
+  }
+
+  //! Access to a value for writing: the slot becomes dirty.
+  V& operator[](const K& k)
+  {
+    const std::size_t s = slot(k);
+    if (!m_isDirty[s])
+    {
+      m_isDirty[s] = true;
+      m_dirty.push_back(s);
+    }
+    return m_values[s].second;
+  }
+
+  iterator find(const K& k) noexcept
+  {
+    auto it = m_slots.find(k);
+    return it != m_slots.end() ? m_values.begin() + it->second
+                               : m_values.end();
+  }
+  const_iterator find(const K& k) const noexcept
+  {
+    auto it = m_slots.find(k);
+    return it != m_slots.end() ? m_values.begin() + it->second
+                               : m_values.end();
+  }
+
+  iterator begin() noexcept
+  {
+    return m_values.begin();
+  }
+  iterator end() noexcept
+  {
+    return m_values.end();
+  }
+  const_iterator begin() const noexcept
+  {
+    return m_values.begin();
+  }
+  const_iterator end() const noexcept
+  {
+    return m_values.end();
+  }
+  std::size_t size() const noexcept
+  {
+    return m_values.size();
+  }
+  bool empty() const noexcept
+  {
+    return m_values.empty();
+  }
+
+  //! The slots written since the last call to clear_dirty, in write order.
+  dirty_range dirty() noexcept
+  {
+    return {m_values, m_dirty};
+  }
+
+  void clear_dirty() noexcept
+  {
+    for (std::size_t s : m_dirty)
+      m_isDirty[s] = false;
+    m_dirty.clear();
+  }
+
+  void clear() noexcept
+  {
+    m_slots.clear();
+    m_values.clear();
+    m_isDirty.clear();
+    m_dirty.clear();
+  }
+
+private:
+  ossia::fast_hash_map<K, std::size_t> m_slots;
+  container_type m_values;
+  std::vector<uint8_t> m_isDirty;
+  std::vector<std::size_t> m_dirty;
+};
+}
@@ -13,6 +13,7 @@
 
 #include <ossia_export.h>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <memory>
@@ -71,6 +72,7 @@ public:
   using ordinate_type = Y;
   using curve_type = curve<X, Y>;
   using map_type = curve_map<X, std::pair<Y, ossia::curve_segment<Y>>>;
+  using block_map_type = curve_map<X, ossia::curve_block_segment<Y>>;
 
   curve() = default;
   curve(const curve& other)
@@ -80,6 +82,7 @@ public:
     m_y0_destination = other.m_y0_destination;
 
     m_points = other.m_points;
+    m_blocks = other.m_blocks;
 
     m_y0_cacheUsed = false;
   }
@@ -91,6 +94,7 @@ public:
     m_y0_destination = std::move(other.m_y0_destination);
 
     m_points = std::move(other.m_points);
+    m_blocks = std::move(other.m_blocks);
 
     m_y0_cacheUsed = false;
   }
@@ -102,6 +106,8 @@ public:
     m_y0_destination = other.m_y0_destination;
 
     m_points = other.m_points;
+    m_blocks = other.m_blocks;
+    m_cursor = 0;
 
     m_y0_cacheUsed = false;
     return *this;
@@ -113,6 +119,8 @@ public:
     m_y0_destination = std::move(other.m_y0_destination);
 
     m_points = std::move(other.m_points);
+    m_blocks = std::move(other.m_blocks);
+    m_cursor = 0;
 
     m_y0_cacheUsed = false;
     return *this;
@@ -129,16 +137,34 @@ public:
  \return bool */
   bool add_point(ossia::curve_segment<Y>&& segment, X abscissa, Y value);
 
+  /*! add a segment which can also be rendered by blocks
+ \details used for the built-in segments, which have a render member function.
+ \see value_at_block */
+  template <typename Segment>
+  auto add_point(Segment segment, X abscissa, Y value) -> decltype(
+      segment.render(0., 0., std::size_t{}, value, value, &value), bool());
+
   /*! remove a point from the curve
  \param X point abscissa
  \return bool */
   bool remove_point(X abscissa);
 
   /*! get value at an abscissa
+ \details O(log n) in the number of points, and amortized O(1) when
+ successive calls move forward in the curve, like during playback.
  \param X abscissa.
  \return Y ordinate */
   Y value_at(X abscissa) const;
 
+  /*! get the values at abscissa x0 + i * dx, for i in [0; n[
+ \details the segments added with a block renderer are rendered with a single
+ call per segment; the others are evaluated point by point.
+ \param X x0 first abscissa
+ \param X dx step between two abscissas
+ \param std::size_t n number of values
+ \param Y* out array of at least n values */
+  void value_at_block(X x0, X dx, std::size_t n, Y* out) const;
+
   ossia::curve_type get_type() const override;
 
   /*! get initial point abscissa
@@ -181,12 +207,21 @@ public:
       const ossia::value& value, ossia::destination_index::const_iterator idx);
 
 private:
+  // Index of the first point at or after the abscissa
+  std::size_t upper_point(X abscissa) const noexcept;
+
   mutable X m_x0;
   mutable Y m_y0;
   mutable std::optional<ossia::destination> m_y0_destination;
 
   mutable map_type m_points;
 
+  // Block renderers of the segments of m_points which have one
+  block_map_type m_blocks;
+
+  // Index of the point which ends the segment found by the last value_at
+  mutable std::size_t m_cursor{};
+
   mutable Y m_y0_cache;
 
   mutable bool m_y0_cacheUsed = false;
@@ -203,6 +238,27 @@ inline bool
 curve<X, Y>::add_point(ossia::curve_segment<Y>&& segment, X abscissa, Y value)
 {
   m_points.emplace(abscissa, std::make_pair(value, std::move(segment)));
+  m_cursor = 0;
+
+  return true;
+}
+
+template <typename X, typename Y>
+template <typename Segment>
+inline auto curve<X, Y>::add_point(Segment segment, X abscissa, Y value)
+    -> decltype(
+        segment.render(0., 0., std::size_t{}, value, value, &value), bool())
+{
+  auto res = m_points.emplace(abscissa, std::make_pair(value, segment));
+  if (res.second)
+  {
+    m_blocks.emplace(abscissa, [segment](
+                                   double ratio, double delta, std::size_t n,
+                                   Y start, Y end, Y* out) {
+      segment.render(ratio, delta, n, start, end, out);
+    });
+  }
+  m_cursor = 0;
 
   return true;
 }
@@ -210,36 +266,153 @@ curve<X, Y>::add_point(ossia::curve_segment<Y>&& segment, X abscissa, Y value)
 template <typename X, typename Y>
 inline bool curve<X, Y>::remove_point(X abscissa)
 {
+  m_cursor = 0;
+  m_blocks.erase(abscissa);
   return m_points.erase(abscissa) > 0;
 }
 
+template <typename X, typename Y>
+inline std::size_t curve<X, Y>::upper_point(X abscissa) const noexcept
+{
+  const auto begin = m_points.begin();
+  const std::size_t n = m_points.size();
+
+  // Whether the i-th point is the first point at or after the abscissa,
+  // n meaning that the abscissa is after the last point
+  auto is_upper_point = [&](std::size_t i) {
+    return i <= n && (i == n || !(begin[i].first < abscissa))
+           && (i == 0 || begin[i - 1].first < abscissa);
+  };
+
+  std::size_t i = m_cursor;
+  if (!is_upper_point(i))
+  {
+    if (is_upper_point(i + 1))
+      i = i + 1;
+    else
+      i = m_points.lower_bound(abscissa) - begin;
+  }
+  m_cursor = i;
+  return i;
+}
+
 template <typename X, typename Y>
 inline Y curve<X, Y>::value_at(X abscissa) const
 {
-  X lastAbscissa = get_x0();
-  Y lastValue = get_y0();
+  // The initial value of a destination is fetched on the first evaluation
+  if (m_y0_destination && !m_y0_cacheUsed)
+    get_y0();
+
+  const auto begin = m_points.begin();
+  const std::size_t n = m_points.size();
+  const std::size_t i = upper_point(abscissa);
 
-  auto end = m_points.end();
-  for (auto it = m_points.begin(); it != end; ++it)
+  X lastAbscissa;
+  Y lastValue;
+  if (i == 0)
+  {
+    lastAbscissa = get_x0();
+    lastValue = get_y0();
+    if (n == 0 || !(abscissa > lastAbscissa))
+      return lastValue;
+  }
+  else
   {
-    if (abscissa > lastAbscissa && abscissa <= it->first)
+    const auto& prev = begin[i - 1];
+    lastAbscissa = prev.first;
+    lastValue = prev.second.first;
+    if (i == n)
+      return lastValue;
+  }
+
+  const auto& next = begin[i];
+  return next.second.second(
+      ((double)abscissa - (double)lastAbscissa)
+          / ((double)next.first - (double)lastAbscissa),
+      lastValue, next.second.first);
+}
+
+template <typename X, typename Y>
+inline void
+curve<X, Y>::value_at_block(X x0, X dx, std::size_t n, Y* out) const
+{
+  if (!(dx > X{}))
+  {
+    for (std::size_t k = 0; k < n; k++)
+      out[k] = value_at(x0 + X(k * dx));
+    return;
+  }
+
+  if (m_y0_destination && !m_y0_cacheUsed)
+    get_y0();
+
+  const auto begin = m_points.begin();
+  const std::size_t num_points = m_points.size();
+
+  std::size_t k = 0;
+  while (k < n)
+  {
+    const X x = x0 + X(k * dx);
+    const std::size_t i = upper_point(x);
+
+    // The curve is constant after its last point
+    if (i == num_points)
     {
-      lastValue = it->second.second(
-          ((double)abscissa - (double)lastAbscissa)
-              / ((double)it->first - (double)lastAbscissa),
-          lastValue, it->second.first);
-      break;
+      std::fill_n(
+          out + k, n - k, i == 0 ? get_y0() : begin[i - 1].second.first);
+      return;
     }
-    else if (abscissa > it->first)
+
+    // Index of the first sample after the given abscissa
+    const X next_x = begin[i].first;
+    auto segment_end = [&](X bound) {
+      std::size_t e = k + 1;
+      while (e < n && !(bound < x0 + X(e * dx)))
+        e++;
+      return e;
+    };
+
+    X lastAbscissa;
+    Y lastValue;
+    if (i == 0)
     {
-      lastAbscissa = it->first;
-      lastValue = it->second.first;
+      lastAbscissa = get_x0();
+      lastValue = get_y0();
+      if (!(x > lastAbscissa))
+      {
+        const std::size_t e = segment_end(std::min(lastAbscissa, next_x));
+        std::fill(out + k, out + e, lastValue);
+        k = e;
+        continue;
+      }
     }
     else
-      break;
-  }
+    {
+      lastAbscissa = begin[i - 1].first;
+      lastValue = begin[i - 1].second.first;
+    }
 
-  return lastValue;
+    const std::size_t e = segment_end(next_x);
+    const auto& next = begin[i];
+    const double span = (double)next.first - (double)lastAbscissa;
+    auto block = m_blocks.find(next.first);
+    if (block != m_blocks.end())
+    {
+      block->second(
+          ((double)x - (double)lastAbscissa) / span, (double)dx / span, e - k,
+          lastValue, next.second.first, out + k);
+    }
+    else
+    {
+      for (std::size_t j = k; j < e; j++)
+      {
+        out[j] = next.second.second(
+            ((double)(x0 + X(j * dx)) - (double)lastAbscissa) / span,
+            lastValue, next.second.first);
+      }
+    }
+    k = e;
+  }
 }
 
 template <typename X, typename Y>
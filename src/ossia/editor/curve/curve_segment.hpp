@@ -1,6 +1,8 @@
 #pragma once
 #include <smallfun.hpp>
 
+#include <cstddef>
+
 /**
  * \file curve_segment.hpp
  */
@@ -31,4 +33,25 @@ using curve_segment = smallfun::function<Y(double, Y, Y), 24 + 24>;
 #else
 using curve_segment = smallfun::function<Y(double, Y, Y), 24>;
 #endif
+
+template <typename Y>
+/**
+ * \typedef curve_block_segment
+ *
+ * Renders a whole block of a curve segment at once:
+ * \code
+ * void render(double ratio, double delta, std::size_t n, Y start, Y end, Y* out)
+ * \endcode
+ * writes in out[i] the value of the segment at ratio + i * delta.
+ *
+ * The built-in segments provide one as a `render` member function,
+ * whose loop the compiler can vectorize.
+ */
+#if defined(_WIN32)
+using curve_block_segment = smallfun::function<
+    void(double, double, std::size_t, Y, Y, Y*), 24 + 24>;
+#else
+using curve_block_segment
+    = smallfun::function<void(double, double, std::size_t, Y, Y, Y*), 24>;
+#endif
 }
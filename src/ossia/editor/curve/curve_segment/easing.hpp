@@ -2,6 +2,7 @@
 #include <ossia/detail/math.hpp>
 
 #include <cmath>
+#include <cstddef>
 #include <ossia_export.h>
 
 /**
@@ -366,5 +367,13 @@ struct curve_segment_ease
   {
     return easing::ease{}(start, end, Easing{}(ratio));
   }
+
+  void render(
+      double ratio, double delta, std::size_t n, Y start, Y end,
+      Y* out) const
+  {
+    for (std::size_t i = 0; i < n; i++)
+      out[i] = easing::ease{}(start, end, Easing{}(ratio + i * delta));
+  }
 };
 }
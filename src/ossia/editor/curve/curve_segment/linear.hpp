@@ -1,5 +1,7 @@
 #pragma once
 #include <ossia/editor/curve/curve_segment/easing.hpp>
+
+#include <cstddef>
 namespace ossia
 {
 template <typename Y>
@@ -9,5 +11,13 @@ struct curve_segment_linear
   {
     return ossia::easing::ease{}(start, end, ratio);
   }
+
+  void render(
+      double ratio, double delta, std::size_t n, Y start, Y end,
+      Y* out) const
+  {
+    for (std::size_t i = 0; i < n; i++)
+      out[i] = ossia::easing::ease{}(start, end, ratio + i * delta);
+  }
 };
 }
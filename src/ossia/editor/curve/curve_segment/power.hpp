@@ -1,16 +1,33 @@
 #pragma once
 #include <cmath>
+#include <cstddef>
 
 namespace ossia
 {
 template <typename Y>
 struct curve_segment_power
 {
-  auto operator()(double power) const
+  struct segment
   {
-    return [=](double ratio, Y start, Y end) -> Y {
+    double power;
+
+    Y operator()(double ratio, Y start, Y end) const
+    {
       return start + std::pow(ratio, power) * (end - start);
-    };
+    }
+
+    void render(
+        double ratio, double delta, std::size_t n, Y start, Y end,
+        Y* out) const
+    {
+      for (std::size_t i = 0; i < n; i++)
+        out[i] = start + std::pow(ratio + i * delta, power) * (end - start);
+    }
+  };
+
+  segment operator()(double power) const
+  {
+    return segment{power};
   }
 };
 }
@@ -1,16 +1,37 @@
 #pragma once
 #include <cmath>
+#include <cstddef>
 namespace ossia
 {
 template <typename Y>
 struct curve_segment_sin
 {
-  auto operator()(double freq, double phase, double ampl) const
+  struct segment
   {
-    return [=](double ratio, Y start, Y end) {
+    double freq;
+    double phase;
+    double ampl;
+
+    Y operator()(double ratio, Y start, Y end) const
+    {
       return start
              + ampl * std::sin(phase + two_pi * ratio * freq) * (end - start);
-    };
+    }
+
+    void render(
+        double ratio, double delta, std::size_t n, Y start, Y end,
+        Y* out) const
+    {
+      for (std::size_t i = 0; i < n; i++)
+        out[i] = start
+                 + ampl * std::sin(phase + two_pi * (ratio + i * delta) * freq)
+                       * (end - start);
+    }
+  };
+
+  segment operator()(double freq, double phase, double ampl) const
+  {
+    return segment{freq, phase, ampl};
   }
 };
 }
@@ -9,7 +9,7 @@
 #include <ossia/network/value/value_traits.hpp>
 namespace ossia
 {
-void message::launch()
+ossia::value message::resolve()
 {
   ossia::net::parameter_base& addr = dest.value.get();
   const auto& unit = dest.unit;
@@ -18,13 +18,12 @@ void message::launch()
   {
     if (!unit || unit == addr_unit)
     {
-      addr.push_value(message_value);
+      return message_value;
     }
     else
     {
       // Convert from this message's unit to the address's unit
-      addr.push_value(
-          ossia::convert(message_value, unit, addr_unit));
+      return ossia::convert(message_value, unit, addr_unit);
     }
   }
   else
@@ -42,8 +41,7 @@ void message::launch()
           ossia::apply(
               vec_merger{dest, dest}, cur.v, message_value.v);
 
-          addr.push_value(std::move(cur));
-          break;
+          return cur;
         }
         case ossia::val_type::LIST:
         {
@@ -51,8 +49,7 @@ void message::launch()
           // Insert the value of this message in the existing value array
           value_merger<true>::insert_in_list(
               cur_list, message_value, dest.index);
-          addr.push_value(std::move(cur));
-          break;
+          return cur;
         }
         default:
         {
@@ -60,39 +57,48 @@ void message::launch()
           std::vector<ossia::value> t{std::move(cur)};
           value_merger<true>::insert_in_list(
               t, message_value, dest.index);
-          addr.push_value(std::move(t));
-          break;
+          return t;
         }
       }
     }
     else
     {
-      addr.push_value(ossia::to_value(ossia::convert(
+      return ossia::to_value(ossia::convert(
           ossia::merge(
               ossia::convert(ossia::net::get_value(addr), unit),
               std::move(message_value), dest.index),
-          addr_unit)));
+          addr_unit));
     }
   }
 }
 
-void piecewise_message::launch()
+void message::launch()
+{
+  dest.value.get().push_value(resolve());
+}
+
+ossia::value piecewise_message::resolve()
 {
   // If values are missing, merge with the existing ones
   auto cur = address.get().value();
   if (auto cur_list = cur.target<std::vector<ossia::value>>())
   {
     value_merger<true>::merge_list(*cur_list, std::move(message_value));
-    address.get().push_value(std::move(cur));
+    return cur;
   }
   else
   {
-    address.get().push_value(std::move(message_value));
+    return std::move(message_value);
   }
 }
 
+void piecewise_message::launch()
+{
+  address.get().push_value(resolve());
+}
+
 template <std::size_t N>
-void piecewise_vec_message<N>::launch()
+ossia::value piecewise_vec_message<N>::resolve()
 {
   ossia::net::parameter_base& addr = address.get();
   auto addr_unit = addr.get_unit();
@@ -100,7 +106,7 @@ void piecewise_vec_message<N>::launch()
   {
     if (used_values.all())
     {
-      addr.push_value(std::move(message_value));
+      return message_value;
     }
     else
     {
@@ -117,7 +123,7 @@ void piecewise_vec_message<N>::launch()
           }
         }
 
-        addr.push_value(val);
+        return val;
       }
     }
   }
@@ -145,8 +151,7 @@ void piecewise_vec_message<N>::launch()
       }
       */
 
-      addr.push_value(
-          ossia::convert(std::move(message_value), unit, addr_unit));
+      return ossia::convert(std::move(message_value), unit, addr_unit);
     }
     else
     {
@@ -166,7 +171,7 @@ void piecewise_vec_message<N>::launch()
       }
       */
 
-      addr.push_value(to_value( // Go from Unit domain to Value domain
+      return to_value( // Go from Unit domain to Value domain
           convert(              // Convert to the resulting address unit
               merge(       // Merge the automation value with the "unit" value
                   convert( // Put the current value in the Unit domain
@@ -174,11 +179,24 @@ void piecewise_vec_message<N>::launch()
                   std::move(
                       message_value), // Compute the output of the automation
                   used_values),
-              addr.get_unit())));
+              addr.get_unit()));
     }
   }
+
+  // The current value is not of the right type
+  return {};
+}
+
+template <std::size_t N>
+void piecewise_vec_message<N>::launch()
+{
+  if (auto v = resolve(); v.valid())
+    address.get().push_value(std::move(v));
 }
 
+template OSSIA_EXPORT ossia::value piecewise_vec_message<2>::resolve();
+template OSSIA_EXPORT ossia::value piecewise_vec_message<3>::resolve();
+template OSSIA_EXPORT ossia::value piecewise_vec_message<4>::resolve();
 template OSSIA_EXPORT void piecewise_vec_message<2>::launch();
 template OSSIA_EXPORT void piecewise_vec_message<3>::launch();
 template OSSIA_EXPORT void piecewise_vec_message<4>::launch();
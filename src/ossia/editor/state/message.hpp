@@ -35,6 +35,8 @@ struct OSSIA_EXPORT message
   {
     return dest.unit;
   }
+  //! The value launch() pushes to the parameter
+  ossia::value resolve();
   void launch();
 
   friend bool operator==(const message& lhs, const message& rhs)
@@ -81,6 +83,9 @@ struct OSSIA_EXPORT piecewise_message
   {
     return unit;
   }
+  //! The value launch() pushes to the parameter. Consumes the value of the
+  //! message.
+  ossia::value resolve();
   void launch();
 
   friend bool
@@ -110,6 +115,8 @@ struct piecewise_vec_message
   {
     return unit;
   }
+  //! The value launch() pushes to the parameter, invalid if there is none
+  ossia::value resolve();
   void launch();
 
   friend bool operator==(
@@ -5,6 +5,11 @@
 
 #include <concurrentqueue.h>
 
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace ossia
 {
 struct received_value
@@ -13,6 +18,32 @@ struct received_value
   ossia::value value;
 };
 
+//! How the values of a parameter registered in a message_queue are queued
+struct message_queue_policy
+{
+  enum mode_t
+  {
+    //! Every value is queued
+    unbounded,
+    //! At most size values of the parameter are in the queue, the next ones
+    //! are dropped
+    bounded,
+    //! Only the last size values of the parameter are kept. They are
+    //! dequeued before the values of the parameters in the other modes,
+    //! even older ones.
+    coalescing
+  } mode{unbounded};
+
+  std::size_t size{1};
+};
+
+//! Values lost by a message_queue because of its policies
+struct message_queue_stats
+{
+  uint64_t dropped{};
+  uint64_t coalesced{};
+};
+
 class message_queue final : public Nano::Observer
 {
 public:
@@ -26,9 +57,9 @@ public:
   {
     try
     {
-      for (auto reg : m_reg)
+      for (auto& reg : m_reg)
       {
-        reg.first->remove_callback(reg.second.second);
+        reg.first->remove_callback(reg.second.callback);
       }
     }
     catch (...)
@@ -36,25 +67,91 @@ public:
     }
   }
 
+  /**
+   * @brief Dequeues the next value.
+   *
+   * The values are in order for each parameter, but not across parameters:
+   * the ones of the parameters in coalescing mode are dequeued first, as
+   * their values are not in m_queue. Never waits: a coalescing parameter
+   * which is receiving a value is tried again on the next call.
+   */
   bool try_dequeue(ossia::received_value& v)
   {
-    return m_queue.try_dequeue(v);
+    while (m_current || m_pending.try_dequeue(m_current))
+    {
+      const auto res = m_current->pop(v);
+      if (res == slot::popped)
+        return true;
+      if (res == slot::busy)
+        break;
+      m_current.reset();
+    }
+
+    queued_value q;
+    if (m_queue.try_dequeue(q))
+    {
+      if (q.owner)
+        q.owner->queued.fetch_sub(1, std::memory_order_relaxed);
+      v = std::move(q.value);
+      return true;
+    }
+    return false;
   }
 
-  void reg(ossia::net::parameter_base& p)
+  /**
+   * @brief Starts queuing the values of a parameter.
+   *
+   * A parameter can be registered many times, and is removed after as many
+   * calls to unreg. The policy is the one of the first registration.
+   */
+  void reg(ossia::net::parameter_base& p, message_queue_policy policy = {})
   {
     auto ptr = &p;
     auto reg_it = m_reg.find(&p);
     if (reg_it == m_reg.end())
     {
-      auto it = p.add_callback([this, ptr](const ossia::value& val) {
-        m_queue.enqueue({ptr, val});
-      });
-      m_reg.insert({&p, {0, it}});
+      registration r;
+      switch (policy.mode)
+      {
+        case message_queue_policy::unbounded:
+          r.callback = p.add_callback([this, ptr](const ossia::value& val) {
+            m_queue.enqueue({{ptr, val}, nullptr});
+          });
+          break;
+
+        case message_queue_policy::bounded:
+        {
+          auto s = std::make_shared<slot>(p, policy);
+          r.callback = p.add_callback([this, s](const ossia::value& val) {
+            if (s->queued.fetch_add(1, std::memory_order_relaxed)
+                >= s->policy.size)
+            {
+              s->queued.fetch_sub(1, std::memory_order_relaxed);
+              m_dropped.fetch_add(1, std::memory_order_relaxed);
+              return;
+            }
+            m_queue.enqueue({{s->param, val}, s});
+          });
+          break;
+        }
+
+        case message_queue_policy::coalescing:
+        {
+          auto s = std::make_shared<slot>(p, policy);
+          r.callback = p.add_callback([this, s](const ossia::value& val) {
+            if (s->push(val))
+              m_coalesced.fetch_add(1, std::memory_order_relaxed);
+            if (!s->pending.exchange(true))
+              m_pending.enqueue(s);
+          });
+          break;
+        }
+      }
+      m_reg.insert({&p, std::move(r)});
     }
     else
     {
-      reg_it.value().first++;
+      reg_it.value().count++;
     }
   }
 
@@ -63,15 +160,22 @@ public:
     auto it = m_reg.find(&p);
     if (it != m_reg.end())
     {
-      it.value().first--;
-      if(it.value().first <= 0)
+      it.value().count--;
+      if(it.value().count <= 0)
       {
-        p.remove_callback(it->second.second);
+        p.remove_callback(it->second.callback);
         m_reg.erase(it);
       }
     }
   }
 
+  message_queue_stats stats() const noexcept
+  {
+    return {
+        m_dropped.load(std::memory_order_relaxed),
+        m_coalesced.load(std::memory_order_relaxed)};
+  }
+
 private:
   void on_param_removed(const ossia::net::parameter_base& p)
   {
@@ -80,12 +184,120 @@ private:
       m_reg.erase(it);
   }
 
-  moodycamel::ConcurrentQueue<received_value> m_queue;
+  //! Values of a parameter in bounded or coalescing mode.
+  //! Shared by the callback and the queued messages.
+  struct slot
+  {
+    slot(ossia::net::parameter_base& p, message_queue_policy pol)
+        : param{&p}, policy{pol}
+    {
+      if (policy.size == 0)
+        policy.size = 1;
+      if (policy.mode == message_queue_policy::coalescing)
+        values.resize(policy.size);
+    }
+
+    //! Returns true if the oldest value was overwritten
+    bool push(const ossia::value& v)
+    {
+      // The value is copied, and the one it replaces freed, out of the lock
+      ossia::value copy = v;
+
+      lock();
+      bool overwritten = false;
+      if (count == values.size())
+      {
+        first = (first + 1) % values.size();
+        count--;
+        overwritten = true;
+      }
+      std::swap(values[(first + count) % values.size()], copy);
+      count++;
+      unlock();
+      return overwritten;
+    }
+
+    enum pop_result
+    {
+      popped,
+      empty,
+      busy
+    };
+
+    pop_result pop(ossia::received_value& v)
+    {
+      if (!try_lock())
+        return busy;
+
+      if (count == 0)
+      {
+        // The next value will put the slot in the queue again
+        pending.store(false);
+        unlock();
+        return empty;
+      }
+
+      ossia::value res = std::move(values[first]);
+      first = (first + 1) % values.size();
+      count--;
+      unlock();
+
+      v.address = param;
+      v.value = std::move(res);
+      return popped;
+    }
+
+    // The lock is only held while values are moved
+    void lock() noexcept
+    {
+      while (!try_lock())
+        ;
+    }
+    bool try_lock() noexcept
+    {
+      return !lock_flag.test_and_set(std::memory_order_acquire);
+    }
+    void unlock() noexcept
+    {
+      lock_flag.clear(std::memory_order_release);
+    }
+
+    ossia::net::parameter_base* param{};
+    message_queue_policy policy;
+
+    // bounded: number of values of the parameter in m_queue
+    std::atomic<std::size_t> queued{};
+
+    // coalescing: ring buffer of the last values
+    std::vector<ossia::value> values;
+    std::size_t first{};
+    std::size_t count{};
+    std::atomic_flag lock_flag = ATOMIC_FLAG_INIT;
+    std::atomic_bool pending{};
+  };
+
+  struct queued_value
+  {
+    received_value value;
+    std::shared_ptr<slot> owner;
+  };
+
+  struct registration
+  {
+    int count{};
+    ossia::net::parameter_base::callback_index callback;
+  };
+
+  moodycamel::ConcurrentQueue<queued_value> m_queue;
+
+  // Coalescing slots which got values since they were last emptied
+  moodycamel::ConcurrentQueue<std::shared_ptr<slot>> m_pending;
+  std::shared_ptr<slot> m_current;
+
+  std::atomic<uint64_t> m_dropped{};
+  std::atomic<uint64_t> m_coalesced{};
 
-  ossia::ptr_map<
-      ossia::net::parameter_base*,
-        std::pair<int, ossia::net::parameter_base::callback_index>>
-      m_reg;
+  ossia::ptr_map<ossia::net::parameter_base*, registration> m_reg;
 };
 
 class global_message_queue final : public Nano::Observer
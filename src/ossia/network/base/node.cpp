@@ -3,6 +3,7 @@
 #include <ossia/detail/algorithms.hpp>
 #include <ossia/detail/logger.hpp>
 #include <ossia/detail/optional.hpp>
+#include <ossia/detail/string_map.hpp>
 #include <ossia/network/base/device.hpp>
 #include <ossia/network/base/node.hpp>
 #include <ossia/network/base/node_attributes.hpp>
@@ -13,9 +14,11 @@
 #include <ossia/network/domain/domain.hpp>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast/try_lexical_convert.hpp>
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <iostream>
 #if defined(OSSIA_QT)
 #include <ossia-qt/name_utils.hpp>
@@ -25,6 +28,190 @@ namespace ossia
 {
 namespace net
 {
+/**
+ * @brief Name -> child lookup table of a node.
+ *
+ * Also tracks the instance numbers in use for each root name
+ * (e.g. 12 for "light.12"), so that sanitizing a name does not have to look
+ * at every sibling.
+ * This gives the same names than sanitize_name(std::string&, const children_t&).
+ *
+ * Only built for nodes with more than threshold children.
+ * While it exists, the children are only appended or removed by node_base,
+ * which keeps it up to date: the subclasses which modify m_children directly
+ * call children_changed(), which drops it.
+ */
+class children_index
+{
+public:
+  static const constexpr std::size_t threshold = 32;
+  static const constexpr std::size_t npos = std::size_t(-1);
+
+  void rebuild(const node_base::children_t& children)
+  {
+    m_names.clear();
+    m_roots.clear();
+    m_names.reserve(children.size());
+    for (std::size_t i = 0; i < children.size(); i++)
+      insert(*children[i], i);
+  }
+
+  node_base* find(ossia::string_view name) const noexcept
+  {
+    auto it = m_names.find(name);
+    return it != m_names.end() ? it->second.node : nullptr;
+  }
+
+  /**
+   * @brief Position of a child in the children vector, or npos.
+   *
+   * Children are only appended after the index is built, and removing one
+   * moves the next ones back: a child is at most at the position it was
+   * inserted at, minus the number of earlier children removed since.
+   */
+  std::size_t position(
+      const node_base& n, const node_base::children_t& children) const noexcept
+  {
+    auto it = m_names.find(n.get_name());
+    if (it == m_names.end() || it->second.node != &n || children.empty())
+      return npos;
+
+    std::size_t pos = std::min(it->second.position, children.size() - 1);
+    for (;;)
+    {
+      if (children[pos].get() == &n)
+        return pos;
+      if (pos == 0)
+        return npos;
+      pos--;
+    }
+  }
+
+  void insert(node_base& n, std::size_t position)
+  {
+    const auto& name = n.get_name();
+    m_names.insert({name, entry{&n, position}});
+
+    ossia::string_view root;
+    int instance{};
+    if (split_instance(name, root, instance))
+    {
+      auto it = m_roots.find(root);
+      if (it == m_roots.end())
+      {
+        m_roots.insert({std::string(root), instances{instance, 1, false}});
+      }
+      else
+      {
+        auto& inst = it.value();
+        inst.max = std::max(inst.max, instance);
+        inst.count++;
+      }
+    }
+  }
+
+  //! Returns the position the child was inserted at, or npos.
+  std::size_t erase(const std::string& name)
+  {
+    auto node_it = m_names.find(name);
+    if (node_it == m_names.end())
+      return npos;
+    const auto position = node_it->second.position;
+    m_names.erase(node_it);
+
+    ossia::string_view root;
+    int instance{};
+    if (split_instance(name, root, instance))
+    {
+      auto it = m_roots.find(root);
+      if (it == m_roots.end())
+        return position;
+
+      auto& inst = it.value();
+      if (--inst.count == 0)
+        m_roots.erase(it);
+      else if (instance == inst.max)
+        inst.dirty = true;
+    }
+    return position;
+  }
+
+  //! Makes a name unique among the children, like sanitize_name would.
+  void sanitize(std::string& name, const node_base::children_t& children)
+  {
+    if (m_names.find(name) == m_names.end())
+      return;
+
+    ossia::string_view root = name;
+    int instance{};
+    split_instance(name, root, instance);
+
+    int next = 1;
+    auto it = m_roots.find(root);
+    if (it != m_roots.end())
+    {
+      auto& inst = it.value();
+      if (inst.dirty)
+      {
+        // The largest instance was removed: look for the new one.
+        bool first = true;
+        for (auto& cld : children)
+        {
+          ossia::string_view r;
+          int n{};
+          if (split_instance(cld->get_name(), r, n) && r == root)
+          {
+            inst.max = first ? n : std::max(inst.max, n);
+            first = false;
+          }
+        }
+        inst.dirty = false;
+      }
+      next = inst.max + 1;
+    }
+
+    std::string res;
+    res.reserve(root.size() + 8);
+    res.append(root.data(), root.size());
+    res += '.';
+    res += std::to_string(next);
+    name = std::move(res);
+  }
+
+private:
+  struct entry
+  {
+    node_base* node{};
+    std::size_t position{};
+  };
+
+  struct instances
+  {
+    int max{};
+    int count{};
+    bool dirty{};
+  };
+
+  // "foo.12" -> ("foo", 12). Names without an instance number are unchanged.
+  static bool split_instance(
+      ossia::string_view name, ossia::string_view& root, int& instance)
+  {
+    const auto pos = name.find_last_of('.');
+    if (pos == ossia::string_view::npos)
+      return false;
+
+    if (!boost::conversion::detail::try_lexical_convert(
+            name.data() + pos + 1, name.size() - pos - 1, instance))
+      return false;
+
+    root = name.substr(0, pos);
+    return true;
+  }
+
+  ossia::string_map<entry> m_names;
+  ossia::string_map<instances> m_roots;
+};
+
 node_base::~node_base() = default;
 
 void node_base::set_parameter(std::unique_ptr<parameter_base>)
@@ -63,6 +250,37 @@ void node_base::set(string_view str, bool value)
   }
 }
 
+children_index* node_base::update_children_index(std::size_t expected_size)
+{
+  if (!m_childrenIndex)
+  {
+    if (expected_size < children_index::threshold)
+      return nullptr;
+
+    m_childrenIndex = std::make_unique<children_index>();
+    m_childrenIndex->rebuild(m_children);
+  }
+  return m_childrenIndex.get();
+}
+
+void node_base::children_changed() noexcept
+{
+  m_childrenIndex.reset();
+}
+
+void node_base::sanitize_child_name(std::string& name, children_index* index)
+{
+  if (index)
+  {
+    ossia::net::sanitize_name(name);
+    index->sanitize(name, m_children);
+  }
+  else
+  {
+    sanitize_name(name, m_children);
+  }
+}
+
 node_base* node_base::create_child(std::string name)
 {
   auto& dev = get_device();
@@ -72,12 +290,15 @@ node_base* node_base::create_child(std::string name)
   {
     write_lock_t lock{m_mutex};
 
-    sanitize_name(name, m_children);
+    auto index = update_children_index(m_children.size() + 1);
+    sanitize_child_name(name, index);
     auto res = make_child(name);
 
     if ((ptr = res.get()))
     {
       m_children.push_back(std::move(res));
+      if (index)
+        index->insert(*ptr, m_children.size() - 1);
     }
   }
 
@@ -88,6 +309,64 @@ node_base* node_base::create_child(std::string name)
   return ptr;
 }
 
+std::vector<node_base*>
+node_base::create_children(const std::vector<std::string>& names)
+{
+  std::vector<node_base*> created;
+  auto& dev = get_device();
+  if (!dev.get_capabilities().change_tree)
+    return created;
+
+  created.reserve(names.size());
+  {
+    write_lock_t lock{m_mutex};
+    m_children.reserve(m_children.size() + names.size());
+
+    auto index = update_children_index(m_children.size() + names.size());
+    for (std::string name : names)
+    {
+      sanitize_child_name(name, index);
+      auto res = make_child(name);
+
+      auto ptr = res.get();
+      if (ptr)
+      {
+        m_children.push_back(std::move(res));
+        if (index)
+          index->insert(*ptr, m_children.size() - 1);
+      }
+      created.push_back(ptr);
+    }
+  }
+
+  for (auto ptr : created)
+  {
+    if (ptr)
+      dev.on_node_created(*ptr);
+  }
+  return created;
+}
+
+void node_base::rename_child(node_base& child, std::string name)
+{
+  write_lock_t lock{m_mutex};
+
+  // The child does not count as a sibling of itself
+  auto old_name = std::move(child.m_name);
+  child.m_name.clear();
+
+  auto index = update_children_index(m_children.size());
+  std::size_t position{};
+  if (index)
+    position = index->erase(old_name);
+
+  sanitize_child_name(name, index);
+  child.m_name = std::move(name);
+
+  if (index)
+    index->insert(child, position);
+}
+
 std::vector<std::string> node_base::children_names() const
 {
   SPDLOG_TRACE((&ossia::logger()), "locking(childrenNames)");
@@ -145,17 +424,22 @@ node_base* node_base::add_child(std::unique_ptr<node_base> n)
 
   if (n)
   {
-    const auto& name = n->get_name();
-    if (name == sanitize_name(name, children_names()))
+    auto ptr = n.get();
     {
-      auto ptr = n.get();
-      {
-        write_lock_t lock{m_mutex};
-        m_children.push_back(std::move(n));
-      }
-      dev.on_node_created(*ptr);
-      return ptr;
+      write_lock_t lock{m_mutex};
+
+      auto index = update_children_index(m_children.size() + 1);
+      auto name = n->get_name();
+      sanitize_child_name(name, index);
+      if (name != n->get_name())
+        return nullptr;
+
+      m_children.push_back(std::move(n));
+      if (index)
+        index->insert(*ptr, m_children.size() - 1);
     }
+    dev.on_node_created(*ptr);
+    return ptr;
   }
   return nullptr;
 }
@@ -166,6 +450,12 @@ node_base* node_base::find_child(ossia::string_view name)
     SPDLOG_TRACE((&ossia::logger()), "locking(findChild)");
     read_lock_t lock{m_mutex};
     SPDLOG_TRACE((&ossia::logger()), "locked(findChild)");
+    if (m_childrenIndex)
+    {
+      SPDLOG_TRACE((&ossia::logger()), "unlocked(findChild)");
+      return m_childrenIndex->find(name);
+    }
+
     for (auto& node : m_children)
     {
       if (node->get_name() == name)
@@ -224,13 +514,30 @@ bool node_base::remove_child(const std::string& name)
   std::unique_ptr<ossia::net::node_base> cld;
   {
     write_lock_t lock{m_mutex};
-    auto it = find_if(
-        m_children, [&](const auto& c) { return c->get_name() == n; });
+    auto index = update_children_index(m_children.size());
+
+    auto it = m_children.end();
+    if (index)
+    {
+      if (auto ptr = index->find(n))
+      {
+        auto pos = index->position(*ptr, m_children);
+        if (pos != children_index::npos)
+          it = m_children.begin() + pos;
+      }
+    }
+    else
+    {
+      it = find_if(
+          m_children, [&](const auto& c) { return c->get_name() == n; });
+    }
 
     if (it != m_children.end())
     {
       cld = std::move(*it);
       m_children.erase(it);
+      if (index)
+        index->erase(n);
     }
   }
 
@@ -257,13 +564,25 @@ bool node_base::remove_child(const node_base& n)
   std::unique_ptr<ossia::net::node_base> cld;
   {
     write_lock_t lock{m_mutex};
-    auto it
-        = find_if(m_children, [&](const auto& c) { return c.get() == &n; });
+    auto index = update_children_index(m_children.size());
+    auto it = m_children.end();
+    if (index)
+    {
+      auto pos = index->position(n, m_children);
+      if (pos != children_index::npos)
+        it = m_children.begin() + pos;
+    }
+    else
+    {
+      it = find_if(m_children, [&](const auto& c) { return c.get() == &n; });
+    }
 
     if (it != m_children.end())
     {
       cld = std::move(*it);
       m_children.erase(it);
+      if (index)
+        index->erase(cld->get_name());
     }
   }
 
@@ -292,6 +611,8 @@ void node_base::clear_children()
   {
     write_lock_t lock{m_mutex};
     to_remove = std::move(m_children);
+    m_children.clear();
+    m_childrenIndex.reset();
   }
 
   for (auto& child : to_remove)
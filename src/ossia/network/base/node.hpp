@@ -13,6 +13,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #if defined(OSSIA_QT)
 class QString;
 #endif
@@ -23,6 +24,7 @@ namespace net
 class device_base;
 class parameter_base;
 class node_base;
+class children_index;
 /**
  * @brief The node_base class
  *
@@ -134,6 +136,15 @@ public:
    */
   node_base* create_child(std::string name);
 
+  /**
+   * @brief Adds many children in one go.
+   *
+   * Equivalent to calling create_child for each name, but the tree is locked
+   * only once. The returned vector has one entry per name: it is null when
+   * the child could not be created.
+   */
+  std::vector<node_base*> create_children(const std::vector<std::string>& names);
+
   /**
    * @brief Adds a new child if it can be added.
    *
@@ -193,6 +204,14 @@ public:
   //! If childrens are /foo, /bar, bar.1, returns true only for bar.
   bool is_root_instance(const ossia::net::node_base& child) const;
 
+  /**
+   * @brief Gives a new name to a child of this node.
+   *
+   * The name is made unique among the siblings of the child.
+   * To be called by the set_name implementations.
+   */
+  void rename_child(node_base& child, std::string name);
+
   const std::string& osc_address() const
   {
     return m_oscAddressCache;
@@ -209,11 +228,22 @@ protected:
   //! Reimplement for a specific removal action.
   virtual void removing_child(node_base& node_base) = 0;
 
+  //! To call after modifying m_children directly, with m_mutex locked.
+  void children_changed() noexcept;
+
   std::string m_name;
   children_t m_children;
   mutable shared_mutex_t m_mutex;
   extended_attributes m_extended{0};
   std::string m_oscAddressCache;
+
+private:
+  // m_mutex must be locked for writing for these two
+  children_index* update_children_index(std::size_t expected_size);
+  void sanitize_child_name(std::string& name, children_index* index);
+
+  //! Name lookup for the nodes with many children, e.g. /light.1 ... /light.10000
+  std::unique_ptr<children_index> m_childrenIndex;
 };
 }
 }
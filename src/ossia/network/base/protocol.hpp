@@ -135,6 +135,12 @@ public:
   virtual void stop_execution()
   {
   }
+
+  //! Sends the messages that the protocol may have queued since the last
+  //! call. Called by the execution engine at the end of each tick.
+  virtual void flush()
+  {
+  }
   virtual void stop()
   {
   }
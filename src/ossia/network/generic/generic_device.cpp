@@ -35,6 +35,7 @@ generic_device::~generic_device()
   {
     write_lock_t lock{m_mutex};
     m_children.clear();
+    children_changed();
   }
 
   m_protocol.reset();
@@ -51,12 +51,10 @@ void generic_node_base::on_address_change()
 
 node_base& generic_node_base::set_name(std::string name)
 {
-  auto old_name = std::move(m_name);
+  auto old_name = m_name;
   if (m_parent)
   {
-    read_lock_t lock{m_mutex};
-    sanitize_name(name, m_parent->unsafe_children());
-    m_name = name;
+    m_parent->rename_child(*this, std::move(name));
   }
   else
   {
@@ -22,6 +22,7 @@ generic_parameter::generic_parameter(ossia::net::node_base& node)
     , m_accessMode(ossia::access_mode::BI)
     , m_boundingMode(ossia::bounding_mode::FREE)
     , m_value(ossia::impulse{})
+    , m_cell(m_value)
 {
 }
 
@@ -33,6 +34,7 @@ generic_parameter::generic_parameter(
     , m_accessMode(get_value_or(data.access, ossia::access_mode::BI))
     , m_boundingMode(get_value_or(data.bounding, ossia::bounding_mode::FREE))
     , m_value(init_value(m_valueType))
+    , m_cell(m_value)
 {
   m_repetitionFilter
       = get_value_or(data.rep_filter, ossia::repetition_filter::OFF);
@@ -91,15 +93,15 @@ const ossia::value& generic_parameter::getValue() const
 
 ossia::value generic_parameter::value() const
 {
-  lock_t lock(m_valueMutex);
-
-  return m_value;
+  return m_cell.load();
 }
 
 ossia::value
 generic_parameter::set_value(const ossia::value& val)
 {
   ossia::value copy;
+  // Freed once the lock is released
+  ossia::value_cell::retired previous;
 
   if (val.valid())
   {
@@ -116,6 +118,7 @@ generic_parameter::set_value(const ossia::value& val)
       m_value = ossia::convert(val, m_previousValue);
       copy = m_value;
     }
+    previous = m_cell.store(copy);
   }
   send(copy);
 
@@ -126,6 +129,7 @@ ossia::value generic_parameter::set_value(ossia::value&& val)
 {
   using namespace ossia;
   ossia::value copy;
+  ossia::value_cell::retired previous;
   if (val.valid())
   {
     lock_t lock(m_valueMutex);
@@ -141,6 +145,7 @@ ossia::value generic_parameter::set_value(ossia::value&& val)
       m_value = ossia::convert(std::move(val), m_previousValue);
       copy = m_value;
     }
+    previous = m_cell.store(copy);
   }
 
   send(copy);
@@ -153,6 +158,7 @@ void generic_parameter::set_value_quiet(const ossia::value& val)
   if (!val.valid())
     return;
 
+  ossia::value_cell::retired previous;
   lock_t lock(m_valueMutex);
   if (m_value.v.which() == val.v.which())
   {
@@ -164,6 +170,7 @@ void generic_parameter::set_value_quiet(const ossia::value& val)
     m_previousValue = std::move(m_value);
     m_value = ossia::convert(val, m_previousValue);
   }
+  previous = m_cell.store(m_value);
 }
 
 void generic_parameter::set_value_quiet(ossia::value&& val)
@@ -172,6 +179,7 @@ void generic_parameter::set_value_quiet(ossia::value&& val)
   if (!val.valid())
     return;
 
+  ossia::value_cell::retired previous;
   lock_t lock(m_valueMutex);
   if (m_value.v.which() == val.v.which())
   {
@@ -183,15 +191,18 @@ void generic_parameter::set_value_quiet(ossia::value&& val)
     m_previousValue = std::move(m_value);
     m_value = ossia::convert(std::move(val), m_previousValue);
   }
+  previous = m_cell.store(m_value);
 }
 
 void generic_parameter::set_value_quiet(const destination& destination)
 {
+  ossia::value_cell::retired previous;
   lock_t lock(m_valueMutex);
   if (destination.address().get_value_type() == m_valueType)
   {
     m_previousValue = std::move(m_value); // TODO also implement me for MIDI
     m_value = destination.address().fetch_value();
+    previous = m_cell.store(m_value);
   }
   else
   {
@@ -212,12 +223,14 @@ ossia::net::generic_parameter&
 generic_parameter::set_value_type(ossia::val_type type)
 {
   {
+    ossia::value_cell::retired previous;
     lock_t lock(m_valueMutex);
     // std::cerr << address_string_from_node(*this) << " TYPE CHANGE : " <<
     // (int) mValueType << " <=== " << (int) type << std::endl;
     m_valueType = type;
 
     m_value = init_value(type);
+    previous = m_cell.store(m_value);
     if (m_domain)
     {
       convert_compatible_domain(m_domain, m_valueType);
@@ -297,6 +310,7 @@ void generic_parameter::on_removing_last_callback()
 generic_parameter& generic_parameter::set_unit(const unit_t& v)
 {
   {
+    ossia::value_cell::retired previous;
     lock_t lock(m_valueMutex);
     m_unit = v;
 
@@ -308,6 +322,7 @@ generic_parameter& generic_parameter::set_unit(const unit_t& v)
       {
         m_valueType = vt;
         m_value = ossia::convert(m_value, m_valueType);
+        previous = m_cell.store(m_value);
         if (m_domain)
         {
           convert_compatible_domain(m_domain, m_valueType);
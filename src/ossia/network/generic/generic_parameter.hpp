@@ -7,6 +7,7 @@
 #include <ossia/network/domain/domain.hpp>
 #include <ossia/network/generic/generic_device.hpp>
 #include <ossia/network/value/value.hpp>
+#include <ossia/network/value/value_cell.hpp>
 
 #include <string>
 #include <thread>
@@ -31,8 +32,11 @@ protected:
   ossia::access_mode m_accessMode{};
   ossia::bounding_mode m_boundingMode{};
 
+  //! Serializes the writers of m_value
   mutable mutex_t m_valueMutex;
   ossia::value m_value;
+  //! Copy of m_value, which value() reads without locking
+  ossia::value_cell m_cell;
 
   ossia::domain m_domain;
 
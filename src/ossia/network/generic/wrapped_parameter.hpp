@@ -43,6 +43,7 @@ public:
 
     write_lock_t lock{m_mutex};
     m_children.clear();
+    children_changed();
     m_parameter.reset();
   }
 
@@ -82,6 +83,7 @@ public:
     {
       write_lock_t lock{m_mutex};
       m_children.push_back(std::move(p));
+      children_changed();
     }
   }
 
@@ -171,6 +173,7 @@ public:
     {
       write_lock_t lock{this->m_mutex};
       this->m_children.clear();
+      this->children_changed();
     }
 
     // Parameters, etc of the device's own node must also be cleared
@@ -70,6 +70,7 @@ bool midi_device::create_full_tree()
 
       write_lock_t lock{m_mutex};
       m_children.push_back(std::move(ptr));
+      children_changed();
     }
   }
   catch (std::exception& e)
@@ -83,6 +83,7 @@ midi_node* midi_node::add_midi_node(std::unique_ptr<midi_node> n)
   {
     write_lock_t lock{m_mutex};
     m_children.push_back(std::move(n));
+    children_changed();
   }
   m_device.on_node_created(*ptr);
   return ptr;
@@ -32,6 +32,7 @@ minuit_protocol::minuit_protocol(
     , m_ip{remote_ip}
     , m_remotePort{remote_port}
     , m_localPort{local_port}
+    , m_index{std::make_unique<osc_address_index>()}
     , m_sender{std::make_unique<osc::sender<osc_outbound_visitor>>(
           m_logger, remote_ip, remote_port)}
     , m_receiver{std::make_unique<osc::receiver>(
@@ -65,6 +66,7 @@ minuit_protocol::~minuit_protocol()
 void minuit_protocol::set_device(ossia::net::device_base& dev)
 {
   m_device = &dev;
+  m_index->attach(dev);
 }
 
 const std::string& minuit_protocol::get_ip() const
@@ -305,6 +307,7 @@ bool minuit_protocol::observe(ossia::net::parameter_base& address, bool enable)
     this->m_sender->send(act, address, "disable");
     m_listening.erase(address.get_node().osc_address());
   }
+  m_index->set_listening(address, enable);
 
   m_lastSentMessage = get_time();
 
@@ -319,6 +322,7 @@ bool minuit_protocol::observe_quietly(
         std::make_pair(address.get_node().osc_address(), &address));
   else
     m_listening.erase(address.get_node().osc_address());
+  m_index->set_listening(address, enable);
 
   return true;
 }
@@ -388,7 +392,7 @@ void minuit_protocol::on_received_message(
 
   if (!address.empty() && address[0] == '/')
   {
-    ossia::net::handle_osc_message<true>(m, m_listening, *m_device, m_logger);
+    ossia::net::handle_osc_message<true>(m, *m_index, *m_device, m_logger);
   }
   else
   {
@@ -29,6 +29,7 @@ namespace ossia
 namespace net
 {
 struct osc_outbound_visitor;
+class osc_address_index;
 class generic_device;
 class OSSIA_EXPORT minuit_protocol final : public ossia::net::protocol_base
 {
@@ -95,6 +96,7 @@ private:
                           /// to (opened in this library)
 
   listened_parameters m_listening;
+  std::unique_ptr<osc_address_index> m_index;
 
   std::promise<void> m_namespaceFinishedPromise;
   ossia::net::device_base* m_device{};
@@ -0,0 +1,188 @@
+#pragma once
+#include <oscpack/osc/OscOutboundPacketStream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+
+namespace ossia
+{
+namespace net
+{
+//! The OSC time tag meaning "immediately"
+static const constexpr uint64_t osc_immediate_timetag = 1;
+
+//! Converts a point in time to an OSC (NTP) time tag
+inline uint64_t osc_timetag(std::chrono::system_clock::time_point t) noexcept
+{
+  using namespace std::chrono;
+  // Seconds between 1900-01-01 (NTP epoch) and 1970-01-01 (unix epoch)
+  constexpr uint64_t ntp_offset = 2208988800ULL;
+
+  const auto since_epoch = t.time_since_epoch();
+  const auto secs = duration_cast<seconds>(since_epoch);
+  const auto nanos = duration_cast<nanoseconds>(since_epoch - secs).count();
+
+  const uint64_t hi = uint64_t(secs.count()) + ntp_offset;
+  const uint64_t lo = (uint64_t(nanos) << 32) / 1000000000ULL;
+  return (hi << 32) | lo;
+}
+
+/**
+ * @brief Encodes OSC bundles in persistent buffers.
+ *
+ * The buffers grow as needed and are reused from one bundle to the next,
+ * so that steady-state encoding does not allocate.
+ *
+ * If a maximum packet size is set, bundles that would go past it
+ * are split in several bundles sharing the same time tag; a message which
+ * does not fit in a single packet is sent alone in its own bundle.
+ *
+ * Usage:
+ * \code
+ * enc.begin(timetag);
+ * for(...)
+ *   enc.add([&] (oscpack::OutboundPacketStream& p) { p << ...; }, send);
+ * enc.end(send);
+ * \endcode
+ *
+ * where send is a callable with signature `void(const char*, std::size_t)`.
+ */
+class osc_bundle_encoder
+{
+public:
+  static const constexpr std::size_t header_size = 16; // "#bundle\0" + time
+
+  osc_bundle_encoder()
+  {
+    m_bundle.resize(4096);
+    m_message.resize(1024);
+  }
+
+  //! 0 means no limit
+  void set_max_packet_size(std::size_t sz) noexcept
+  {
+    m_maxPacketSize = sz;
+  }
+
+  std::size_t max_packet_size() const noexcept
+  {
+    return m_maxPacketSize;
+  }
+
+  void begin(uint64_t timetag = osc_immediate_timetag) noexcept
+  {
+    m_timetag = timetag;
+    m_size = 0;
+    m_count = 0;
+  }
+
+  /**
+   * @brief Encodes a message into the current bundle.
+   *
+   * @param write_message Called with an oscpack stream in which the message
+   * must be written, between BeginMessage and EndMessage.
+   * It may be called more than once if the message buffer has to grow.
+   *
+   * @param send Called with each completed datagram.
+   */
+  template <typename F, typename Send>
+  void add(F&& write_message, Send&& send)
+  {
+    const std::size_t msg_size = encode_message(write_message);
+    append(m_message.data(), msg_size, send);
+  }
+
+  //! Adds a message which is already encoded
+  template <typename Send>
+  void add_encoded(const char* message, std::size_t msg_size, Send&& send)
+  {
+    append(message, msg_size, send);
+  }
+
+  //! Sends what remains of the current bundle
+  template <typename Send>
+  void end(Send&& send)
+  {
+    if (m_count > 0)
+      flush(send);
+  }
+
+private:
+  template <typename Send>
+  void append(const char* message, std::size_t msg_size, Send& send)
+  {
+    const std::size_t elt_size = 4 + msg_size;
+
+    if (m_count > 0 && m_maxPacketSize > 0
+        && header_size + m_size + elt_size > m_maxPacketSize)
+    {
+      flush(send);
+    }
+
+    reserve(header_size + m_size + elt_size);
+
+    char* out = m_bundle.data() + header_size + m_size;
+    write_int32(out, uint32_t(msg_size));
+    std::memcpy(out + 4, message, msg_size);
+    m_size += elt_size;
+    m_count++;
+  }
+
+  template <typename F>
+  std::size_t encode_message(F& write_message)
+  {
+    for (;;)
+    {
+      try
+      {
+        oscpack::OutboundPacketStream p{m_message.data(), m_message.size()};
+        write_message(p);
+        return p.Size();
+      }
+      catch (const oscpack::OutOfBufferMemoryException&)
+      {
+        m_message.resize(m_message.size() * 2);
+      }
+    }
+  }
+
+  template <typename Send>
+  void flush(Send& send)
+  {
+    char* data = m_bundle.data();
+    std::memcpy(data, "#bundle\0", 8);
+    write_int32(data + 8, uint32_t(m_timetag >> 32));
+    write_int32(data + 12, uint32_t(m_timetag & 0xFFFFFFFF));
+
+    send(static_cast<const char*>(data), header_size + m_size);
+
+    m_size = 0;
+    m_count = 0;
+  }
+
+  void reserve(std::size_t sz)
+  {
+    if (sz > m_bundle.size())
+      m_bundle.resize(std::max(sz, m_bundle.size() * 2));
+  }
+
+  static void write_int32(char* out, uint32_t v) noexcept
+  {
+    out[0] = char((v >> 24) & 0xFF);
+    out[1] = char((v >> 16) & 0xFF);
+    out[2] = char((v >> 8) & 0xFF);
+    out[3] = char(v & 0xFF);
+  }
+
+  std::vector<char> m_bundle;
+  std::vector<char> m_message;
+  std::size_t m_size{};  // size of the bundle elements, without the header
+  std::size_t m_count{}; // number of messages in the current bundle
+  std::size_t m_maxPacketSize{};
+  uint64_t m_timetag{osc_immediate_timetag};
+};
+}
+}
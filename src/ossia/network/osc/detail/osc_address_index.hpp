@@ -0,0 +1,492 @@
+#pragma once
+#include <ossia/detail/mutex.hpp>
+#include <ossia/detail/optional.hpp>
+#include <ossia/detail/ptr_set.hpp>
+#include <ossia/detail/string_map.hpp>
+#include <ossia/network/base/device.hpp>
+#include <ossia/network/base/node.hpp>
+#include <ossia/network/base/node_functions.hpp>
+#include <ossia/network/base/parameter.hpp>
+#include <ossia/network/common/node_visitor.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ossia
+{
+namespace net
+{
+/**
+ * @brief Dispatch table used by the OSC receivers.
+ *
+ * Maps a full OSC address to the matching parameter, and caches the
+ * results of pattern matches (e.g. `/foo.* /bar`).
+ *
+ * The receiving thread reads an immutable snapshot of the table without
+ * locking. Changes of the device tree are applied incrementally to a master
+ * table under a mutex; until the snapshot is rebuilt, the lookups go to the
+ * master table. The snapshot is only rebuilt after a number of such lookups
+ * proportional to the size of the table, so that a burst of edits mixed
+ * with incoming messages does not copy the table each time.
+ *
+ * Each reader announces the snapshot and the parameter it uses in a hazard
+ * slot:
+ * - a replaced snapshot is freed once no slot holds it, without waiting;
+ * - a writer which removes a parameter only waits for the readers of other
+ *   threads which are dispatching a value to this very parameter.
+ */
+class osc_address_index
+{
+  struct snapshot;
+  struct hazard_slot;
+
+public:
+  struct entry
+  {
+    ossia::net::parameter_base* parameter{};
+    bool listened{};
+  };
+
+  struct pattern_result
+  {
+    std::vector<entry> parameters;
+    //! Address of each parameter
+    std::vector<std::string> addresses;
+    //! Whether the pattern matched any node, even without parameter
+    bool matched{};
+  };
+
+  using map_type = string_map<entry>;
+  using pattern_map = string_map<pattern_result>;
+
+  //! Maximum number of cached pattern results before the cache is flushed.
+  static const constexpr std::size_t max_cached_patterns = 1024;
+
+  //! Maximum number of readers alive at the same time, on all threads.
+  static const constexpr std::size_t max_readers = 64;
+
+  osc_address_index() = default;
+  osc_address_index(const osc_address_index&) = delete;
+  osc_address_index(osc_address_index&&) = delete;
+  osc_address_index& operator=(const osc_address_index&) = delete;
+  osc_address_index& operator=(osc_address_index&&) = delete;
+
+  ~osc_address_index()
+  {
+    detach();
+
+    // No reader can be left at this point
+    delete m_current.load();
+    for (auto s : m_retired)
+      delete s;
+  }
+
+  void attach(ossia::net::device_base& dev)
+  {
+    detach();
+    m_device = &dev;
+
+    dev.on_node_created.connect<&osc_address_index::on_node_created>(this);
+    dev.on_node_removing.connect<&osc_address_index::on_node_removing>(this);
+    dev.on_node_renamed.connect<&osc_address_index::on_node_renamed>(this);
+    dev.on_parameter_created
+        .connect<&osc_address_index::on_parameter_created>(this);
+    dev.on_parameter_removing
+        .connect<&osc_address_index::on_parameter_removing>(this);
+
+    rebuild();
+  }
+
+  void detach()
+  {
+    if (!m_device)
+      return;
+
+    auto& dev = *m_device;
+    dev.on_node_created.disconnect<&osc_address_index::on_node_created>(this);
+    dev.on_node_removing.disconnect<&osc_address_index::on_node_removing>(
+        this);
+    dev.on_node_renamed.disconnect<&osc_address_index::on_node_renamed>(this);
+    dev.on_parameter_created
+        .disconnect<&osc_address_index::on_parameter_created>(this);
+    dev.on_parameter_removing
+        .disconnect<&osc_address_index::on_parameter_removing>(this);
+
+    m_device = nullptr;
+    lock_t lock{m_mutex};
+    m_master.clear();
+    ++m_generation;
+  }
+
+  //! Called from the protocol's observe / observe_quietly
+  void set_listening(const ossia::net::parameter_base& p, bool listened)
+  {
+    lock_t lock{m_mutex};
+    const auto& addr = p.get_node().osc_address();
+    if (listened)
+    {
+      auto& e = m_master[addr];
+      e.parameter = const_cast<ossia::net::parameter_base*>(&p);
+      e.listened = true;
+    }
+    else
+    {
+      auto it = m_master.find(addr);
+      if (it == m_master.end())
+        return;
+      it.value().listened = false;
+    }
+    ++m_generation;
+  }
+
+  /**
+   * @brief Read-side critical section.
+   *
+   * Must only be used from the receiving thread(s), for the duration
+   * of the handling of a single message.
+   *
+   * A parameter returned by find() or given to the function of match()
+   * stays valid until the next call to one of them, or the end of the
+   * reader.
+   */
+  class reader
+  {
+  public:
+    explicit reader(osc_address_index& idx)
+        : m_idx{idx}
+        , m_slot{idx.acquire_slot()}
+    {
+      if (m_idx.m_staleLookups.load(std::memory_order_relaxed)
+          > m_idx.m_republishThreshold.load(std::memory_order_relaxed))
+        m_idx.publish();
+
+      for (;;)
+      {
+        auto s = m_idx.m_current.load();
+        m_slot->snapshot.store(s);
+        if (m_idx.m_current.load() == s)
+        {
+          m_snapshot = s;
+          break;
+        }
+      }
+    }
+
+    ~reader()
+    {
+      m_slot->parameter.store(nullptr);
+      m_slot->snapshot.store(nullptr);
+      m_slot->used.store(false, std::memory_order_release);
+    }
+
+    reader(const reader&) = delete;
+    reader& operator=(const reader&) = delete;
+
+    //! Exact match on a full address.
+    std::optional<entry> find(ossia::string_view addr)
+    {
+      auto& idx = m_idx;
+      const auto gen = idx.m_generation.load();
+      if (m_snapshot && m_snapshot->generation == gen)
+      {
+        auto it = m_snapshot->map.find(addr);
+        if (it == m_snapshot->map.end() || !it->second.parameter)
+          return std::nullopt;
+        if (protect(it->second, addr, gen))
+          return it->second;
+        return std::nullopt;
+      }
+
+      // The table changed since the snapshot was built
+      idx.m_staleLookups.fetch_add(1, std::memory_order_relaxed);
+
+      lock_t lock{idx.m_mutex};
+      auto it = idx.m_master.find(addr);
+      if (it == idx.m_master.end() || !it->second.parameter)
+        return std::nullopt;
+
+      // The writers erase under the mutex before they look at the slots
+      m_slot->parameter.store(it->second.parameter);
+      return it->second;
+    }
+
+    /**
+     * @brief Calls f on the parameters matching a pattern.
+     *
+     * The result of the matching is cached across calls until the tree
+     * changes.
+     *
+     * @return true if the pattern matched any node.
+     */
+    template <typename F>
+    bool match(ossia::string_view pattern, F&& f)
+    {
+      auto& idx = m_idx;
+      if (!idx.m_device)
+        return false;
+
+      const auto gen = idx.m_generation.load();
+      std::unique_lock<mutex_t> lock{idx.m_patternMutex, std::try_to_lock};
+      if (!lock.owns_lock())
+      {
+        // Another receiving thread, or an outer reader, uses the cache
+        auto res = idx.compute_pattern(pattern);
+        dispatch(res, gen, f);
+        return res.matched;
+      }
+
+      if (gen != idx.m_patternGeneration
+          || idx.m_patterns.size() > max_cached_patterns)
+      {
+        idx.m_patterns.clear();
+        idx.m_patternGeneration = gen;
+      }
+
+      auto it = idx.m_patterns.find(pattern);
+      if (it == idx.m_patterns.end())
+      {
+        it = idx.m_patterns
+                 .insert({std::string(pattern), idx.compute_pattern(pattern)})
+                 .first;
+      }
+
+      dispatch(it->second, gen, f);
+      return it->second.matched;
+    }
+
+  private:
+    template <typename F>
+    void dispatch(const pattern_result& res, uint64_t gen, F& f)
+    {
+      for (std::size_t i = 0; i < res.parameters.size(); i++)
+      {
+        if (protect(res.parameters[i], res.addresses[i], gen))
+          f(res.parameters[i]);
+      }
+    }
+
+    // Announces that the parameter of e is in use. If the table changed
+    // since gen, checks that the parameter was not removed meanwhile.
+    bool protect(const entry& e, ossia::string_view addr, uint64_t gen)
+    {
+      auto& idx = m_idx;
+      m_slot->parameter.store(e.parameter);
+      if (idx.m_generation.load() == gen)
+        return true;
+
+      lock_t lock{idx.m_mutex};
+      auto it = idx.m_master.find(addr);
+      if (it != idx.m_master.end() && it->second.parameter == e.parameter)
+        return true;
+
+      m_slot->parameter.store(nullptr);
+      return false;
+    }
+
+    osc_address_index& m_idx;
+    hazard_slot* m_slot{};
+    const snapshot* m_snapshot{};
+  };
+
+private:
+  struct snapshot
+  {
+    map_type map;
+    uint64_t generation{};
+  };
+
+  struct hazard_slot
+  {
+    std::atomic_bool used{};
+    std::atomic<std::thread::id> owner{};
+    std::atomic<const snapshot*> snapshot{};
+    std::atomic<const ossia::net::parameter_base*> parameter{};
+  };
+
+  hazard_slot* acquire_slot() noexcept
+  {
+    for (;;)
+    {
+      for (auto& s : m_slots)
+      {
+        bool expected = false;
+        if (!s.used.load(std::memory_order_relaxed)
+            && s.used.compare_exchange_strong(expected, true))
+        {
+          s.owner.store(std::this_thread::get_id());
+          return &s;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  void rebuild()
+  {
+    if (!m_device)
+      return;
+
+    lock_t lock{m_mutex};
+    ossia::ptr_set<ossia::net::parameter_base*> listened;
+    for (auto& e : m_master)
+      if (e.second.listened)
+        listened.insert(e.second.parameter);
+
+    m_master.clear();
+    ossia::net::visit_parameters(
+        m_device->get_root_node(),
+        [&](ossia::net::node_base& n, ossia::net::parameter_base& p) {
+          m_master.insert(
+              {n.osc_address(), entry{&p, listened.count(&p) > 0}});
+        });
+    ++m_generation;
+  }
+
+  // Builds a new snapshot from the master table and swaps it in.
+  void publish()
+  {
+    lock_t lock{m_mutex};
+    const auto gen = m_generation.load();
+    auto cur = m_current.load();
+    if (cur && cur->generation == gen)
+      return;
+
+    auto next = new snapshot{m_master, gen};
+    if (auto old = m_current.exchange(next))
+      m_retired.push_back(old);
+
+    m_staleLookups.store(0, std::memory_order_relaxed);
+    m_republishThreshold.store(
+        std::max(min_republish_threshold, m_master.size() / 16),
+        std::memory_order_relaxed);
+
+    reclaim();
+  }
+
+  // Frees the replaced snapshots which no reader uses anymore.
+  // m_mutex must be locked.
+  void reclaim()
+  {
+    auto in_use = [this](const snapshot* s) {
+      for (auto& slot : m_slots)
+        if (slot.snapshot.load() == s)
+          return true;
+      return false;
+    };
+
+    auto it = std::remove_if(
+        m_retired.begin(), m_retired.end(), [&](const snapshot* s) {
+          if (in_use(s))
+            return false;
+          delete s;
+          return true;
+        });
+    m_retired.erase(it, m_retired.end());
+  }
+
+  // Waits until no reader of another thread dispatches to p anymore. The
+  // readers of the current thread are not waited for: a value callback
+  // may well edit the tree. Must be called after p was erased from the
+  // master table, without m_mutex.
+  void wait_unused(const ossia::net::parameter_base* p) const noexcept
+  {
+    if (!p)
+      return;
+
+    const auto self = std::this_thread::get_id();
+    for (auto& slot : m_slots)
+    {
+      while (slot.parameter.load() == p && slot.owner.load() != self)
+        std::this_thread::yield();
+    }
+  }
+
+  pattern_result compute_pattern(ossia::string_view pattern)
+  {
+    pattern_result res;
+    auto nodes = ossia::net::find_nodes(m_device->get_root_node(), pattern);
+    res.matched = !nodes.empty();
+    for (auto n : nodes)
+    {
+      if (auto p = n->get_parameter())
+      {
+        auto addr = n->osc_address();
+        bool listened = false;
+        {
+          lock_t lock{m_mutex};
+          auto it = m_master.find(addr);
+          if (it != m_master.end())
+            listened = it->second.listened;
+        }
+        res.parameters.push_back(entry{p, listened});
+        res.addresses.push_back(std::move(addr));
+      }
+    }
+    return res;
+  }
+
+  void on_node_created(ossia::net::node_base&)
+  {
+    // Only invalidates the pattern cache: the node has no parameter yet.
+    ++m_generation;
+  }
+
+  void on_node_removing(ossia::net::node_base& n)
+  {
+    {
+      lock_t lock{m_mutex};
+      m_master.erase(n.osc_address());
+      ++m_generation;
+    }
+    wait_unused(n.get_parameter());
+  }
+
+  void on_node_renamed(ossia::net::node_base&, std::string)
+  {
+    // All the addresses of the sub-tree change
+    rebuild();
+  }
+
+  void on_parameter_created(const ossia::net::parameter_base& p)
+  {
+    lock_t lock{m_mutex};
+    auto& e = m_master[p.get_node().osc_address()];
+    e.parameter = const_cast<ossia::net::parameter_base*>(&p);
+    ++m_generation;
+  }
+
+  void on_parameter_removing(const ossia::net::parameter_base& p)
+  {
+    {
+      lock_t lock{m_mutex};
+      m_master.erase(p.get_node().osc_address());
+      ++m_generation;
+    }
+    wait_unused(&p);
+  }
+
+  static const constexpr std::size_t min_republish_threshold = 64;
+
+  ossia::net::device_base* m_device{};
+
+  // Writer side
+  mutex_t m_mutex;
+  map_type m_master;
+  std::vector<const snapshot*> m_retired;
+
+  // Reader side
+  std::atomic<const snapshot*> m_current{};
+  std::atomic<uint64_t> m_generation{};
+  std::atomic<std::size_t> m_staleLookups{};
+  std::atomic<std::size_t> m_republishThreshold{};
+  hazard_slot m_slots[max_readers];
+
+  // Pattern cache, owned by the receiving thread
+  mutex_t m_patternMutex;
+  pattern_map m_patterns;
+  uint64_t m_patternGeneration{};
+};
+}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <ossia/detail/logger.hpp>
+#include <ossia/network/osc/detail/udp_batch.hpp>
 
 #include <oscpack/ip/UdpSocket.h>
 #include <oscpack/osc/OscDebug.h>
@@ -145,13 +146,19 @@ private:
  *
  * A OSC server.
  * Note : if a port cannot be opened, it will be incremented.
+ *
+ * If batched is true and the platform supports it, the socket is drained
+ * with recvmmsg, see \ref udp_batch_receiver.
  */
 class receiver
 {
 public:
   template <typename Handler>
-  receiver(unsigned int port, Handler msg)
+  receiver(unsigned int port, Handler msg, bool batched = false)
       : m_impl{std::make_unique<listener<Handler>>(msg)}
+#if defined(OSSIA_UDP_BATCH)
+      , m_batched{batched}
+#endif
   {
     setPort(port);
   }
@@ -162,6 +169,10 @@ public:
     other.stop();
     m_impl = std::move(other.m_impl);
     m_socket = std::move(other.m_socket);
+#if defined(OSSIA_UDP_BATCH)
+    m_batched = other.m_batched;
+    other.m_batch.reset();
+#endif
     setPort(other.m_port);
   }
 
@@ -171,6 +182,10 @@ public:
 
     m_impl = std::move(other.m_impl);
     m_socket = std::move(other.m_socket);
+#if defined(OSSIA_UDP_BATCH)
+    m_batched = other.m_batched;
+    other.m_batch.reset();
+#endif
 
     setPort(other.m_port);
 
@@ -182,11 +197,24 @@ public:
     stop();
   }
 
+  //! Can be called again after stop(): the socket is then opened again
   void run()
   {
     if (m_runThread.joinable())
       stop();
 
+    if (m_impl && !has_socket())
+      setPort(m_port);
+
+#if defined(OSSIA_UDP_BATCH)
+    if (m_batch)
+    {
+      m_batch->run();
+      m_running = true;
+      return;
+    }
+#endif
+
     m_runThread = std::thread([this] { run_impl(); });
     while(!m_running)
       std::this_thread::sleep_for(std::chrono::microseconds(1));
@@ -206,6 +234,14 @@ osc_thread_run:
   void stop()
   {
     m_running = false;
+#if defined(OSSIA_UDP_BATCH)
+    if (m_batch)
+    {
+      m_batch->stop();
+      m_batch.reset();
+      return;
+    }
+#endif
     if (m_socket)
     {
       if (m_runThread.joinable())
@@ -253,6 +289,14 @@ osc_thread_run:
     {
       try
       {
+#if defined(OSSIA_UDP_BATCH)
+        if (m_batched)
+        {
+          m_batch = std::make_unique<udp_batch_receiver>(m_port, *m_impl);
+          ok = true;
+          continue;
+        }
+#endif
         m_socket = std::make_unique<oscpack::ReceiveSocket>(
             oscpack::IpEndpointName(
                 oscpack::IpEndpointName::ANY_ADDRESS, m_port),
@@ -269,9 +313,22 @@ osc_thread_run:
   }
 
 private:
+  bool has_socket() const noexcept
+  {
+#if defined(OSSIA_UDP_BATCH)
+    if (m_batched)
+      return bool(m_batch);
+#endif
+    return bool(m_socket);
+  }
+
   unsigned int m_port = 0;
   std::unique_ptr<oscpack::OscPacketListener> m_impl;
   std::unique_ptr<oscpack::ReceiveSocket> m_socket;
+#if defined(OSSIA_UDP_BATCH)
+  std::unique_ptr<udp_batch_receiver> m_batch;
+  bool m_batched{};
+#endif
 
   std::thread m_runThread;
   std::atomic_bool m_running = false;
@@ -1,9 +1,11 @@
 #pragma once
 #include <ossia/detail/logger.hpp>
+#include <ossia/detail/mutex.hpp>
 #include <ossia/network/base/parameter.hpp>
 #include <ossia/network/base/parameter_data.hpp>
 #include <ossia/network/common/network_logger.hpp>
 #include <ossia/network/osc/detail/message_generator.hpp>
+#include <ossia/network/osc/detail/udp_batch.hpp>
 #include <ossia/network/value/format_value.hpp>
 
 #include <oscpack/ip/UdpSocket.h>
@@ -20,6 +22,8 @@ namespace osc
  *
  * Sends OSC packets to a given address on an UDP port.
  *
+ * If a \ref udp_batch_sender is set, the packets are queued in it instead
+ * and sent on the same socket when it is flushed.
  */
 template <typename ValueWriter>
 class sender
@@ -29,7 +33,8 @@ public:
       const ossia::net::network_logger& l, const std::string& ip,
       const int port)
       : m_logger{l}
-      , m_socket{oscpack::IpEndpointName(ip.c_str(), port)}
+      , m_endpoint{ip.c_str(), port}
+      , m_socket{m_endpoint}
       , m_ip(ip)
       , m_port(port)
   {
@@ -77,7 +82,48 @@ public:
     return m_socket;
   }
 
+#if defined(OSSIA_UDP_BATCH)
+  //! The batch is not owned by the sender. nullptr to send directly.
+  //! Once this returns, no packet is being queued in the previous batch.
+  void set_batch(udp_batch_sender* b) noexcept
+  {
+    ossia::lock_t lock{m_batchMutex};
+    m_batch = b;
+  }
+#endif
+
+  //! Sends an already encoded packet
+  void send_raw(const char* data, std::size_t sz)
+  {
+#if defined(OSSIA_UDP_BATCH)
+    {
+      ossia::lock_t lock{m_batchMutex};
+      if (m_batch)
+      {
+        m_batch->queue(m_socket.native_handle(), m_endpoint, data, sz);
+        return;
+      }
+    }
+#endif
+    m_socket.Send(data, sz);
+  }
+
 private:
+  //! Gives access to the descriptor of the oscpack socket
+  class transmit_socket : public oscpack::UdpTransmitSocket
+  {
+  public:
+    explicit transmit_socket(const oscpack::IpEndpointName& remote)
+        : oscpack::UdpTransmitSocket{remote}
+    {
+    }
+
+    int native_handle() noexcept
+    {
+      return this->impl_.Socket();
+    }
+  };
+
   void debug(const oscpack::OutboundPacketStream& out)
   {
     std::string s(out.Data(), out.Data() + out.Size());
@@ -116,7 +162,7 @@ private:
   {
     try
     {
-      m_socket.Send(m.Data(), m.Size());
+      send_raw(m.Data(), m.Size());
     }
     catch (...)
     {
@@ -124,7 +170,12 @@ private:
   }
 
   const ossia::net::network_logger& m_logger;
-  oscpack::UdpTransmitSocket m_socket;
+  oscpack::IpEndpointName m_endpoint;
+  transmit_socket m_socket;
+#if defined(OSSIA_UDP_BATCH)
+  ossia::mutex_t m_batchMutex;
+  udp_batch_sender* m_batch{};
+#endif
   std::string m_ip;
   int m_port;
 };
@@ -0,0 +1,313 @@
+#pragma once
+#include <ossia/detail/logger.hpp>
+#include <ossia/detail/mutex.hpp>
+#include <ossia/network/osc/detail/udp_batch_fwd.hpp>
+
+#include <oscpack/ip/IpEndpointName.h>
+#include <oscpack/ip/PacketListener.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(OSSIA_UDP_BATCH)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file udp_batch.hpp
+ *
+ * Batched UDP I/O, which sends and receives many datagrams per system call
+ * with sendmmsg / recvmmsg.
+ *
+ * Only available on Linux: OSSIA_UDP_BATCH is defined if it is.
+ */
+
+#if defined(OSSIA_UDP_BATCH)
+namespace osc
+{
+/**
+ * @brief Queues outbound datagrams and sends them all at once.
+ *
+ * Datagrams can target different remote endpoints, which allows
+ * a protocol with many remotes to flush a whole tick in a single syscall.
+ * They are sent on the socket given when queueing them, so that the remotes
+ * see the same source port as for the datagrams sent directly.
+ * The buffers are kept across flushes.
+ */
+class udp_batch_sender
+{
+public:
+  //! Maximum number of datagrams sent per sendmmsg call
+  static const constexpr std::size_t max_batch = 256;
+
+  //! Number of times a datagram is retried when the socket buffer is full
+  static const constexpr int max_retries = 8;
+
+  udp_batch_sender()
+  {
+    m_data.reserve(65536);
+    m_datagrams.reserve(max_batch);
+    m_headers.resize(max_batch);
+    m_iovecs.resize(max_batch);
+  }
+
+  udp_batch_sender(const udp_batch_sender&) = delete;
+  udp_batch_sender& operator=(const udp_batch_sender&) = delete;
+
+  //! Copies a datagram in the queue. The socket must outlive the next flush.
+  //! Thread-safe.
+  void queue(
+      int socket, const oscpack::IpEndpointName& remote, const char* data,
+      std::size_t size)
+  {
+    ossia::lock_t lock{m_mutex};
+    datagram d;
+    d.socket = socket;
+    d.address.sin_family = AF_INET;
+    d.address.sin_addr.s_addr = htonl(remote.address);
+    d.address.sin_port = htons(remote.port);
+    d.offset = m_data.size();
+    d.size = size;
+
+    m_data.insert(m_data.end(), data, data + size);
+    m_datagrams.push_back(d);
+  }
+
+  /**
+   * @brief Sends all the queued datagrams. Thread-safe.
+   *
+   * sendmmsg stops at the first datagram which fails: the following ones
+   * are sent again from there. A datagram which cannot be sent is dropped
+   * alone.
+   */
+  void flush()
+  {
+    ossia::lock_t lock{m_mutex};
+    std::size_t sent = 0;
+    int retries = 0;
+    const std::size_t total = m_datagrams.size();
+    while (sent < total)
+    {
+      // Consecutive datagrams on the same socket go in the same call
+      const int socket = m_datagrams[sent].socket;
+      std::size_t n = 0;
+      while (n < max_batch && sent + n < total
+             && m_datagrams[sent + n].socket == socket)
+      {
+        datagram& d = m_datagrams[sent + n];
+        m_iovecs[n].iov_base = m_data.data() + d.offset;
+        m_iovecs[n].iov_len = d.size;
+
+        auto& hdr = m_headers[n].msg_hdr;
+        std::memset(&m_headers[n], 0, sizeof(mmsghdr));
+        hdr.msg_name = &d.address;
+        hdr.msg_namelen = sizeof(sockaddr_in);
+        hdr.msg_iov = &m_iovecs[n];
+        hdr.msg_iovlen = 1;
+        n++;
+      }
+
+      int res = ::sendmmsg(socket, m_headers.data(), n, 0);
+      if (res > 0)
+      {
+        sent += std::size_t(res);
+        retries = 0;
+        continue;
+      }
+
+      // The datagram at index "sent" failed
+      const int err = errno;
+      if (err == EINTR)
+        continue;
+      if ((err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS)
+          && retries++ < max_retries)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      ossia::logger().error(
+          "udp_batch_sender::flush: dropping a datagram: {}",
+          std::strerror(err));
+      sent++;
+      retries = 0;
+    }
+
+    m_data.clear();
+    m_datagrams.clear();
+  }
+
+  std::size_t queued() const noexcept
+  {
+    ossia::lock_t lock{m_mutex};
+    return m_datagrams.size();
+  }
+
+private:
+  struct datagram
+  {
+    sockaddr_in address{};
+    std::size_t offset{};
+    std::size_t size{};
+    int socket{-1};
+  };
+
+  mutable ossia::mutex_t m_mutex;
+  std::vector<char> m_data;
+  std::vector<datagram> m_datagrams;
+  std::vector<mmsghdr> m_headers;
+  std::vector<iovec> m_iovecs;
+};
+
+/**
+ * @brief A UDP server which drains its socket with recvmmsg.
+ *
+ * Each received datagram is passed to an oscpack PacketListener,
+ * like oscpack's own receive sockets do.
+ */
+class udp_batch_receiver
+{
+public:
+  static const constexpr std::size_t max_batch = 32;
+  static const constexpr std::size_t max_datagram_size = 65536;
+
+  udp_batch_receiver(unsigned int port, oscpack::PacketListener& listener)
+      : m_listener{listener}
+  {
+    m_socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0)
+      throw std::runtime_error("udp_batch_receiver: could not create socket");
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))
+        < 0)
+    {
+      ::close(m_socket);
+      throw std::runtime_error("udp_batch_receiver: could not bind socket");
+    }
+
+    // Bursts of small datagrams fill the default buffer quickly
+    int rcvbuf = 4 * 1024 * 1024;
+    ::setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &len);
+    m_port = ntohs(addr.sin_port);
+
+    m_buffers.resize(max_batch * max_datagram_size);
+    m_headers.resize(max_batch);
+    m_iovecs.resize(max_batch);
+    m_addresses.resize(max_batch);
+  }
+
+  udp_batch_receiver(const udp_batch_receiver&) = delete;
+  udp_batch_receiver& operator=(const udp_batch_receiver&) = delete;
+
+  ~udp_batch_receiver()
+  {
+    stop();
+    ::close(m_socket);
+  }
+
+  unsigned int port() const noexcept
+  {
+    return m_port;
+  }
+
+  //! Starts the receiving thread. A stopped receiver cannot be restarted.
+  void run()
+  {
+    if (m_thread.joinable())
+      return;
+    m_running = true;
+    m_thread = std::thread{[this] { run_impl(); }};
+  }
+
+  void stop()
+  {
+    if (!m_thread.joinable())
+      return;
+
+    m_running = false;
+    // Unblocks recvmmsg
+    ::shutdown(m_socket, SHUT_RDWR);
+    m_thread.join();
+  }
+
+private:
+  void run_impl()
+  {
+    while (m_running)
+    {
+      for (std::size_t i = 0; i < max_batch; i++)
+      {
+        m_iovecs[i].iov_base = m_buffers.data() + i * max_datagram_size;
+        m_iovecs[i].iov_len = max_datagram_size;
+
+        auto& hdr = m_headers[i].msg_hdr;
+        std::memset(&m_headers[i], 0, sizeof(mmsghdr));
+        hdr.msg_name = &m_addresses[i];
+        hdr.msg_namelen = sizeof(sockaddr_in);
+        hdr.msg_iov = &m_iovecs[i];
+        hdr.msg_iovlen = 1;
+      }
+
+      int n = ::recvmmsg(
+          m_socket, m_headers.data(), max_batch, MSG_WAITFORONE, nullptr);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        break;
+      }
+      if (n == 0 && !m_running)
+        break;
+
+      for (int i = 0; i < n; i++)
+      {
+        const auto& from = m_addresses[i];
+        const auto sz = m_headers[i].msg_len;
+        if (sz == 0)
+          continue;
+
+        try
+        {
+          m_listener.ProcessPacket(
+              static_cast<const char*>(m_iovecs[i].iov_base), int(sz),
+              oscpack::IpEndpointName(
+                  ntohl(from.sin_addr.s_addr), ntohs(from.sin_port)));
+        }
+        catch (...)
+        {
+        }
+      }
+    }
+  }
+
+  oscpack::PacketListener& m_listener;
+  int m_socket{-1};
+  unsigned int m_port{};
+
+  std::vector<char> m_buffers;
+  std::vector<mmsghdr> m_headers;
+  std::vector<iovec> m_iovecs;
+  std::vector<sockaddr_in> m_addresses;
+
+  std::thread m_thread;
+  std::atomic_bool m_running{};
+};
+}
+#endif
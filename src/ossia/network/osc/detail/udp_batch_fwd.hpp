@@ -0,0 +1,20 @@
+#pragma once
+
+/**
+ * \file udp_batch_fwd.hpp
+ *
+ * Defines OSSIA_UDP_BATCH on the platforms which support batched UDP I/O,
+ * see udp_batch.hpp.
+ */
+
+#if defined(__linux__)
+#define OSSIA_UDP_BATCH 1
+#endif
+
+#if defined(OSSIA_UDP_BATCH)
+namespace osc
+{
+class udp_batch_sender;
+class udp_batch_receiver;
+}
+#endif
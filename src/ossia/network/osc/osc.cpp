@@ -6,6 +6,7 @@
 #include <ossia/network/exceptions.hpp>
 #include <ossia/network/generic/generic_device.hpp>
 #include <ossia/network/generic/generic_parameter.hpp>
+#include <ossia/network/osc/detail/bundle.hpp>
 #include <ossia/network/osc/detail/osc.hpp>
 #include <ossia/network/osc/detail/osc_receive.hpp>
 #include <ossia/network/osc/detail/receiver.hpp>
@@ -26,7 +27,9 @@ using sender_t = osc::sender<osc_outbound_visitor>;
 osc_protocol::osc_protocol(
     std::string ip, uint16_t remote_port, uint16_t local_port,
     std::optional<std::string> expose)
-    : m_ip{std::move(ip)}
+    : m_index{std::make_unique<osc_address_index>()}
+    , m_bundle{std::make_unique<osc_bundle_encoder>()}
+    , m_ip{std::move(ip)}
     , m_remote_port{remote_port}
     , m_local_port{local_port}
     , m_expose{std::move(expose)}
@@ -84,16 +87,33 @@ osc_protocol& osc_protocol::set_local_port(uint16_t out_port)
 
 void osc_protocol::update_sender()
 {
+#if defined(OSSIA_UDP_BATCH)
+  lock_t lock{m_batchMutex};
+  // The queued datagrams refer to the socket of the previous sender
+  if (m_sender && m_batch)
+  {
+    m_sender->set_batch(nullptr);
+    m_batch->flush();
+  }
+#endif
   m_sender = std::make_unique<sender_t>(m_logger, m_ip, m_remote_port);
+#if defined(OSSIA_UDP_BATCH)
+  if (m_executing)
+    m_sender->set_batch(m_batch.get());
+#endif
 }
 
 void osc_protocol::update_receiver()
 {
+  // Closes the previous socket before binding the port again
+  m_receiver.reset();
   m_receiver = std::make_unique<osc::receiver>(
-      m_local_port, [this](const oscpack::ReceivedMessage& m,
-                        const oscpack::IpEndpointName& ip) {
+      m_local_port,
+      [this](
+          const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName& ip) {
         this->on_received_message(m, ip);
-      });
+      },
+      m_batched);
 
   if (m_receiver->port() != m_local_port)
   {
@@ -136,6 +156,90 @@ osc_protocol& osc_protocol::set_learning(bool newLearn)
   return *this;
 }
 
+osc_bundle_options osc_protocol::bundle_options() const
+{
+  lock_t lock{m_bundleMutex};
+  return m_bundleOptions;
+}
+
+osc_protocol& osc_protocol::set_bundle_options(osc_bundle_options opt)
+{
+  lock_t lock{m_bundleMutex};
+  m_bundleOptions = std::move(opt);
+  m_bundle->set_max_packet_size(m_bundleOptions.max_packet_size);
+  return *this;
+}
+
+bool osc_protocol::set_batched_io(bool b)
+{
+#if defined(OSSIA_UDP_BATCH)
+  {
+    lock_t lock{m_batchMutex};
+    if (b == m_batched)
+      return true;
+
+    // Once detached, no other thread can queue in the batch anymore
+    if (m_batch)
+    {
+      m_sender->set_batch(nullptr);
+      m_batch->flush();
+    }
+
+    m_batched = b;
+    if (b)
+      m_batch = std::make_unique<osc::udp_batch_sender>();
+    else
+      m_batch.reset();
+
+    if (m_executing)
+      m_sender->set_batch(m_batch.get());
+  }
+
+  update_receiver();
+  return true;
+#else
+  return !b;
+#endif
+}
+
+bool osc_protocol::batched_io() const noexcept
+{
+  return m_batched;
+}
+
+void osc_protocol::start_execution()
+{
+#if defined(OSSIA_UDP_BATCH)
+  lock_t lock{m_batchMutex};
+  m_executing = true;
+  m_sender->set_batch(m_batch.get());
+#else
+  m_executing = true;
+#endif
+}
+
+void osc_protocol::stop_execution()
+{
+#if defined(OSSIA_UDP_BATCH)
+  lock_t lock{m_batchMutex};
+  m_executing = false;
+  m_sender->set_batch(nullptr);
+  if (m_batch)
+    m_batch->flush();
+#else
+  m_executing = false;
+#endif
+}
+
+void osc_protocol::flush()
+{
+#if defined(OSSIA_UDP_BATCH)
+  lock_t lock{m_batchMutex};
+  if (m_batch)
+    m_batch->flush();
+#endif
+}
+
 bool osc_protocol::update(ossia::net::node_base& node)
 {
   return false;
@@ -174,73 +278,78 @@ bool osc_protocol::push_raw(const ossia::net::full_parameter_data& addr)
   return false;
 }
 
-bool osc_protocol::push_bundle(
-    const std::vector<const parameter_base*>& addresses)
+static const parameter_base& bundle_element(const parameter_base* p)
+{
+  return *p;
+}
+
+static const full_parameter_data&
+bundle_element(const full_parameter_data& p)
 {
-  constexpr int N = 1024 * 1024;
+  return p;
+}
+
+template <typename T, typename GetAddress>
+bool osc_protocol::push_bundle_impl(const T& addresses, GetAddress get_address)
+{
+  lock_t lock{m_bundleMutex};
+
+  auto& sender = *m_sender;
+  auto send = [&](const char* data, std::size_t sz) {
+    sender.send_raw(data, sz);
+  };
+
+  m_bundle->begin(
+      m_bundleOptions.timetag ? osc_timetag(m_bundleOptions.timetag())
+                              : osc_immediate_timetag);
 
   try
   {
-    auto buffer{std::make_unique<char[]>(N)};
-    oscpack::OutboundPacketStream str(buffer.get(), N);
-    str << oscpack::BeginBundleImmediate();
-    for (auto a : addresses)
+    for (const auto& a : addresses)
     {
-      const ossia::net::parameter_base& addr = *a;
+      const auto& addr = bundle_element(a);
       if (addr.get_access() == ossia::access_mode::GET)
         continue;
 
       ossia::value val = filter_value(addr, addr.value());
       if (val.valid())
       {
-        str << oscpack::BeginMessageN(addr.get_node().osc_address());
-        val.apply(osc_outbound_visitor{{str}});
-        str << oscpack::EndMessage();
+        m_bundle->add(
+            [&](oscpack::OutboundPacketStream& str) {
+              str << oscpack::BeginMessageN(get_address(addr));
+              val.apply(osc_outbound_visitor{{str}});
+              str << oscpack::EndMessage();
+            },
+            send);
       }
     }
-    str << oscpack::EndBundle();
-    m_sender->socket().Send(str.Data(), str.Size());
+    m_bundle->end(send);
   }
-  catch (const oscpack::OutOfBufferMemoryException&)
+  catch (const std::exception& e)
   {
+    logger().error("osc_protocol::push_bundle: {}", e.what());
     return false;
   }
 
   return true;
 }
 
+bool osc_protocol::push_bundle(
+    const std::vector<const parameter_base*>& addresses)
+{
+  return push_bundle_impl(
+      addresses, [](const parameter_base& addr) -> const std::string& {
+        return addr.get_node().osc_address();
+      });
+}
+
 bool osc_protocol::push_raw_bundle(
     const std::vector<ossia::net::full_parameter_data>& addresses)
 {
-  constexpr int N = 1024 * 1024;
-
-  try
-  {
-    auto buffer{std::make_unique<char[]>(N)};
-    oscpack::OutboundPacketStream str(buffer.get(), N);
-    str << oscpack::BeginBundleImmediate();
-    for (const auto& addr : addresses)
-    {
-      if (addr.get_access() == ossia::access_mode::GET)
-        continue;
-
-      ossia::value val = filter_value(addr, addr.value());
-      if (val.valid())
-      {
-        str << oscpack::BeginMessageN(addr.address);
-        val.apply(osc_outbound_visitor{{str}});
-        str << oscpack::EndMessage();
-      }
-    }
-    str << oscpack::EndBundle();
-    m_sender->socket().Send(str.Data(), str.Size());
-  }
-  catch (const oscpack::OutOfBufferMemoryException&)
-  {
-    return false;
-  }
-
-  return true;
+  return push_bundle_impl(
+      addresses, [](const full_parameter_data& addr) -> const std::string& {
+        return addr.address;
+      });
 }
 
 bool osc_protocol::observe(ossia::net::parameter_base& address, bool enable)
@@ -250,6 +359,7 @@ bool osc_protocol::observe(ossia::net::parameter_base& address, bool enable)
         std::make_pair(address.get_node().osc_address(), &address));
   else
     m_listening.erase(address.get_node().osc_address());
+  m_index->set_listening(address, enable);
 
   return true;
 }
@@ -259,7 +369,7 @@ void osc_protocol::on_received_message(
 {
   if (!m_learning)
   {
-    handle_osc_message<false>(m, m_listening, *m_device, m_logger);
+    handle_osc_message<false>(m, *m_index, *m_device, m_logger);
   }
   else
   {
@@ -382,6 +492,7 @@ void osc_protocol::on_learn(const oscpack::ReceivedMessage& m)
 void osc_protocol::set_device(device_base& dev)
 {
   m_device = &dev;
+  m_index->attach(dev);
 }
 }
 }
@@ -2,11 +2,14 @@
 #include <ossia/detail/mutex.hpp>
 #include <ossia/network/base/listening.hpp>
 #include <ossia/network/base/protocol.hpp>
+#include <ossia/network/osc/detail/udp_batch_fwd.hpp>
 #include <ossia/network/zeroconf/zeroconf.hpp>
 
 #include <tsl/hopscotch_map.h>
 
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <string>
 
 namespace oscpack
@@ -25,6 +28,24 @@ namespace ossia
 namespace net
 {
 struct osc_outbound_visitor;
+class osc_address_index;
+class osc_bundle_encoder;
+
+/**
+ * @brief How osc_protocol::push_bundle encodes and sends bundles.
+ */
+struct osc_bundle_options
+{
+  //! Bundles bigger than this are split in several datagrams.
+  //! 0 means no limit. 1472 fits in a single ethernet frame over UDP.
+  std::size_t max_packet_size{};
+
+  //! If set, bundles are time-tagged with the returned time,
+  //! e.g. the time of the current tick of the execution clock.
+  //! Else they are sent as "immediate".
+  std::function<std::chrono::system_clock::time_point()> timetag;
+};
+
 class OSSIA_EXPORT osc_protocol final : public ossia::net::protocol_base
 {
 public:
@@ -51,6 +72,21 @@ public:
   bool learning() const;
   osc_protocol& set_learning(bool);
 
+  osc_bundle_options bundle_options() const;
+  osc_protocol& set_bundle_options(osc_bundle_options);
+
+  /**
+   * @brief Use batched UDP I/O, on platforms which support it (Linux).
+   *
+   * Inbound datagrams are then read many at once with recvmmsg, and
+   * during execution the outbound messages are queued and sent with a single
+   * sendmmsg call at the end of each tick, in \ref flush.
+   *
+   * @return false if the platform does not support it.
+   */
+  bool set_batched_io(bool);
+  bool batched_io() const noexcept;
+
   bool update(ossia::net::node_base& node_base) override;
 
   bool pull(ossia::net::parameter_base& parameter_base) override;
@@ -65,6 +101,10 @@ public:
   bool
   observe(ossia::net::parameter_base& parameter_base, bool enable) override;
 
+  void start_execution() override;
+  void stop_execution() override;
+  void flush() override;
+
 private:
   void on_received_message(
       const oscpack::ReceivedMessage& m, const oscpack::IpEndpointName& ip);
@@ -75,10 +115,22 @@ private:
   void update_receiver();
   void update_zeroconf();
 
+  template <typename T, typename GetAddress>
+  bool push_bundle_impl(const T& addresses, GetAddress get_address);
+
   listened_parameters m_listening;
+  std::unique_ptr<osc_address_index> m_index;
 
   std::unique_ptr<osc::sender<osc_outbound_visitor>> m_sender;
   std::unique_ptr<osc::receiver> m_receiver;
+#if defined(OSSIA_UDP_BATCH)
+  mutable mutex_t m_batchMutex;
+  std::unique_ptr<osc::udp_batch_sender> m_batch;
+#endif
+
+  mutable mutex_t m_bundleMutex;
+  std::unique_ptr<osc_bundle_encoder> m_bundle;
+  osc_bundle_options m_bundleOptions;
 
   net::zeroconf_server m_zeroconfServer;
 
@@ -90,6 +142,9 @@ private:
                            /// messages to (opened in this library)
   std::atomic_bool m_learning{}; /// if the device is currently learning from
                                  /// inbound messages.
+  // Written under m_batchMutex
+  std::atomic_bool m_batched{};
+  std::atomic_bool m_executing{};
   std::optional<std::string> m_expose{};
 };
 }
@@ -187,6 +187,10 @@ constexpr auto rename_node()
 {
   constexpr_return(ossia::make_string_view("RENAME_NODE"));
 }
+constexpr auto depth()
+{
+  constexpr_return(ossia::make_string_view("DEPTH"));
+}
 constexpr auto node_name()
 {
   constexpr_return(ossia::make_string_view("NAME"));
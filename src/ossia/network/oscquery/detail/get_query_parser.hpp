@@ -7,6 +7,8 @@
 #include <ossia/network/oscquery/detail/outbound_visitor.hpp>
 #include <ossia/network/oscquery/oscquery_client.hpp>
 #include <ossia/network/oscquery/oscquery_server.hpp>
+
+#include <charconv>
 namespace ossia
 {
 namespace net
@@ -73,13 +75,13 @@ public:
         auto& root = proto.get_device().get_root_node();
         if (path == "/")
         {
-          return oscquery::json_writer::query_namespace(root);
+          return proto.query_namespace(root);
         }
         else
         {
           auto node = ossia::net::find_node(root, path);
           if (node)
-            return oscquery::json_writer::query_namespace(*node);
+            return proto.query_namespace(*node);
           else
             throw node_not_found_error{std::string(path)};
         }
@@ -135,6 +137,20 @@ public:
             return {};
           }
 
+          // DEPTH: namespace limited to a number of levels of children
+          auto depth_it = parameters.find(detail::depth());
+          if (depth_it != parameters.end())
+          {
+            const auto& str = depth_it.value();
+            int depth = -1;
+            auto res
+                = std::from_chars(str.data(), str.data() + str.size(), depth);
+            if (res.ec != std::errc{} || depth < 0)
+              throw bad_request_error{"Wrong arguments to depth query: "
+                                      + str};
+            return proto.query_namespace(*node, depth);
+          }
+
           // All the value-less parameters
           ossia::small_vector<std::string, 5> attributes;
           for (const auto& elt : parameters)
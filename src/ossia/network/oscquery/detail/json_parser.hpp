@@ -24,6 +24,10 @@ struct OSSIA_EXPORT json_parser
   static host_info parse_host_info(const rapidjson::Value& obj);
   static void
   parse_namespace(ossia::net::node_base& root, const rapidjson::Value& obj);
+  //! Creates the children of a node which are in a namespace reply and
+  //! missing from the node, leaving the node and its other children as is
+  static void
+  parse_contents(ossia::net::node_base& node, const rapidjson::Value& obj);
   static void
   parse_value(ossia::net::parameter_base& addr, const rapidjson::Value& obj);
   static void parse_parameter_value(
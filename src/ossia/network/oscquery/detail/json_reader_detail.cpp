@@ -1096,6 +1096,30 @@ void json_parser::parse_parameter_value(
   }
 }
 
+void json_parser::parse_contents(
+    net::node_base& node, const rapidjson::Value& obj)
+{
+  auto contents_it = obj.FindMember(detail::contents());
+  if (contents_it == obj.MemberEnd() || !contents_it->value.IsObject())
+    return;
+
+  auto& contents = contents_it->value;
+  for (auto child_it = contents.MemberBegin();
+       child_it != contents.MemberEnd(); ++child_it)
+  {
+    auto name = get_string(child_it->name);
+    if (auto cld = node.find_child(name))
+    {
+      ossia::net::set_zombie(*cld, false);
+    }
+    else
+    {
+      auto c = node.create_child(std::move(name));
+      detail::json_parser_impl::readObject(*c, child_it->value);
+    }
+  }
+}
+
 // Given a string "/foo/bar/baz", return {"/foo/bar", "baz"}
 static std::optional<std::pair<std::string, std::string>>
 splitParentChild(ossia::string_view s)
@@ -278,6 +278,15 @@ struct node_attribute_writer
 
   void operator()(const type_tag<ossia::net::value_attribute>&)
   {
+    if (writer.valueSpan)
+    {
+      writer.valueSpan->begin = writer.buffer->GetSize();
+      writer.writeKey(metadata<ossia::net::value_attribute>::key());
+      writer.writer.Null();
+      writer.valueSpan->end = writer.buffer->GetSize();
+      return;
+    }
+
     if (auto res = p.value(); res.valid())
     {
       writer.writeKey(metadata<ossia::net::value_attribute>::key());
@@ -551,6 +560,9 @@ json_writer::query_host_info(const oscquery_server_protocol& proto)
   wr.Key("ECHO");
   wr.Bool(true);
 
+  wr.Key("DEPTH");
+  wr.Bool(true);
+
   wr.Key(detail::path_changed());
   wr.Bool(false);
   wr.Key(detail::path_renamed());
@@ -8,12 +8,25 @@ namespace oscquery
 {
 namespace detail
 {
+//! Position of the VALUE attribute in a serialized node, comma included
+struct json_value_span
+{
+  std::size_t begin{};
+  std::size_t end{};
+};
+
 //! Implementation of the JSON serialisation mechanism for oscquery
 struct json_writer_impl
 {
   using writer_t = rapidjson::Writer<rapidjson::StringBuffer>;
   writer_t& writer;
 
+  //! If set, writeNodeAttributes writes null instead of the current value,
+  //! and stores its position in the buffer here, so that the output can be
+  //! kept and the value written again later.
+  const rapidjson::StringBuffer* buffer{};
+  json_value_span* valueSpan{};
+
   void writeKey(ossia::string_view k) const;
 
   void writeValue(const ossia::value& val, const ossia::unit_t& unit) const;
@@ -0,0 +1,182 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include "namespace_cache.hpp"
+
+#include <ossia/network/base/node.hpp>
+#include <ossia/network/base/parameter.hpp>
+#include <ossia/network/oscquery/detail/attributes.hpp>
+#include <ossia/network/oscquery/detail/json_writer_detail.hpp>
+
+namespace ossia
+{
+namespace oscquery
+{
+namespace_cache::namespace_cache() = default;
+namespace_cache::~namespace_cache() = default;
+
+void namespace_cache::write(
+    const net::node_base& node, std::string& out, int depth)
+{
+  rapidjson::StringBuffer scratch;
+  write_node(node, out, depth, scratch);
+}
+
+std::string
+namespace_cache::query_namespace(const net::node_base& node, int depth)
+{
+  std::string out;
+  write(node, out, depth);
+  return out;
+}
+
+void namespace_cache::invalidate(const net::node_base& node)
+{
+  lock_t lock(m_mutex);
+  m_generation++;
+  m_entries.erase(&node);
+}
+
+void namespace_cache::invalidate_subtree(const net::node_base& node)
+{
+  lock_t lock(m_mutex);
+  m_generation++;
+  invalidate_subtree_impl(node);
+}
+
+void namespace_cache::invalidate_subtree_impl(const net::node_base& node)
+{
+  m_entries.erase(&node);
+  for (const auto& child : node.children())
+    invalidate_subtree_impl(*child);
+}
+
+void namespace_cache::clear()
+{
+  lock_t lock(m_mutex);
+  m_generation++;
+  m_entries.clear();
+}
+
+std::size_t namespace_cache::size() const
+{
+  lock_t lock(m_mutex);
+  return m_entries.size();
+}
+
+namespace_cache::entry_ptr namespace_cache::get(
+    const net::node_base& node, bool has_parameter,
+    rapidjson::StringBuffer& scratch)
+{
+  uint64_t generation{};
+  {
+    lock_t lock(m_mutex);
+    auto it = m_entries.find(&node);
+    // An entry whose node gained or lost its parameter without being
+    // invalidated is stale: it is rebuilt and replaced.
+    if (it != m_entries.end() && it->second->has_value() == has_parameter)
+      return it->second;
+    generation = m_generation;
+  }
+
+  auto e = std::make_shared<entry>();
+  detail::json_value_span span{std::string::npos, 0};
+
+  scratch.Clear();
+  detail::json_writer_impl::writer_t wr(scratch);
+  detail::json_writer_impl p{wr, &scratch, &span};
+  wr.StartObject();
+  p.writeNodeAttributes(node);
+
+  e->json.assign(scratch.GetString(), scratch.GetSize());
+  e->value_begin = span.begin;
+  e->value_end = span.end;
+
+  // If the node was invalidated meanwhile, or if its parameter changed again,
+  // e may be stale: it is only used for this walk
+  if (e->has_value() != has_parameter)
+    return e;
+
+  lock_t lock(m_mutex);
+  if (generation != m_generation)
+    return e;
+  m_entries.insert_or_assign(&node, e);
+  return e;
+}
+
+void namespace_cache::write_node(
+    const net::node_base& node, std::string& out, int depth,
+    rapidjson::StringBuffer& scratch)
+{
+  {
+    auto param = node.get_parameter();
+    const entry_ptr ptr = get(node, param != nullptr, scratch);
+    const entry& e = *ptr;
+    if (e.has_value())
+    {
+      out.append(e.json, 0, e.value_begin);
+      if (param)
+        write_value(*param, out, scratch);
+      out.append(e.json, e.value_end, std::string::npos);
+    }
+    else
+    {
+      out += e.json;
+    }
+  }
+
+  const auto& cld = node.children();
+  if (!cld.empty())
+  {
+    // FULL_PATH is always written first, hence the comma
+    out += ',';
+    write_string(detail::contents(), out, scratch);
+    out += ":{";
+    bool first = true;
+    // An empty CONTENTS tells that the children were left out
+    if (depth != 0)
+    {
+      for (const auto& child : cld)
+      {
+        if (!first)
+          out += ',';
+        first = false;
+
+        write_string(child->get_name(), out, scratch);
+        out += ':';
+        write_node(*child, out, depth - 1, scratch);
+      }
+    }
+    out += '}';
+  }
+
+  out += '}';
+}
+
+void namespace_cache::write_value(
+    const net::parameter_base& param, std::string& out,
+    rapidjson::StringBuffer& scratch)
+{
+  auto val = param.value();
+  if (!val.valid())
+    return;
+
+  out += ',';
+  write_string(detail::attribute_value(), out, scratch);
+  out += ':';
+
+  scratch.Clear();
+  detail::json_writer_impl::writer_t wr(scratch);
+  detail::json_writer_impl{wr}.writeValue(val, param.get_unit());
+  out.append(scratch.GetString(), scratch.GetSize());
+}
+
+void namespace_cache::write_string(
+    ossia::string_view str, std::string& out, rapidjson::StringBuffer& scratch)
+{
+  scratch.Clear();
+  detail::json_writer_impl::writer_t wr(scratch);
+  wr.String(str.data(), str.size());
+  out.append(scratch.GetString(), scratch.GetSize());
+}
+}
+}
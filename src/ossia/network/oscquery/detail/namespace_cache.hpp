@@ -0,0 +1,110 @@
+#pragma once
+#include <ossia/detail/config.hpp>
+#include <ossia/detail/json.hpp>
+#include <ossia/detail/mutex.hpp>
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace ossia
+{
+namespace net
+{
+class node_base;
+class parameter_base;
+}
+namespace oscquery
+{
+/**
+ * @brief Cached JSON serialization of the namespace of a device.
+ *
+ * The reply to a namespace query is written by a depth-first walk of the
+ * tree, directly in the string which will be sent. For each node, the JSON
+ * of its attributes is kept from one query to the next: only the value of
+ * the parameter and the list of children are read again, so that the
+ * clients which reconnect to a large device do not serialize it anew.
+ *
+ * The cached JSON of a node must be invalidated when its attributes change,
+ * and the one of a subtree when it is renamed or removed; the server does
+ * this from the signals of the device.
+ *
+ * The mutex is only held to look up or store the entry of a node, not during
+ * the walk: queries run concurrently, and do not block the invalidations.
+ * An entry built while its node was invalidated is not stored.
+ *
+ * The output is the same as json_writer::query_namespace. With a
+ * non-negative depth, only this number of levels of children is written;
+ * the nodes of the last level which have children get an empty CONTENTS.
+ */
+class OSSIA_EXPORT namespace_cache
+{
+public:
+  namespace_cache();
+  ~namespace_cache();
+
+  namespace_cache(const namespace_cache&) = delete;
+  namespace_cache& operator=(const namespace_cache&) = delete;
+
+  //! Writes the namespace of a node at the end of out
+  void write(
+      const ossia::net::node_base& node, std::string& out, int depth = -1);
+
+  //! Returns the namespace of a node
+  std::string
+  query_namespace(const ossia::net::node_base& node, int depth = -1);
+
+  //! The attributes of a node changed
+  void invalidate(const ossia::net::node_base& node);
+
+  //! A node and its children were renamed or are being removed
+  void invalidate_subtree(const ossia::net::node_base& node);
+
+  void clear();
+
+  //! Number of nodes whose JSON is cached
+  std::size_t size() const;
+
+private:
+  struct entry
+  {
+    // The node object with its attributes, without the closing brace
+    std::string json;
+
+    // Position of the VALUE attribute in json, if the node has a parameter
+    std::size_t value_begin{std::string::npos};
+    std::size_t value_end{};
+
+    bool has_value() const noexcept
+    {
+      return value_begin != std::string::npos;
+    }
+  };
+
+  // The entries are shared with the walks which use them, so that they can
+  // be invalidated meanwhile
+  using entry_ptr = std::shared_ptr<const entry>;
+
+  entry_ptr get(
+      const ossia::net::node_base& node, bool has_parameter,
+      rapidjson::StringBuffer& scratch);
+  void write_node(
+      const ossia::net::node_base& node, std::string& out, int depth,
+      rapidjson::StringBuffer& scratch);
+  static void write_value(
+      const ossia::net::parameter_base& param, std::string& out,
+      rapidjson::StringBuffer& scratch);
+  static void write_string(
+      ossia::string_view str, std::string& out,
+      rapidjson::StringBuffer& scratch);
+  void invalidate_subtree_impl(const ossia::net::node_base& node);
+
+  std::unordered_map<const ossia::net::node_base*, entry_ptr> m_entries;
+
+  // Incremented by each invalidation
+  uint64_t m_generation{};
+  mutable ossia::mutex_t m_mutex;
+};
+}
+}
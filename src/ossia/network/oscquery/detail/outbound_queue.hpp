@@ -0,0 +1,143 @@
+#pragma once
+#include <ossia/detail/string_map.hpp>
+#include <ossia/network/osc/detail/bundle.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ossia
+{
+namespace oscquery
+{
+//! Counters of an outbound_queue
+struct outbound_queue_stats
+{
+  //! Messages currently in the queue
+  std::size_t size{};
+  //! Messages which replaced a queued message to the same path
+  uint64_t coalesced{};
+  //! Bytes given to the send function by flush()
+  uint64_t sent_bytes{};
+};
+
+/**
+ * @brief OSC messages waiting to be sent to a websocket client.
+ *
+ * The messages are appended while the client reads fast enough. When it
+ * does not (see set_coalescing), or once the queue holds max_size()
+ * messages, a message replaces the queued message to the same path: the
+ * client then gets the latest values once it catches up instead of a
+ * backlog, and the queue only grows with the number of paths.
+ *
+ * Critical messages are always appended, and never replaced nor dropped.
+ *
+ * The messages are sent as a single bundle by flush().
+ * The queue is not thread-safe.
+ */
+class outbound_queue
+{
+public:
+  explicit outbound_queue(std::size_t max_size = 4096) : m_maxSize{max_size}
+  {
+  }
+
+  //! Adds an encoded message
+  void push(
+      const std::string& path, std::string_view message, bool critical = false)
+  {
+    if (!critical && (m_coalescing || m_messages.size() >= m_maxSize))
+    {
+      auto it = m_index.find(path);
+      if (it != m_index.end())
+      {
+        m_messages[it.value()].data.assign(message.data(), message.size());
+        m_stats.coalesced++;
+        return;
+      }
+    }
+
+    // m_index has the last message to each path which can be replaced: a
+    // later message must not be sent before a critical one.
+    if (critical)
+      m_index.erase(path);
+    else
+      m_index.insert_or_assign(path, m_messages.size());
+
+    m_messages.push_back({path, std::string(message)});
+  }
+
+  //! To enable while the client does not read fast enough
+  void set_coalescing(bool b) noexcept
+  {
+    m_coalescing = b;
+  }
+
+  bool coalescing() const noexcept
+  {
+    return m_coalescing;
+  }
+
+  bool empty() const noexcept
+  {
+    return m_messages.empty();
+  }
+
+  std::size_t size() const noexcept
+  {
+    return m_messages.size();
+  }
+
+  std::size_t max_size() const noexcept
+  {
+    return m_maxSize;
+  }
+
+  outbound_queue_stats stats() const noexcept
+  {
+    auto s = m_stats;
+    s.size = m_messages.size();
+    return s;
+  }
+
+  void clear() noexcept
+  {
+    m_messages.clear();
+    m_index.clear();
+  }
+
+  //! Sends the queued messages as one bundle and clears the queue.
+  //! send is a callable with signature `void(const char*, std::size_t)`.
+  template <typename Send>
+  void flush(Send&& send)
+  {
+    auto counted_send = [&](const char* data, std::size_t sz) {
+      m_stats.sent_bytes += sz;
+      send(data, sz);
+    };
+
+    m_bundle.begin();
+    for (const auto& m : m_messages)
+      m_bundle.add_encoded(m.data.data(), m.data.size(), counted_send);
+    m_bundle.end(counted_send);
+
+    clear();
+  }
+
+private:
+  struct message
+  {
+    std::string path;
+    std::string data;
+  };
+
+  std::vector<message> m_messages;
+  ossia::string_map<std::size_t> m_index;
+  ossia::net::osc_bundle_encoder m_bundle;
+  std::size_t m_maxSize{};
+  bool m_coalescing{};
+  outbound_queue_stats m_stats;
+};
+}
+}
@@ -225,6 +225,34 @@ public:
         message.data(), message.size(), websocketpp::frame::opcode::binary);
   }
 
+  void send_binary_message(
+      connection_handler hdl, const char* data, std::size_t size)
+  {
+    auto con = m_server.get_con_from_hdl(hdl);
+    con->send(data, size, websocketpp::frame::opcode::binary);
+  }
+
+  //! Bytes accepted by send but not written to the socket yet
+  std::size_t buffered_amount(connection_handler hdl)
+  {
+    auto con = m_server.get_con_from_hdl(hdl);
+    return con->get_buffered_amount();
+  }
+
+  //! Calls the handler from the server thread
+  template <typename Handler>
+  void post(Handler h)
+  {
+    asio::post(m_server.get_io_service(), std::move(h));
+  }
+
+  //! Calls the handler from the server thread after some milliseconds
+  template <typename Handler>
+  void set_timer(long ms, Handler h)
+  {
+    m_server.set_timer(ms, std::move(h));
+  }
+
   server_t& impl()
   {
     return m_server;
@@ -21,5 +21,9 @@ struct server_reply
     binary
   } type;
   std::string data;
+
+  server_reply(std::string&& str, data_type t) : type{t}, data{std::move(str)}
+  {
+  }
 };
 }
@@ -3,9 +3,12 @@
 #include <ossia/detail/string_map.hpp>
 #include <ossia/network/common/network_logger.hpp>
 #include <ossia/network/osc/detail/sender.hpp>
+#include <ossia/network/oscquery/detail/outbound_queue.hpp>
 #include <ossia/network/oscquery/detail/outbound_visitor.hpp>
 #include <ossia/network/oscquery/detail/server.hpp>
 
+#include <atomic>
+
 namespace osc
 {
 template <typename T>
@@ -22,18 +25,34 @@ namespace oscquery
 struct oscquery_client
 {
   websocket_server::connection_handler connection;
-  mutex_t listeningMutex;
+  mutable mutex_t listeningMutex;
   string_map<ossia::net::parameter_base*> listening;
+  // Set by the first LISTEN of the client
+  std::atomic_bool listenSeen{};
 
   std::string client_ip;
   std::unique_ptr<osc::sender<oscquery::osc_outbound_visitor>> sender;
   int remote_sender_port{};
 
+  // Websocket messages waiting for the client to read the previous ones.
+  // The JSON notifications of the changes of the tree are sent before the
+  // values.
+  mutex_t outboundMutex;
+  outbound_queue outbound;
+  std::vector<std::string> notifications;
+  bool outboundScheduled{};
+
+  // Node of the metrics of the client, if enabled, and bytes sent at the
+  // previous update. Used by the server thread.
+  std::string metricsPath;
+  uint64_t metricsSentBytes{};
+
 public:
   oscquery_client() = default;
   oscquery_client(oscquery_client&& other)
       : connection{std::move(other.connection)}
       , listening{std::move(other.listening)}
+      , listenSeen{other.listenSeen.load()}
       , client_ip{std::move(other.client_ip)}
       , sender{std::move(other.sender)}
   {
@@ -44,6 +63,7 @@ public:
   {
     connection = std::move(other.connection);
     listening = std::move(other.listening);
+    listenSeen = other.listenSeen.load();
     client_ip = std::move(other.client_ip);
     sender = std::move(other.sender);
     return *this;
@@ -56,6 +76,7 @@ public:
 
   void start_listen(std::string path, ossia::net::parameter_base* addr)
   {
+    listenSeen = true;
     if (addr)
     {
       listeningMutex.lock();
@@ -71,6 +92,30 @@ public:
     listeningMutex.unlock();
   }
 
+  bool is_listening(const std::string& path) const
+  {
+    lock_t lock(listeningMutex);
+    return listening.find(path) != listening.end();
+  }
+
+  //! A client which never sent LISTEN gets every value
+  bool wants(const std::string& path) const
+  {
+    return !listenSeen || is_listening(path);
+  }
+
+  void rename_listening(const std::string& oldpath, const std::string& newpath)
+  {
+    lock_t lock(listeningMutex);
+    auto it = listening.find(oldpath);
+    if (it != listening.end())
+    {
+      auto v = it->second;
+      listening.erase(it);
+      listening.insert({newpath, v});
+    }
+  }
+
   bool operator==(const websocket_server::connection_handler& h) const
   {
     return !connection.expired() && connection.lock() == h.lock();
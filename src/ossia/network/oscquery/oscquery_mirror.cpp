@@ -47,6 +47,14 @@ struct http_error
 
 using http_request = http_get_request<http_answer, http_error>;
 
+static std::string parent_path(ossia::string_view path)
+{
+  auto pos = path.find_last_of('/');
+  if (pos == 0 || pos == ossia::string_view::npos)
+    return "/";
+  return std::string(path.substr(0, pos));
+}
+
 struct http_client_context
 {
   std::thread thread;
@@ -77,7 +85,8 @@ auto wait_for(std::future<void>& fut, std::chrono::milliseconds dur)
 
 oscquery_mirror_protocol::oscquery_mirror_protocol(
     std::string host, uint16_t local_osc_port)
-    : m_queryHost{std::move(host)}
+    : m_index{std::make_unique<net::osc_address_index>()}
+    , m_queryHost{std::move(host)}
     , m_httpHost{m_queryHost}
     , m_osc_port{local_osc_port}
     , m_http{std::make_unique<http_client_context>()}
@@ -366,6 +375,7 @@ bool oscquery_mirror_protocol::observe(
 
     m_listening.erase(str);
   }
+  m_index->set_listening(address, enable);
   return true;
 }
 
@@ -377,12 +387,21 @@ bool oscquery_mirror_protocol::observe_quietly(
         std::make_pair(address.get_node().osc_address(), &address));
   else
     m_listening.erase(address.get_node().osc_address());
+  m_index->set_listening(address, enable);
 
   return true;
 }
 
 bool oscquery_mirror_protocol::update(net::node_base& b)
 {
+  if (m_lazy)
+  {
+    // Only the node and its children are mirrored again
+    b.clear_children();
+    forget_subtree(b);
+    return expand(b);
+  }
+
   auto fut = update_async(b);
   auto status = fut.wait_for(std::chrono::seconds(3));
   return status == std::future_status::ready;
@@ -390,12 +409,298 @@ bool oscquery_mirror_protocol::update(net::node_base& b)
 
 std::future<void> oscquery_mirror_protocol::update_async(net::node_base& b)
 {
+  if (m_lazy)
+  {
+    // The tree must not be changed from the network thread in lazy mode:
+    // the reply is applied by run_commands
+    std::promise<void> done;
+    auto fut = done.get_future();
+    request_children(b.osc_address(), &done);
+    return fut;
+  }
+
   m_namespacePromise = std::promise<void>{};
   auto fut = m_namespacePromise.get_future();
   http_send_message(b.osc_address());
   return fut;
 }
 
+void oscquery_mirror_protocol::set_lazy(bool lazy, std::size_t max_expanded)
+{
+  m_lazy = lazy;
+  m_maxExpanded = std::max(max_expanded, std::size_t(1));
+  m_expanded.clear();
+  m_expandedOrder.clear();
+
+  lock_t lock(m_namespaceRequestsMutex);
+  m_namespaceRequests.clear();
+}
+
+net::node_base* oscquery_mirror_protocol::find_node(ossia::string_view path)
+{
+  auto& root = m_device->get_root_node();
+  if (!m_lazy)
+    return ossia::net::find_node(root, path);
+
+  net::node_base* node = &root;
+  std::size_t pos = 0;
+  while (node)
+  {
+    while (pos < path.size() && path[pos] == '/')
+      pos++;
+    if (pos == path.size())
+      break;
+
+    auto end = std::min(path.find('/', pos), path.size());
+    if (!expand(*node))
+      return nullptr;
+
+    node = node->find_child(path.substr(pos, end - pos));
+    pos = end;
+  }
+  return node;
+}
+
+bool oscquery_mirror_protocol::expand(net::node_base& node)
+{
+  if (!m_lazy)
+    return true;
+
+  if (m_expanded.find(&node) != m_expanded.end())
+  {
+    touch(node);
+    return true;
+  }
+
+  const auto path = node.osc_address();
+  auto reply = request_children(path);
+  if (reply.wait_for(std::chrono::seconds(3)) != std::future_status::ready)
+    return false;
+
+  // The next expansion of this node, after an eviction, asks again
+  drop_namespace_reply(path);
+
+  if (const auto& doc = reply.get())
+    json_parser::parse_contents(node, *doc);
+
+  touch(node);
+  evict(node);
+  return true;
+}
+
+void oscquery_mirror_protocol::prefetch(ossia::string_view path)
+{
+  if (!m_lazy)
+    return;
+
+  auto node = ossia::net::find_node(m_device->get_root_node(), path);
+  if (node && m_expanded.find(node) != m_expanded.end())
+    return;
+
+  {
+    // This is only a hint: it is dropped if too many replies are pending
+    lock_t lock(m_namespaceRequestsMutex);
+    if (m_namespaceRequests.size() >= m_maxExpanded)
+      return;
+  }
+  request_children(std::string(path));
+}
+
+std::shared_future<oscquery_mirror_protocol::namespace_reply>
+oscquery_mirror_protocol::request_children(
+    const std::string& path, std::promise<void>* update)
+{
+  std::shared_future<namespace_reply> reply;
+  bool inserted{};
+  bool received{};
+  {
+    lock_t lock(m_namespaceRequestsMutex);
+    auto res = m_namespaceRequests.try_emplace(path);
+    inserted = res.second;
+
+    auto& req = res.first.value();
+    if (inserted)
+      req.reply = req.promise.get_future().share();
+    if (update)
+      req.updates.push_back(std::move(*update));
+    reply = req.reply;
+    received = req.received;
+  }
+
+  if (inserted)
+  {
+    std::string query = path;
+    const auto& ext = m_host_info.extensions;
+    if (auto it = ext.find("DEPTH"); it != ext.end() && it->second)
+    {
+      query += '?';
+      query += detail::depth();
+      query += "=1";
+    }
+    http_send_message(query);
+  }
+  else if (update && received)
+  {
+    // We are on the thread which edits the device
+    apply_update(path);
+  }
+
+  return reply;
+}
+
+bool oscquery_mirror_protocol::on_namespace_reply(const namespace_reply& data)
+{
+  auto path_it = data->FindMember(detail::attribute_full_path());
+  if (path_it == data->MemberEnd() || !path_it->value.IsString())
+    return false;
+
+  std::string path{path_it->value.GetString(),
+                   path_it->value.GetStringLength()};
+
+  {
+    lock_t lock(m_namespaceRequestsMutex);
+    auto it = m_namespaceRequests.find(path);
+    if (it == m_namespaceRequests.end() || it->second.received)
+      return false;
+
+    it.value().received = true;
+    it.value().promise.set_value(data);
+    if (it->second.updates.empty())
+      return true;
+  }
+
+  m_functionQueue.enqueue(
+      [this, p = std::move(path)] { apply_update(p); });
+  if (m_commandCallback)
+    m_commandCallback();
+  return true;
+}
+
+void oscquery_mirror_protocol::apply_update(const std::string& path)
+{
+  std::vector<std::promise<void>> updates;
+  namespace_reply doc;
+  {
+    lock_t lock(m_namespaceRequestsMutex);
+    auto it = m_namespaceRequests.find(path);
+    if (it == m_namespaceRequests.end() || !it->second.received)
+      return;
+
+    updates = std::move(it.value().updates);
+    doc = it->second.reply.get();
+    m_namespaceRequests.erase(it);
+  }
+
+  // Like update(): only the node and its children are mirrored again
+  if (auto node = ossia::net::find_node(m_device->get_root_node(), path))
+  {
+    node->clear_children();
+    forget_subtree(*node);
+    if (doc)
+      json_parser::parse_contents(*node, *doc);
+    touch(*node);
+    evict(*node);
+  }
+
+  for (auto& p : updates)
+    p.set_value();
+}
+
+void oscquery_mirror_protocol::drop_namespace_reply(const std::string& path)
+{
+  // The requests still in flight are kept, since a thread may wait for them,
+  // and so are the replies which update_async has yet to apply
+  lock_t lock(m_namespaceRequestsMutex);
+  auto it = m_namespaceRequests.find(path);
+  if (it != m_namespaceRequests.end() && it->second.received
+      && it->second.updates.empty())
+    m_namespaceRequests.erase(it);
+}
+
+void oscquery_mirror_protocol::touch(net::node_base& node)
+{
+  auto it = m_expanded.find(&node);
+  if (it != m_expanded.end())
+  {
+    m_expandedOrder.splice(
+        m_expandedOrder.begin(), m_expandedOrder, it->second);
+  }
+  else
+  {
+    m_expandedOrder.push_front(&node);
+    m_expanded.insert({&node, m_expandedOrder.begin()});
+  }
+
+  // The ancestors of a node are kept more recent than it, so that a node
+  // is never evicted before its expanded descendants.
+  for (auto p = node.get_parent(); p; p = p->get_parent())
+  {
+    auto pit = m_expanded.find(p);
+    if (pit != m_expanded.end())
+      m_expandedOrder.splice(
+          m_expandedOrder.begin(), m_expandedOrder, pit->second);
+  }
+}
+
+void oscquery_mirror_protocol::evict(const net::node_base& keep)
+{
+  // Each node is tried once, the ones which are in use are skipped
+  std::size_t tries = m_expandedOrder.size();
+  while (m_expanded.size() > m_maxExpanded && tries-- > 0)
+  {
+    auto node = m_expandedOrder.back();
+
+    // The path to the node being accessed is kept, and so is the root
+    bool used = node->get_parent() == nullptr;
+    for (auto p = &keep; p && !used; p = p->get_parent())
+      used = p == node;
+    for (auto& cld : node->children())
+    {
+      ossia::net::visit_parameters(
+          *cld, [&](ossia::net::node_base&, ossia::net::parameter_base& p) {
+            if (p.callback_count() > 0)
+              used = true;
+          });
+    }
+
+    if (used)
+    {
+      touch(*node);
+      continue;
+    }
+
+    m_expandedOrder.pop_back();
+    m_expanded.erase(node);
+    node->clear_children();
+  }
+}
+
+void oscquery_mirror_protocol::forget_subtree(const net::node_base& node)
+{
+  auto it = m_expanded.find(&node);
+  if (it != m_expanded.end())
+  {
+    m_expandedOrder.erase(it->second);
+    m_expanded.erase(it);
+  }
+
+  for (auto& cld : node.children())
+    forget_subtree(*cld);
+}
+
+void oscquery_mirror_protocol::on_nodeRemoving(const net::node_base& n)
+{
+  if (!m_lazy)
+    return;
+
+  auto it = m_expanded.find(&n);
+  if (it != m_expanded.end())
+  {
+    m_expandedOrder.erase(it->second);
+    m_expanded.erase(it);
+  }
+}
+
 void oscquery_mirror_protocol::on_nodeRenamed(
     const net::node_base& n, std::string oldname) try
 {
@@ -426,6 +731,8 @@ void oscquery_mirror_protocol::set_device(net::device_base& dev)
     auto& old = *m_device;
     old.on_node_renamed.disconnect<&oscquery_mirror_protocol::on_nodeRenamed>(
         this);
+    old.on_node_removing
+        .disconnect<&oscquery_mirror_protocol::on_nodeRemoving>(this);
 
     ossia::net::visit_parameters(
         old.get_root_node(),
@@ -436,11 +743,14 @@ void oscquery_mirror_protocol::set_device(net::device_base& dev)
   }
 
   m_device = &dev;
+  m_index->attach(dev);
 
   init();
 
   m_device->on_node_renamed.connect<&oscquery_mirror_protocol::on_nodeRenamed>(
       this);
+  m_device->on_node_removing
+      .connect<&oscquery_mirror_protocol::on_nodeRemoving>(this);
   ossia::net::visit_parameters(
       dev.get_root_node(),
       [&](ossia::net::node_base& n, ossia::net::parameter_base& p) {
@@ -630,7 +940,7 @@ void oscquery_mirror_protocol::on_OSCMessage(
 #if defined(OSSIA_BENCHMARK)
   auto t1 = std::chrono::high_resolution_clock::now();
 #endif
-  ossia::net::handle_osc_message<true>(m, m_listening, *m_device, m_logger);
+  ossia::net::handle_osc_message<true>(m, *m_index, *m_device, m_logger);
 
 #if defined(OSSIA_BENCHMARK)
   auto t2 = std::chrono::high_resolution_clock::now();
@@ -711,6 +1021,13 @@ bool oscquery_mirror_protocol::on_WSMessage(
         }
         case message_type::Namespace:
         {
+          // In lazy mode, the replies are read by the thread which expands
+          if (m_lazy)
+          {
+            on_namespace_reply(data);
+            break;
+          }
+
           json_parser::parse_namespace(m_device->get_root_node(), *data);
           m_namespacePromise.set_value();
           break;
@@ -800,8 +1117,18 @@ bool oscquery_mirror_protocol::on_WSMessage(
               std::string full_path{dat.GetString(), dat.GetStringLength()};
 
               m_functionQueue.enqueue([this, f = std::move(full_path), doc = std::move(data)] {
-                json_parser::parse_path_added(
-                    m_device->get_root_node(), f, *doc);
+                auto& root = m_device->get_root_node();
+                if (m_lazy)
+                {
+                  // A node which is not expanded gets its new children
+                  // when it is
+                  auto parent = parent_path(f);
+                  drop_namespace_reply(parent);
+                  auto node = ossia::net::find_node(root, parent);
+                  if (!node || m_expanded.find(node) == m_expanded.end())
+                    return;
+                }
+                json_parser::parse_path_added(root, f, *doc);
               });
             }
           }
@@ -833,7 +1160,21 @@ bool oscquery_mirror_protocol::on_WSMessage(
         case message_type::PathRemoved:
         {
           m_functionQueue.enqueue([this, doc = std::move(data)] {
-            json_parser::parse_path_removed(m_device->get_root_node(), *doc, m_zombie_on_remove);
+            auto& root = m_device->get_root_node();
+            if (m_lazy)
+            {
+              auto dat_it = doc->FindMember(detail::data());
+              if (dat_it != doc->MemberEnd() && dat_it->value.IsString())
+              {
+                std::string path{dat_it->value.GetString(),
+                                 dat_it->value.GetStringLength()};
+                drop_namespace_reply(parent_path(path));
+                drop_namespace_reply(path);
+                if (auto node = ossia::net::find_node(root, path))
+                  forget_subtree(*node);
+              }
+            }
+            json_parser::parse_path_removed(root, *doc, m_zombie_on_remove);
           });
           if (m_commandCallback)
             m_commandCallback();
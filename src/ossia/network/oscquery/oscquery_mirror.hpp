@@ -1,11 +1,13 @@
 #pragma once
 
+#include <ossia/detail/hash_map.hpp>
 #include <ossia/detail/json_fwd.hpp>
 #include <ossia/network/base/listening.hpp>
 #include <ossia/network/base/protocol.hpp>
 #include <ossia/network/oscquery/host_info.hpp>
 #include <ossia/detail/lockfree_queue.hpp>
 #include <atomic>
+#include <list>
 
 namespace osc
 {
@@ -25,6 +27,7 @@ namespace ossia
 namespace net
 {
 struct parameter_data;
+class osc_address_index;
 }
 namespace oscquery
 {
@@ -54,6 +57,11 @@ public:
   bool observe_quietly(net::parameter_base&, bool) override;
   bool update(net::node_base& b) override;
 
+  /**
+   * In lazy mode, the future is ready once the children of the node were
+   * mirrored again, which happens in run_commands() like the other changes
+   * received from the network.
+   */
   std::future<void> update_async(net::node_base& b) override;
 
   void stop() override;
@@ -119,6 +127,51 @@ public:
    */
   bool get_zombie_on_remove() const noexcept { return m_zombie_on_remove; }
 
+  /**
+   * @brief Mirror the namespace of the server on demand.
+   *
+   * In this mode, update() only mirrors a node and its children. The other
+   * levels of the tree are requested from the server when they are accessed
+   * through find_node() and expand().
+   *
+   * The children of at most max_expanded nodes are kept: past this, the
+   * children of the least recently accessed node are removed, unless some
+   * parameters below it have callbacks.
+   *
+   * PATH_ADDED and PATH_REMOVED are only applied to the parts of the tree
+   * which are mirrored; the others get the changes when they are requested.
+   *
+   * A server which does not support the DEPTH extension sends the whole
+   * subtree of each requested node.
+   */
+  void set_lazy(bool lazy, std::size_t max_expanded = 1024);
+
+  bool get_lazy() const noexcept { return m_lazy; }
+
+  /**
+   * @brief Find a node in lazy mode
+   *
+   * The nodes on the path whose children are not mirrored yet are expanded.
+   * @return nullptr if the node does not exist or the server did not answer
+   */
+  net::node_base* find_node(ossia::string_view path);
+
+  /**
+   * @brief Request the children of a node in lazy mode, if they are not
+   * mirrored yet. Call this before accessing the children of the node.
+   * @return false if the server did not answer
+   */
+  bool expand(net::node_base& node);
+
+  /**
+   * @brief Request the children of a node in the background, so that
+   * expanding it later does not wait for the server.
+   */
+  void prefetch(ossia::string_view path);
+
+  //! Number of nodes whose children are mirrored in lazy mode
+  std::size_t expanded_count() const noexcept { return m_expanded.size(); }
+
   void set_disconnect_callback(std::function<void()>);
   void set_fail_callback(std::function<void()>);
 
@@ -147,6 +200,23 @@ private:
   void query_stop();
 
   void on_nodeRenamed(const ossia::net::node_base& n, std::string oldname);
+  void on_nodeRemoving(const ossia::net::node_base& n);
+
+  // Lazy mode
+  using namespace_reply = std::shared_ptr<rapidjson::Document>;
+  //! If update is set, the reply is applied to the node once received, and
+  //! the promise is then fulfilled
+  std::shared_future<namespace_reply> request_children(
+      const std::string& path, std::promise<void>* update = nullptr);
+  bool on_namespace_reply(const namespace_reply& data);
+  void apply_update(const std::string& path);
+  void drop_namespace_reply(const std::string& path);
+  void touch(net::node_base& node);
+  void evict(const net::node_base& keep);
+  void forget_subtree(const net::node_base& node);
+
+  // Address lookup for inbound OSC messages
+  std::unique_ptr<net::osc_address_index> m_index;
 
   std::unique_ptr<osc::sender<oscquery::osc_outbound_visitor>> m_oscSender;
   std::unique_ptr<osc::receiver> m_oscServer;
@@ -197,6 +267,27 @@ private:
   void start_http();
 
   bool m_zombie_on_remove{true};
+
+  // Lazy mode: the namespace replies which were requested, by path
+  struct namespace_request
+  {
+    std::promise<namespace_reply> promise;
+    std::shared_future<namespace_reply> reply;
+    // The update_async calls waiting for this reply
+    std::vector<std::promise<void>> updates;
+    bool received{};
+  };
+  ossia::string_map<namespace_request> m_namespaceRequests;
+  ossia::mutex_t m_namespaceRequestsMutex;
+
+  // Lazy mode: the nodes whose children are mirrored, most recent first.
+  // Only accessed from the thread which edits the device.
+  std::list<net::node_base*> m_expandedOrder;
+  ossia::fast_hash_map<
+      const net::node_base*, std::list<net::node_base*>::iterator>
+      m_expanded;
+  std::size_t m_maxExpanded{1024};
+  std::atomic_bool m_lazy{};
 };
 
 //! Use this function to load a device preset in the OSCQuery format.
@@ -9,6 +9,7 @@
 #include <ossia/network/generic/generic_device.hpp>
 #include <ossia/network/generic/generic_node.hpp>
 #include <ossia/network/generic/generic_parameter.hpp>
+#include <ossia/network/osc/detail/bundle.hpp>
 #include <ossia/network/osc/detail/osc.hpp>
 #include <ossia/network/osc/detail/osc_receive.hpp>
 #include <ossia/network/osc/detail/receiver.hpp>
@@ -16,26 +17,48 @@
 #include <ossia/network/oscquery/detail/get_query_parser.hpp>
 #include <ossia/network/oscquery/detail/json_query_parser.hpp>
 #include <ossia/network/oscquery/detail/json_writer.hpp>
+#include <ossia/network/oscquery/detail/namespace_cache.hpp>
 #include <ossia/network/oscquery/detail/outbound_visitor.hpp>
 #include <ossia/network/oscquery/detail/query_parser.hpp>
 #include <ossia/network/oscquery/detail/server.hpp>
+#include <ossia/network/oscquery/oscquery_client.hpp>
 #include <ossia/detail/algorithms.hpp>
 namespace ossia
 {
 namespace oscquery
 {
+// Bundles sent over UDP are split to fit in an ethernet frame
+static const constexpr std::size_t udp_max_packet_size = 1472;
+
+// A websocket client which has more bytes than this waiting to be written
+// is considered too slow: its messages are kept and coalesced until it
+// catches up.
+static const constexpr std::size_t ws_max_buffered_amount = 64 * 1024;
+
+// Delay before trying again to send to a slow client, in milliseconds
+static const constexpr long ws_retry_delay = 10;
+
+// Period of the updates of the client metrics, in milliseconds
+static const constexpr long metrics_period = 1000;
+
 oscquery_server_protocol::oscquery_server_protocol(
     uint16_t osc_port, uint16_t ws_port)
-    : m_oscServer{std::make_unique<osc::receiver>(
+    : m_index{std::make_unique<net::osc_address_index>()}
+    , m_oscServer{std::make_unique<osc::receiver>(
           osc_port,
           [this](const oscpack::ReceivedMessage& m,
               const oscpack::IpEndpointName& ip) {
             this->on_OSCMessage(m, ip);
           })}
     , m_websocketServer{std::make_unique<websocket_server>()}
+    , m_namespaceCache{std::make_unique<namespace_cache>()}
+    , m_clients{std::make_shared<const client_list>()}
     , m_oscPort{(uint16_t)m_oscServer->port()}
     , m_wsPort{ws_port}
+    , m_udpBundle{std::make_unique<net::osc_bundle_encoder>()}
 {
+  m_udpBundle->set_max_packet_size(udp_max_packet_size);
+
   m_websocketServer->set_open_handler(
       [&](connection_handler hdl) { on_connectionOpen(hdl); });
   m_websocketServer->set_close_handler(
@@ -104,39 +127,57 @@ void oscquery_server_protocol::request(net::parameter_base&)
   // Do nothing
 }
 
+static const std::string& parameter_path(const net::parameter_base& addr)
+{
+  return addr.get_node().osc_address();
+}
+
+static const std::string& parameter_path(const net::full_parameter_data& addr)
+{
+  return addr.address;
+}
+
 template <typename T>
 bool oscquery_server_protocol::push_impl(const T& addr, const ossia::value& v)
 {
   auto val = net::filter_value(addr, v);
   if (val.valid())
   {
-    // Push to all clients
-    auto critical = addr.get_critical();
-    if (!critical)
+    const auto clients = this->clients();
+    if (clients->empty())
+      return true;
+
+    const auto& path = parameter_path(addr);
+    const bool critical = addr.get_critical();
+    const bool filter = m_listenFilter;
+
+    // The message is the same for every client: it is encoded once, when the
+    // first client which listens to it is found.
+    std::string message;
+    for (auto& client : *clients)
     {
-      lock_t lock(m_clientsMutex);
-      for (auto& client : m_clients)
+      if (filter && !client->wants(path))
+        continue;
+
+      if (message.empty())
+        message = osc_writer::send_message(addr, val, m_logger);
+
+      try
       {
-        if (client.sender)
+        if (client->sender && !critical)
         {
-          ossia::oscquery::osc_writer::send_message(
-              addr, val, m_logger, client.sender->socket());
+          client->sender->socket().Send(message.data(), message.size());
         }
         else
         {
-          m_websocketServer->send_binary_message(
-              client.connection,
-              osc_writer::send_message(addr, val, m_logger));
+          lock_t lock(client->outboundMutex);
+          client->outbound.push(path, message, critical);
+          schedule_outbound(client);
         }
       }
-    }
-    else
-    {
-      lock_t lock(m_clientsMutex);
-      for (auto& client : m_clients)
+      catch (...)
       {
-        m_websocketServer->send_binary_message(
-            client.connection, osc_writer::send_message(addr, val, m_logger));
+        // The client disconnected meanwhile
       }
     }
 
@@ -155,61 +196,264 @@ bool oscquery_server_protocol::push_raw(const net::full_parameter_data& addr)
   return push_impl(addr, addr.value());
 }
 
-bool oscquery_server_protocol::push_bundle(
-    const std::vector<const ossia::net::parameter_base*>& addresses)
+static const net::parameter_base& bundle_element(const net::parameter_base* p)
+{
+  return *p;
+}
+
+static const net::full_parameter_data&
+bundle_element(const net::full_parameter_data& p)
+{
+  return p;
+}
+
+template <typename T>
+bool oscquery_server_protocol::push_bundle_impl(const T& addresses)
 {
-  // TODO
-  /*
-  json_bundle_builder b;
-  for(auto a : addresses)
+  const auto clients = this->clients();
+  if (clients->empty())
+    return true;
+
+  lock_t lock(m_bundleMutex);
+  try
   {
-    const ossia::net::parameter_base& addr = *a;
-    ossia::value val = net::filter_value(addr);
-    if (val.valid())
+    // Each message is encoded once, then each client gets a bundle with
+    // the messages it listens to.
+    m_bundleMessages.clear();
+    for (const auto& a : addresses)
     {
-      b.add_message(addr, val);
+      const auto& addr = bundle_element(a);
+      auto val = net::filter_value(addr, addr.value());
+      if (val.valid())
+      {
+        m_bundleMessages.push_back(
+            {&parameter_path(addr), osc_writer::send_message(addr, val, m_logger),
+             addr.get_critical()});
+      }
     }
-  }
 
-  const auto str = b.finish();
+    if (m_bundleMessages.empty())
+      return true;
 
-  {
-    lock_t lock(m_clientsMutex);
-    for (auto& client : m_clients)
+    for (auto& client : *clients)
     {
-      m_websocketServer->send_message(client.connection, str);
+      try
+      {
+        send_bundle(client);
+      }
+      catch (...)
+      {
+        // The client disconnected meanwhile
+      }
     }
   }
-  */
+  catch (const std::exception& e)
+  {
+    logger().error("oscquery_server_protocol::push_bundle: {}", e.what());
+    return false;
+  }
+
   return true;
 }
 
-bool oscquery_server_protocol::push_raw_bundle(
-    const std::vector<ossia::net::full_parameter_data>& addresses)
+void oscquery_server_protocol::send_bundle(
+    const std::shared_ptr<oscquery_client>& client)
 {
-  // TODO
-  /*
-  json_bundle_builder b;
-  for(const auto& addr : addresses)
+  auto& clt = *client;
+  const bool filter = m_listenFilter;
+  auto listens = [&](const bundle_message& m) {
+    return !filter || clt.wants(*m.path);
+  };
+
+  // One bundle over UDP, split to fit the datagrams
+  if (clt.sender)
   {
-    ossia::value val = net::filter_value(addr);
-    if (val.valid())
+    auto& socket = clt.sender->socket();
+    auto send = [&](const char* data, std::size_t sz) {
+      socket.Send(data, sz);
+    };
+
+    m_udpBundle->begin();
+    for (const auto& m : m_bundleMessages)
     {
-      b.add_message(addr, val);
+      if (!m.critical && listens(m))
+        m_udpBundle->add_encoded(m.data.data(), m.data.size(), send);
     }
+    m_udpBundle->end(send);
   }
 
-  const auto str = b.finish();
+  // One websocket frame for the rest
+  lock_t lock(clt.outboundMutex);
+  for (const auto& m : m_bundleMessages)
+  {
+    if ((m.critical || !clt.sender) && listens(m))
+      clt.outbound.push(*m.path, m.data, m.critical);
+  }
+  schedule_outbound(client);
+}
+
+void oscquery_server_protocol::schedule_outbound(
+    const std::shared_ptr<oscquery_client>& client)
+{
+  // client->outboundMutex is locked by the caller
+  if (client->outboundScheduled)
+    return;
+
+  client->outboundScheduled = true;
+  m_websocketServer->post(
+      [this, weak = std::weak_ptr<oscquery_client>{client}] {
+        drain_outbound(weak);
+      });
+}
 
+void oscquery_server_protocol::drain_outbound(
+    const std::weak_ptr<oscquery_client>& weak)
+{
+  auto clt = weak.lock();
+  if (!clt)
+    return;
+
+  try
   {
-    lock_t lock(m_clientsMutex);
-    for (auto& client : m_clients)
+    lock_t lock(clt->outboundMutex);
+    clt->outboundScheduled = false;
+    send_outbound(clt);
+  }
+  catch (...)
+  {
+    // The client disconnected meanwhile
+  }
+}
+
+void oscquery_server_protocol::send_outbound(
+    const std::shared_ptr<oscquery_client>& client)
+{
+  // Server thread; client->outboundMutex is locked by the caller
+  auto& clt = *client;
+  if (clt.outbound.empty() && clt.notifications.empty())
+    return;
+
+  if (m_websocketServer->buffered_amount(clt.connection)
+      > ws_max_buffered_amount)
+  {
+    // The messages wait in the queue, where the next values to the same
+    // paths replace them, until the client has caught up.
+    clt.outbound.set_coalescing(true);
+    clt.outboundScheduled = true;
+    m_websocketServer->set_timer(
+        ws_retry_delay,
+        [this, weak = std::weak_ptr<oscquery_client>{client}](
+            const auto& ec) {
+          if (!ec)
+            drain_outbound(weak);
+        });
+    return;
+  }
+
+  clt.outbound.set_coalescing(false);
+  for (const auto& mess : clt.notifications)
+    m_websocketServer->send_message(clt.connection, mess);
+  clt.notifications.clear();
+
+  if (!clt.outbound.empty())
+  {
+    clt.outbound.flush([&](const char* data, std::size_t sz) {
+      m_websocketServer->send_binary_message(clt.connection, data, sz);
+    });
+  }
+}
+
+void oscquery_server_protocol::send_notification(
+    const rapidjson::StringBuffer& message)
+{
+  const auto clients = this->clients();
+  if (clients->empty())
+    return;
+
+  const std::string mess{message.GetString(), message.GetSize()};
+  for (auto& client : *clients)
+  {
+    lock_t lock(client->outboundMutex);
+    client->notifications.push_back(mess);
+    schedule_outbound(client);
+  }
+}
+
+static void
+create_client_metrics(net::node_base& root, const std::string& path)
+{
+  auto& node = net::find_or_create_node(root, path);
+  auto add = [&](std::string name, ossia::val_type type) {
+    if (auto n = node.create_child(std::move(name)))
+      if (auto p = n->create_parameter(type))
+        p->set_access(ossia::access_mode::GET);
+  };
+  add("queue", ossia::val_type::INT);
+  add("coalesced", ossia::val_type::INT);
+  add("bytes_per_second", ossia::val_type::FLOAT);
+}
+
+void oscquery_server_protocol::update_client_metrics()
+{
+  // Re-arms itself until the server stops
+  m_websocketServer->set_timer(metrics_period, [this](const auto& ec) {
+    if (ec)
+      return;
+
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds
+        = std::chrono::duration<double>(now - m_metricsTime).count();
+    m_metricsTime = now;
+
+    if (m_clientMetrics && seconds > 0.)
     {
-      m_websocketServer->send_message(client.connection, str);
+      const auto clients = this->clients();
+      for (auto& client : *clients)
+      {
+        if (client->metricsPath.empty())
+          continue;
+
+        outbound_queue_stats stats;
+        {
+          lock_t lock(client->outboundMutex);
+          stats = client->outbound.stats();
+        }
+        const float rate
+            = float((stats.sent_bytes - client->metricsSentBytes) / seconds);
+        client->metricsSentBytes = stats.sent_bytes;
+
+        m_functionQueue.enqueue(
+            [this, path = client->metricsPath, stats, rate] {
+              auto node = net::find_node(m_device->get_root_node(), path);
+              if (!node)
+                return;
+
+              auto set = [&](ossia::string_view name, ossia::value v) {
+                if (auto n = node->find_child(name))
+                  if (auto p = n->get_parameter())
+                    p->push_value(std::move(v));
+              };
+              set("queue", int(stats.size));
+              set("coalesced", int(stats.coalesced));
+              set("bytes_per_second", rate);
+            });
+      }
     }
-  }
-  */
-  return true;
+
+    update_client_metrics();
+  });
+}
+
+bool oscquery_server_protocol::push_bundle(
+    const std::vector<const ossia::net::parameter_base*>& addresses)
+{
+  return push_bundle_impl(addresses);
+}
+
+bool oscquery_server_protocol::push_raw_bundle(
+    const std::vector<ossia::net::full_parameter_data>& addresses)
+{
+  return push_bundle_impl(addresses);
 }
 
 bool oscquery_server_protocol::observe(
@@ -224,6 +468,7 @@ bool oscquery_server_protocol::observe(
   {
     m_listening.erase(address.get_node().osc_address());
   }
+  m_index->set_listening(address, enable);
 
   return true;
 }
@@ -277,6 +522,8 @@ void oscquery_server_protocol::set_device(net::device_base& dev)
         });
   }
   m_device = &dev;
+  m_index->attach(dev);
+  m_namespaceCache->clear();
 
   dev.on_node_created
       .connect<&oscquery_server_protocol::on_nodeCreated>(this);
@@ -300,6 +547,9 @@ void oscquery_server_protocol::set_device(net::device_base& dev)
           observe(p, true);
       });
 
+  m_metricsTime = std::chrono::steady_clock::now();
+  update_client_metrics();
+
   m_websocketServer->listen(m_wsPort);
   m_serverThread = std::thread{[&] {
     try
@@ -332,12 +582,16 @@ void oscquery_server_protocol::stop()
   try
   {
     // close client-connections before stopping
-    auto it = m_clients.begin();
-    while (it != m_clients.end())
+    std::shared_ptr<const client_list> clients;
     {
-      auto con = m_websocketServer->impl().get_con_from_hdl(it->connection);
+      lock_t lock(m_clientsMutex);
+      clients = this->clients();
+      set_clients({});
+    }
+    for (auto& client : *clients)
+    {
+      auto con = m_websocketServer->impl().get_con_from_hdl(client->connection);
       con->close(websocketpp::close::status::going_away, "Server shutdown");
-      it = m_clients.erase(it);
     }
   }
   catch (...)
@@ -358,17 +612,40 @@ void oscquery_server_protocol::stop()
     m_serverThread.join();
 }
 
-oscquery_client*
+std::shared_ptr<oscquery_client>
 oscquery_server_protocol::find_client(const connection_handler& hdl)
 {
-  lock_t lock(m_clientsMutex);
+  const auto clients = this->clients();
 
-  auto it = ossia::find(m_clients, hdl);
-  if (it != m_clients.end())
-    return &*it;
+  auto it = ossia::find_if(
+      *clients, [&](const auto& client) { return *client == hdl; });
+  if (it != clients->end())
+    return *it;
   return nullptr;
 }
 
+server_reply oscquery_server_protocol::query_namespace(
+    const net::node_base& node, int depth)
+{
+  return server_reply{
+      m_namespaceCache->query_namespace(node, depth),
+      server_reply::data_type::json};
+}
+
+std::shared_ptr<const oscquery_server_protocol::client_list>
+oscquery_server_protocol::clients() const
+{
+  lock_t lock(m_clientsSnapshotMutex);
+  return m_clients;
+}
+
+void oscquery_server_protocol::set_clients(client_list&& clients)
+{
+  auto next = std::make_shared<const client_list>(std::move(clients));
+  lock_t lock(m_clientsSnapshotMutex);
+  m_clients = std::move(next);
+}
+
 using map_setter_fun = void (*)(
     const std::pair<const std::string, std::string>& str,
     ossia::net::parameter_data&);
@@ -454,24 +731,40 @@ void oscquery_server_protocol::rename_node(
 void oscquery_server_protocol::on_OSCMessage(
     const oscpack::ReceivedMessage& m, oscpack::IpEndpointName ip) try
 {
-  ossia::net::handle_osc_message<true>(m, m_listening, *m_device, m_logger);
+  ossia::net::handle_osc_message<true>(m, *m_index, *m_device, m_logger);
 
   if (m_echo)
   {
-    for (auto& c : m_clients)
+    const auto clients = this->clients();
+    const std::string path{m.AddressPattern()};
+    const bool filter = m_listenFilter;
+    for (auto& c : *clients)
     {
-      if (c.sender)
+      if (filter && !c->wants(path))
+        continue;
+
+      try
       {
-        // TODO this is weird: udp does not really have a port...
-        if (ip.port != c.remote_sender_port) // TODO check for ip too
+        if (c->sender)
         {
-          c.sender->socket().Send(m.data(), m.size());
+          // TODO this is weird: udp does not really have a port...
+          if (ip.port != c->remote_sender_port) // TODO check for ip too
+          {
+            c->sender->socket().Send(m.data(), m.size());
+          }
+        }
+        else
+        {
+          // Like the pushed values, so that a slow client does not block
+          // this thread
+          lock_t lock(c->outboundMutex);
+          c->outbound.push(path, std::string_view(m.data(), m.size()));
+          schedule_outbound(c);
         }
       }
-      else
+      catch (...)
       {
-        m_websocketServer->send_binary_message(
-            c.connection, std::string(m.data(), m.size()));
+        // The client disconnected meanwhile
       }
     }
   }
@@ -495,10 +788,21 @@ void oscquery_server_protocol::on_connectionOpen(
   if (ip.substr(0, 7) == "::ffff:")
     ip = ip.substr(7);
 
+  auto client = std::make_shared<oscquery_client>(hdl);
+  client->client_ip = std::move(ip);
+
+  if (m_clientMetrics)
+  {
+    client->metricsPath = "/ossia/clients/" + std::to_string(++m_clientIndex);
+    m_functionQueue.enqueue([this, path = client->metricsPath] {
+      create_client_metrics(m_device->get_root_node(), path);
+    });
+  }
   {
     lock_t lock(m_clientsMutex);
-    m_clients.emplace_back(hdl);
-    m_clients.back().client_ip = std::move(ip);
+    auto clients = *this->clients();
+    clients.push_back(std::move(client));
+    set_clients(std::move(clients));
   }
 
   onClientConnected(con->get_remote_endpoint());
@@ -515,11 +819,25 @@ catch (...)
 void oscquery_server_protocol::on_connectionClosed(
     const connection_handler& hdl)
 {
-  lock_t lock(m_clientsMutex);
-  auto it = ossia::find(m_clients, hdl);
-  if (it != m_clients.end())
   {
-    m_clients.erase(it);
+    lock_t lock(m_clientsMutex);
+    auto clients = *this->clients();
+    auto it = ossia::find_if(
+        clients, [&](const auto& client) { return *client == hdl; });
+    if (it != clients.end())
+    {
+      if (auto& path = (*it)->metricsPath; !path.empty())
+      {
+        m_functionQueue.enqueue([this, path] {
+          if (auto node = net::find_node(m_device->get_root_node(), path))
+            if (auto parent = node->get_parent())
+              parent->remove_child(*node);
+        });
+      }
+
+      clients.erase(it);
+      set_clients(std::move(clients));
+    }
   }
 
   auto con = m_websocketServer->impl().get_con_from_hdl(hdl);
@@ -528,13 +846,10 @@ void oscquery_server_protocol::on_connectionClosed(
 
 void oscquery_server_protocol::on_nodeCreated(const net::node_base& n) try
 {
-  const auto mess = json_writer::path_added(n);
+  // In case a node which was removed had the same address
+  m_namespaceCache->invalidate(n);
 
-  lock_t lock(m_clientsMutex);
-  for (auto& client : m_clients)
-  {
-    m_websocketServer->send_message(client.connection, mess);
-  }
+  send_notification(json_writer::path_added(n));
 }
 catch (const std::exception& e)
 {
@@ -547,13 +862,9 @@ catch (...)
 
 void oscquery_server_protocol::on_nodeRemoved(const net::node_base& n) try
 {
-  const auto mess = json_writer::path_removed(n.osc_address());
+  m_namespaceCache->invalidate_subtree(n);
 
-  lock_t lock(m_clientsMutex);
-  for (auto& client : m_clients)
-  {
-    m_websocketServer->send_message(client.connection, mess);
-  }
+  send_notification(json_writer::path_removed(n.osc_address()));
 }
 catch (const std::exception& e)
 {
@@ -572,12 +883,9 @@ void oscquery_server_protocol::on_parameterChanged(const ossia::net::parameter_b
 void oscquery_server_protocol::on_attributeChanged(
     const net::node_base& n, ossia::string_view attr) try
 {
-  const auto mess = json_writer::attributes_changed(n, attr);
-  lock_t lock(m_clientsMutex);
-  for (auto& client : m_clients)
-  {
-    m_websocketServer->send_message(client.connection, mess);
-  }
+  m_namespaceCache->invalidate(n);
+
+  send_notification(json_writer::attributes_changed(n, attr));
 }
 catch (const std::exception& e)
 {
@@ -592,6 +900,9 @@ catch (...)
 void oscquery_server_protocol::on_nodeRenamed(
     const net::node_base& n, std::string oldname) try
 {
+  // FULL_PATH changed for the whole subtree
+  m_namespaceCache->invalidate_subtree(n);
+
   auto old_addr = n.osc_address();
   auto it = old_addr.find_last_of('/');
   old_addr.resize(it + 1);
@@ -601,26 +912,16 @@ void oscquery_server_protocol::on_nodeRenamed(
     m_listening.rename(old_addr, n.osc_address());
   }
 
+  const auto clients = this->clients();
   {
     // Remote listening
-    lock_t lock(m_clientsMutex);
-    for (auto& client : m_clients)
+    const auto new_addr = n.osc_address();
+    for (auto& client : *clients)
     {
-      auto it = client.listening.find(old_addr);
-      if (it != client.listening.end())
-      {
-        auto v = it->second;
-        client.listening.erase(it);
-        client.listening.insert({n.osc_address(), v});
-      }
+      client->rename_listening(old_addr, new_addr);
     }
   }
-  const auto mess = json_writer::path_renamed(old_addr, n.osc_address());
-  lock_t lock(m_clientsMutex);
-  for (auto& client : m_clients)
-  {
-    m_websocketServer->send_message(client.connection, mess);
-  }
+  send_notification(json_writer::path_renamed(old_addr, n.osc_address()));
 }
 catch (const std::exception& e)
 {
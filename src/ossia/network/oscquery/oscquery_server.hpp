@@ -1,4 +1,5 @@
 #pragma once
+#include <ossia/detail/json_fwd.hpp>
 #include <ossia/detail/mutex.hpp>
 #include <ossia/network/base/listening.hpp>
 #include <ossia/network/base/protocol.hpp>
@@ -11,6 +12,9 @@
 #include <nano_signal_slot.hpp>
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 namespace osc
 {
 template <typename T>
@@ -24,9 +28,15 @@ class IpEndpointName;
 }
 namespace ossia
 {
+namespace net
+{
+class osc_address_index;
+class osc_bundle_encoder;
+}
 namespace oscquery
 {
 class websocket_server;
+class namespace_cache;
 struct oscquery_client;
 //! Implementation of an oscquery server.
 class OSSIA_EXPORT oscquery_server_protocol final
@@ -55,6 +65,38 @@ public:
     m_echo = b;
   }
 
+  /**
+   * When enabled (the default), a client which sent a LISTEN command only
+   * gets the values it listens to. The clients which never sent one, and
+   * every client when disabled, get every value.
+   */
+  bool listen_filter() const
+  {
+    return m_listenFilter;
+  }
+  void set_listen_filter(bool b)
+  {
+    m_listenFilter = b;
+  }
+
+  /**
+   * When enabled, each websocket client which connects gets a node
+   * /ossia/clients/<n> on the device, whose parameters give the state of
+   * its outbound queue: queue, coalesced and bytes_per_second.
+   * They are updated every second.
+   *
+   * Like the other changes requested from the network, the nodes are
+   * created, updated and removed by run_commands().
+   */
+  bool client_metrics() const
+  {
+    return m_clientMetrics;
+  }
+  void set_client_metrics(bool b)
+  {
+    m_clientMetrics = b;
+  }
+
   bool pull(net::parameter_base&) override;
   std::future<void> pull_async(net::parameter_base&) override;
   void request(net::parameter_base&) override;
@@ -89,8 +131,21 @@ public:
   Nano::Signal<void(const std::string&)> onClientDisconnected;
 
 private:
+  using client_list = std::vector<std::shared_ptr<oscquery_client>>;
+
   // List of connected clients
-  oscquery_client* find_client(const connection_handler& hdl);
+  std::shared_ptr<oscquery_client> find_client(const connection_handler& hdl);
+
+  //! Reply to the namespace query of a node, limited to depth levels of
+  //! children if it is not negative
+  ossia::oscquery::server_reply
+  query_namespace(const net::node_base& node, int depth = -1);
+
+  //! The clients currently connected. The list is never modified once
+  //! published, hence it can be iterated without holding a lock.
+  std::shared_ptr<const client_list> clients() const;
+  //! Publishes a new list of clients. m_clientsMutex must be locked.
+  void set_clients(client_list&& clients);
 
   void
   add_node(ossia::string_view path, const string_map<std::string>& parameters);
@@ -115,6 +170,16 @@ private:
 
   template <typename T>
   bool push_impl(const T& addr, const ossia::value& v);
+  template <typename T>
+  bool push_bundle_impl(const T& addresses);
+  void send_bundle(const std::shared_ptr<oscquery_client>& client);
+  void schedule_outbound(const std::shared_ptr<oscquery_client>& client);
+  void drain_outbound(const std::weak_ptr<oscquery_client>& client);
+  void send_outbound(const std::shared_ptr<oscquery_client>& client);
+  //! Queues a JSON message for all the websocket clients
+  void send_notification(const rapidjson::StringBuffer& message);
+
+  void update_client_metrics();
 
   void update_zeroconf();
   // Exceptions here will be catched by the server
@@ -124,6 +189,9 @@ private:
   ossia::oscquery::server_reply on_BinaryWSrequest(
       const connection_handler& hdl, const std::string& message);
 
+  // Address lookup for inbound OSC messages
+  std::unique_ptr<net::osc_address_index> m_index;
+
   std::unique_ptr<osc::receiver> m_oscServer;
   std::unique_ptr<websocket_server> m_websocketServer;
 
@@ -133,15 +201,20 @@ private:
   // Listening status of the local software
   net::listened_parameters m_listening;
 
-  // The clients connected to this server
-  std::vector<oscquery_client> m_clients;
+  // JSON of the nodes, kept for the namespace queries
+  std::unique_ptr<namespace_cache> m_namespaceCache;
+
+  // The clients connected to this server. Replaced by a new list
+  // when a client connects or disconnects.
+  std::shared_ptr<const client_list> m_clients;
+  mutable mutex_t m_clientsSnapshotMutex;
 
   ossia::net::device_base* m_device{};
 
   // Where the websocket server lives
   std::thread m_serverThread;
 
-  // To lock m_clients
+  // Serializes the changes of m_clients
   mutex_t m_clientsMutex;
 
   // The local ports
@@ -149,6 +222,23 @@ private:
   uint16_t m_wsPort{};
 
   bool m_echo{};
+  bool m_listenFilter{true};
+  bool m_clientMetrics{};
+
+  // Used by the server thread for the client metrics
+  int m_clientIndex{};
+  std::chrono::steady_clock::time_point m_metricsTime;
+
+  // The messages of the bundle being sent, encoded once for all the clients
+  struct bundle_message
+  {
+    const std::string* path{};
+    std::string data;
+    bool critical{};
+  };
+  std::vector<bundle_message> m_bundleMessages;
+  std::unique_ptr<net::osc_bundle_encoder> m_udpBundle;
+  mutex_t m_bundleMutex;
 
   // TODO could we make an intermediate base class for oscquery_{server,mirror}
   // that hold that function queue and other shared members/methods ?
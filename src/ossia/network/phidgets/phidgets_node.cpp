@@ -159,6 +159,7 @@ void phidget_node::add_child_simple(std::unique_ptr<net::node_base> n)
   {
     write_lock_t lock{m_mutex};
     m_children.push_back(std::move(n));
+    children_changed();
   }
   dev.on_node_created(*ptr);
 }
@@ -227,6 +228,7 @@ void phidget_hub_port_node::add_child_simple(std::unique_ptr<net::node_base> n)
   {
     write_lock_t lock{m_mutex};
     m_children.push_back(std::move(n));
+    children_changed();
   }
   dev.on_node_created(*ptr);
 }
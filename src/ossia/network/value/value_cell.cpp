@@ -0,0 +1,137 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check
+// it. PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+#include <ossia/network/value/value_cell.hpp>
+
+#include <thread>
+
+namespace ossia
+{
+namespace
+{
+template <typename T>
+void write_words(uint32_t* words, const T& t) noexcept
+{
+  static_assert(sizeof(T) <= 4 * sizeof(uint32_t));
+  std::memcpy(words, &t, sizeof(T));
+}
+
+struct pack_visitor
+{
+  uint32_t* words;
+  void operator()(float v) const noexcept { write_words(words, v); }
+  void operator()(int v) const noexcept { write_words(words, v); }
+  void operator()(const ossia::vec2f& v) const noexcept
+  {
+    write_words(words, v);
+  }
+  void operator()(const ossia::vec3f& v) const noexcept
+  {
+    write_words(words, v);
+  }
+  void operator()(const ossia::vec4f& v) const noexcept
+  {
+    write_words(words, v);
+  }
+  void operator()(ossia::impulse) const noexcept { }
+  void operator()(bool v) const noexcept { words[0] = v; }
+  void operator()(char v) const noexcept { words[0] = uint32_t(v); }
+  void operator()(const std::string&) const noexcept { }
+  void operator()(const std::vector<ossia::value>&) const noexcept { }
+  void operator()() const noexcept { }
+};
+}
+
+value_cell::value_cell() noexcept = default;
+
+value_cell::value_cell(const ossia::value& v)
+{
+  store(v);
+}
+
+value_cell::~value_cell()
+{
+  // No reader can be left at this point
+  delete m_heap.load(std::memory_order_relaxed);
+}
+
+ossia::value value_cell::load_heap() const
+{
+  const uint32_t epoch = m_epoch.load();
+  auto& readers = m_readers[epoch & 1];
+  readers.fetch_add(1);
+
+  ossia::value res;
+  if (auto p = m_heap.load())
+    res = *p;
+
+  readers.fetch_sub(1, std::memory_order_release);
+  return res;
+}
+
+value_cell::retired value_cell::store(const ossia::value& v)
+{
+  if (is_heap(v.v.which()))
+    return store_heap(new ossia::value(v));
+  else
+    return store_inline(v);
+}
+
+value_cell::retired value_cell::store(ossia::value&& v)
+{
+  if (is_heap(v.v.which()))
+    return store_heap(new ossia::value(std::move(v)));
+  else
+    return store_inline(v);
+}
+
+value_cell::retired value_cell::store_inline(const ossia::value& v) noexcept
+{
+  uint32_t words[4]{};
+  v.apply(pack_visitor{words});
+
+  const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+  m_seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  m_type.store(v.v.which(), std::memory_order_relaxed);
+  for (int i = 0; i < 4; i++)
+    m_words[i].store(words[i], std::memory_order_relaxed);
+
+  m_seq.store(seq + 2, std::memory_order_release);
+
+  // Readers which saw the heap type before the write try again
+  return retired{*this, m_heap.exchange(nullptr)};
+}
+
+value_cell::retired value_cell::store_heap(ossia::value* v)
+{
+  auto prev = m_heap.exchange(v);
+
+  const uint32_t seq = m_seq.load(std::memory_order_relaxed);
+  m_seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  m_type.store(v->v.which(), std::memory_order_relaxed);
+  m_seq.store(seq + 2, std::memory_order_release);
+
+  return retired{*this, prev};
+}
+
+void value_cell::retire(ossia::value* v) noexcept
+{
+  // A reader which may still see v has incremented one of the two counters
+  // before v was replaced: it has left once each counter was seen at zero.
+  // After each flip, new readers go to the other counter, so both drain.
+  // Other writers may retire their values concurrently.
+  const uint32_t epoch = m_epoch.fetch_add(1);
+  for (uint32_t i = 0; i < 2; i++)
+  {
+    if (i > 0)
+      m_epoch.fetch_add(1);
+    auto& readers = m_readers[(epoch + i) & 1];
+    while (readers.load() != 0)
+      std::this_thread::yield();
+  }
+
+  delete v;
+}
+}
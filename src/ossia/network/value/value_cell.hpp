@@ -0,0 +1,208 @@
+#pragma once
+#include <ossia/network/value/value.hpp>
+#include <ossia/network/value/value_traits.hpp>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace ossia
+{
+namespace detail
+{
+//! Index of T in the variant of ossia::value, as returned by which()
+template <typename T>
+constexpr int value_index_of() noexcept
+{
+  using impl = ossia::value_variant_type::Impl;
+  constexpr bool matches[]{
+      std::is_same_v<T, decltype(impl::m_value0)>,
+      std::is_same_v<T, decltype(impl::m_value1)>,
+      std::is_same_v<T, decltype(impl::m_value2)>,
+      std::is_same_v<T, decltype(impl::m_value3)>,
+      std::is_same_v<T, decltype(impl::m_value4)>,
+      std::is_same_v<T, decltype(impl::m_value5)>,
+      std::is_same_v<T, decltype(impl::m_value6)>,
+      std::is_same_v<T, decltype(impl::m_value7)>,
+      std::is_same_v<T, decltype(impl::m_value8)>,
+      std::is_same_v<T, decltype(impl::m_value9)>};
+  for (std::size_t i = 0; i < sizeof(matches); i++)
+    if (matches[i])
+      return int(i);
+  return -1;
+}
+
+template <typename... Ts>
+constexpr bool value_indices_match_traits() noexcept
+{
+  return (
+      (value_index_of<Ts>() == int(ossia::value_trait<Ts>::ossia_enum))
+      && ...);
+}
+
+// value_cell handles every type of the variant, and get_type() agrees with it
+static_assert(
+    value_indices_match_traits<
+        float, int, ossia::vec2f, ossia::vec3f, ossia::vec4f, ossia::impulse,
+        bool, std::string, std::vector<ossia::value>, char>(),
+    "value_cell does not match the types of ossia::value");
+}
+
+/**
+ * @brief Holds a value which can be read from any thread without locking.
+ *
+ * The values which fit in a few words (float, int, bool, char, impulse and
+ * vecNf) are stored inline and read with a seqlock: a reader copies them,
+ * and tries again if a write happened meanwhile.
+ *
+ * Strings and lists are stored in a heap-allocated value. A reader copies
+ * it while marking one of two reader counters; the writer replaces the
+ * pointer, then waits for the readers of both counters to leave before
+ * freeing the previous value. The counters are flipped in between so that
+ * new readers cannot keep the writer waiting.
+ *
+ * load() never takes a lock. The writes must be serialized by the caller,
+ * but the wait for the readers is done when the \ref retired value returned
+ * by store() is destroyed: it can be kept after the writers' lock is
+ * released.
+ */
+class OSSIA_EXPORT value_cell
+{
+public:
+  value_cell() noexcept;
+  explicit value_cell(const ossia::value& v);
+  ~value_cell();
+
+  value_cell(const value_cell&) = delete;
+  value_cell& operator=(const value_cell&) = delete;
+
+  //! A heap value replaced by store(). Frees it once no reader can see it.
+  class retired
+  {
+  public:
+    retired() noexcept = default;
+    retired(const retired&) = delete;
+    retired& operator=(const retired&) = delete;
+    retired(retired&& other) noexcept
+        : m_cell{other.m_cell}, m_value{std::exchange(other.m_value, nullptr)}
+    {
+    }
+    retired& operator=(retired&& other) noexcept
+    {
+      reset();
+      m_cell = other.m_cell;
+      m_value = std::exchange(other.m_value, nullptr);
+      return *this;
+    }
+    ~retired()
+    {
+      reset();
+    }
+
+    //! Waits for the readers of the value, then frees it
+    void reset() noexcept
+    {
+      if (m_value)
+        m_cell->retire(std::exchange(m_value, nullptr));
+    }
+
+  private:
+    friend class value_cell;
+    retired(value_cell& cell, ossia::value* v) noexcept
+        : m_cell{&cell}, m_value{v}
+    {
+    }
+
+    value_cell* m_cell{};
+    ossia::value* m_value{};
+  };
+
+  ossia::value load() const
+  {
+    for (;;)
+    {
+      const uint32_t seq = m_seq.load(std::memory_order_acquire);
+      if (seq & 1)
+        continue;
+
+      const int type = m_type.load(std::memory_order_relaxed);
+      if (is_heap(type))
+      {
+        if (auto res = load_heap(); res.valid())
+          return res;
+        // The heap value was removed meanwhile
+        continue;
+      }
+
+      uint32_t words[4];
+      for (int i = 0; i < 4; i++)
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_seq.load(std::memory_order_relaxed) == seq)
+        return unpack(type, words);
+    }
+  }
+
+  //! Readers see the new value once this returns. The previous value is
+  //! freed when the result is destroyed.
+  retired store(const ossia::value& v);
+  retired store(ossia::value&& v);
+
+private:
+  static bool is_heap(int type) noexcept
+  {
+    return type == detail::value_index_of<std::string>()
+           || type == detail::value_index_of<std::vector<ossia::value>>();
+  }
+
+  static ossia::value unpack(int type, const uint32_t* words) noexcept
+  {
+    switch (type)
+    {
+      case detail::value_index_of<float>():
+        return read<float>(words);
+      case detail::value_index_of<int>():
+        return read<int>(words);
+      case detail::value_index_of<ossia::vec2f>():
+        return read<ossia::vec2f>(words);
+      case detail::value_index_of<ossia::vec3f>():
+        return read<ossia::vec3f>(words);
+      case detail::value_index_of<ossia::vec4f>():
+        return read<ossia::vec4f>(words);
+      case detail::value_index_of<ossia::impulse>():
+        return ossia::impulse{};
+      case detail::value_index_of<bool>():
+        return bool(words[0]);
+      case detail::value_index_of<char>():
+        return char(words[0]);
+      default:
+        return ossia::value{};
+    }
+  }
+
+  template <typename T>
+  static T read(const uint32_t* words) noexcept
+  {
+    static_assert(sizeof(T) <= 4 * sizeof(uint32_t));
+    T t;
+    std::memcpy(&t, words, sizeof(T));
+    return t;
+  }
+
+  ossia::value load_heap() const;
+  retired store_inline(const ossia::value& v) noexcept;
+  retired store_heap(ossia::value* v);
+  void retire(ossia::value* v) noexcept;
+
+  std::atomic<uint32_t> m_seq{};
+  std::atomic<int> m_type{ossia::value_variant_type::npos};
+  std::atomic<uint32_t> m_words[4]{};
+
+  std::atomic<ossia::value*> m_heap{};
+  std::atomic<uint32_t> m_epoch{};
+  mutable std::atomic<uint32_t> m_readers[2]{};
+};
+}
@@ -39,6 +39,7 @@ set(API_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/std_fwd.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/safe_vec.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/size.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/slot_map.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/small_vector.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/string_map.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/detail/string_view.hpp"
@@ -113,6 +114,7 @@ set(API_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/detail/value_conversion_impl.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/detail/value_parse_impl.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value_cell.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value_traits.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value_algorithms.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value_variant_impl.hpp"
@@ -189,6 +191,7 @@ set(SRCS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/preset/exception.cpp"
 
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/value/value_cell.cpp"
 
     #    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/dataspace/dataspace.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/dataspace/dataspace_visitors.cpp"
@@ -312,7 +315,11 @@ set(OSSIA_OSC_HEADERS
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/message_generator.hpp"
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/receiver.hpp"
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/osc_receive.hpp"
+  "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/osc_address_index.hpp"
+  "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/bundle.hpp"
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/sender.hpp"
+  "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/udp_batch.hpp"
+  "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/udp_batch_fwd.hpp"
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/osc.hpp"
   "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/osc/detail/osc_fwd.hpp"
   )
@@ -354,6 +361,7 @@ set(OSSIA_OSCQUERY_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/host_info.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/outbound_visitor.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/outbound_visitor_impl.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/outbound_queue.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/server.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/client.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/http_client.hpp"
@@ -369,6 +377,7 @@ set(OSSIA_OSCQUERY_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/server_reply.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/json_reader_detail.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/json_writer_detail.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/namespace_cache.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/value_to_json.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/domain_to_json.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/oscquery_units.hpp"
@@ -380,6 +389,7 @@ set(OSSIA_OSCQUERY_SRCS
 
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/json_reader_detail.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/json_writer_detail.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/namespace_cache.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/html_writer.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/network/oscquery/detail/query_parser.cpp"
 
@@ -571,10 +581,12 @@ set(OSSIA_DATAFLOW_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/value_vector.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/value_port.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/audio_port.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/audio_kernels.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/audio_stretch_mode.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/midi_port.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/data_copy.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/dataflow_fwd.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/commit_dispatcher.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/execution_state.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/exec_state_facade.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/for_each_port.hpp"
@@ -583,6 +595,7 @@ set(OSSIA_DATAFLOW_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph_node.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/node_process.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/port.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/path_cache.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/control_inlets.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/timed_value.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/typed_value.hpp"
@@ -634,11 +647,15 @@ set(OSSIA_DATAFLOW_HEADERS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph_ordering.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph_static.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph_parallel.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/task_graph_executor.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph_utils.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph_interface.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/tick_methods.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/node_executors.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/buffer_planner.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/node_profiler.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/breadth_first_search.hpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/dynamic_topological_order.hpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/transitive_closure.hpp"
 )
 
@@ -650,11 +667,14 @@ set(OSSIA_DATAFLOW_SRCS
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/data.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/port.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph_node.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/commit_dispatcher.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/execution_state.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/nodes/state.cpp"
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/control_inlets.cpp"
 
     "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/graph.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/buffer_planner.cpp"
+    "${CMAKE_CURRENT_SOURCE_DIR}/ossia/dataflow/graph/node_profiler.cpp"
 )
 
 
@@ -0,0 +1,103 @@
+#include <ossia/dataflow/nodes/gain.hpp>
+#include <ossia/dataflow/nodes/sine.hpp>
+#include <ossia/dataflow/graph/graph_static.hpp>
+#include <ossia/dataflow/execution_state.hpp>
+#include "../Editor/TestUtils.hpp"
+
+#include <chrono>
+#include <iostream>
+
+static const constexpr int NUM_TAKES = 10;
+static const constexpr int NUM_TICKS = 100;
+static const constexpr auto NUM_NODES = { 1, 10, 50, 100, 200 };
+
+namespace
+{
+// Reads its input and does nothing with it
+struct audio_tap final : public ossia::nonowning_graph_node
+{
+  ossia::audio_inlet audio_in;
+  audio_tap()
+  {
+    m_inlets.push_back(&audio_in);
+  }
+  void run(const ossia::token_request&, ossia::exec_state_facade) noexcept override
+  {
+  }
+};
+}
+
+// A sine going through a serial chain of N gain nodes.
+// With taps, each outlet of the chain has a second consumer: the audio
+// buffers must be copied to each inlet instead of being forwarded.
+double run_chain(int N, bool taps)
+{
+  using namespace ossia;
+  int64_t count = 0;
+  for (int take = 0; take < NUM_TAKES; take++)
+  {
+    tc_graph g;
+    std::vector<ossia::node_ptr> nodes;
+
+    auto sine = std::make_shared<ossia::nodes::sine>();
+    g.add_node(sine);
+    nodes.push_back(sine);
+
+    ossia::node_ptr prev = sine;
+    for (int i = 0; i < N; i++)
+    {
+      auto gain = std::make_shared<ossia::nodes::gain_node>();
+      g.add_node(gain);
+      nodes.push_back(gain);
+      g.connect(make_edge(
+          immediate_strict_connection{}, prev->root_outputs()[0],
+          gain->root_inputs()[0], prev, gain));
+
+      if (taps)
+      {
+        auto tap = std::make_shared<audio_tap>();
+        g.add_node(tap);
+        nodes.push_back(tap);
+        g.connect(make_edge(
+            immediate_strict_connection{}, prev->root_outputs()[0],
+            tap->root_inputs()[0], prev, tap));
+      }
+      prev = gain;
+    }
+
+    execution_state e;
+    e.sampleRate = 44100;
+    e.bufferSize = 512;
+
+    ossia::time_value cur_time{};
+    for (int tick = 0; tick <= NUM_TICKS; tick++)
+    {
+      auto t0 = std::chrono::steady_clock::now();
+      e.clear_local_state();
+      e.get_new_values();
+      ossia::simple_token_request tk{cur_time, cur_time + 512_tv};
+      for (auto& node : nodes)
+        node->request(tk);
+      cur_time += 512_tv;
+      g.state(e);
+      e.commit();
+      auto t1 = std::chrono::steady_clock::now();
+
+      // The first tick allocates the buffers
+      if (tick > 0)
+        count += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+  }
+
+  // Microseconds per tick
+  return double(count) / (1000. * NUM_TAKES * NUM_TICKS);
+}
+
+int main()
+{
+  std::cout << "count\tchain\tchain+taps\n";
+  for (int N : NUM_NODES)
+  {
+    std::cout << N << "\t" << run_chain(N, false) << "\t" << run_chain(N, true) << "\n";
+  }
+}
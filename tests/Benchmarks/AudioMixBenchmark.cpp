@@ -0,0 +1,76 @@
+#include <ossia/dataflow/audio_kernels.hpp>
+#include <ossia/detail/pod_vector.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static const constexpr int NUM_TAKES = 100;
+static const constexpr int NUM_TICKS = 100;
+static const constexpr int BUFFER_SIZE = 512;
+static const constexpr auto NUM_SINES = { 1, 10, 50, 100, 200, 500, 1000 };
+
+// Mix N sines in an audio bus, like MixNSines, with 64-bit and 32-bit buses.
+// Mono source channels, mixed to a stereo bus with a gain.
+template <typename T>
+double run(int N)
+{
+  using channel = ossia::aligned_pod_vector<T, 64>;
+  std::vector<channel> sines(N, channel(BUFFER_SIZE));
+  for (int i = 0; i < N; i++)
+    for (int k = 0; k < BUFFER_SIZE; k++)
+      sines[i][k] = T(std::sin(0.01 * (i + 1) * k));
+
+  std::vector<channel> bus(2, channel(BUFFER_SIZE));
+  std::vector<float> device_out(BUFFER_SIZE);
+
+  int64_t count = 0;
+  for (int take = 0; take < NUM_TAKES; take++)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < NUM_TICKS; tick++)
+    {
+      for (auto& chan : bus)
+        ossia::audio_kernels::clear(chan.data(), BUFFER_SIZE);
+
+      for (auto& sine : sines)
+      {
+        ossia::audio_kernels::mix_gain(sine.data(), bus[0].data(), BUFFER_SIZE, 0.5);
+        ossia::audio_kernels::mix_gain(sine.data(), bus[1].data(), BUFFER_SIZE, 0.25);
+      }
+
+      ossia::audio_kernels::gain(bus[0].data(), BUFFER_SIZE, 1. / N);
+      ossia::audio_kernels::gain(bus[1].data(), BUFFER_SIZE, 1. / N);
+
+      // To the device
+      ossia::audio_kernels::copy(bus[0].data(), device_out.data(), BUFFER_SIZE);
+      ossia::audio_kernels::mix(bus[1].data(), device_out.data(), BUFFER_SIZE);
+
+      // The output is never read: keep the compiler from removing the mix
+      benchmark::DoNotOptimize(device_out.data());
+      benchmark::ClobberMemory();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    count += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  }
+
+  // Microseconds per tick
+  return double(count) / (1000. * NUM_TAKES * NUM_TICKS);
+}
+
+int main()
+{
+#if defined(OSSIA_AUDIO_FLOAT32)
+  std::cout << "audio bus: float\n";
+#else
+  std::cout << "audio bus: double\n";
+#endif
+  std::cout << "count\tdouble\tfloat\n";
+  for (int N : NUM_SINES)
+  {
+    std::cout << N << "\t" << run<double>(N) << "\t" << run<float>(N) << "\n";
+  }
+}
@@ -30,5 +30,48 @@ static void BM_SomeFunction(benchmark::State& state) {
 }
 // Register the function as a benchmark
 BENCHMARK(BM_SomeFunction)->DenseRange(0, 500, 50);
+
+// Wide trees: /light, /light.1 ... /light.N-1 under the same parent
+static void BM_WideTree_CreateChild(benchmark::State& state) {
+  for (auto _ : state) {
+      ossia::net::generic_device dev{"dev"};
+      auto& root = dev.get_root_node();
+      const int k = state.range(0);
+      for(int i = 0; i < k; i++)
+        benchmark::DoNotOptimize(root.create_child("light"));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_WideTree_CreateChild)->RangeMultiplier(4)->Range(16, 16384)->Complexity();
+
+static void BM_WideTree_CreateChildren(benchmark::State& state) {
+  const int k = state.range(0);
+  std::vector<std::string> names;
+  names.reserve(k);
+  for(int i = 0; i < k; i++)
+    names.push_back("light." + std::to_string(i + 1));
+
+  for (auto _ : state) {
+      ossia::net::generic_device dev{"dev"};
+      benchmark::DoNotOptimize(dev.get_root_node().create_children(names));
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_WideTree_CreateChildren)->RangeMultiplier(4)->Range(16, 16384)->Complexity();
+
+static void BM_WideTree_FindChild(benchmark::State& state) {
+  const int k = state.range(0);
+  ossia::net::generic_device dev{"dev"};
+  auto& root = dev.get_root_node();
+  for(int i = 0; i < k; i++)
+    root.create_child("light");
+
+  const std::string name = "light." + std::to_string(k - 1);
+  for (auto _ : state) {
+      benchmark::DoNotOptimize(root.find_child(name));
+  }
+}
+BENCHMARK(BM_WideTree_FindChild)->RangeMultiplier(4)->Range(16, 16384);
+
 // Run the benchmark
 BENCHMARK_MAIN();
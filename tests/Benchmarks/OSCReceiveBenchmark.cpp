@@ -0,0 +1,115 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <ossia/network/generic/generic_device.hpp>
+#include <ossia/network/osc/detail/osc_receive.hpp>
+#include <benchmark/benchmark.h>
+
+#include <oscpack/osc/OscOutboundPacketStream.h>
+
+#include <random>
+
+// Measures how many inbound OSC messages per second handle_osc_message
+// can dispatch on a device with N parameters.
+struct osc_receive_fixture
+{
+  ossia::net::generic_device device{"dev"};
+  std::vector<std::string> packets;
+
+  osc_receive_fixture(int n, bool pattern)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      auto& node = ossia::net::create_node(
+          device.get_root_node(), "/light." + std::to_string(i) + "/value");
+      node.create_parameter(ossia::val_type::FLOAT);
+    }
+
+    std::mt19937 gen{0};
+    std::uniform_int_distribution<int> dist{0, n - 1};
+    char buffer[256];
+    for (int i = 0; i < 1024; i++)
+    {
+      oscpack::OutboundPacketStream str(buffer, sizeof(buffer));
+      std::string addr = pattern
+          ? "/light.{" + std::to_string(dist(gen)) + ","
+                + std::to_string(dist(gen)) + "}/value"
+          : "/light." + std::to_string(dist(gen)) + "/value";
+      str << oscpack::BeginMessageN(addr) << float(i) << oscpack::EndMessage();
+      packets.emplace_back(str.Data(), str.Size());
+    }
+  }
+};
+
+static void BM_osc_receive_tree_lookup(benchmark::State& state)
+{
+  // Reference: what the receivers used to do for every message
+  osc_receive_fixture f(state.range(0), false);
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    auto& p = f.packets[i++ % f.packets.size()];
+    oscpack::ReceivedMessage m(oscpack::ReceivedPacket{p.data(), p.size()});
+    if (auto n = ossia::net::find_node(
+            f.device.get_root_node(), m.AddressPattern()))
+      if (auto param = n->get_parameter())
+        ossia::net::update_value(*param, m);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_osc_receive_index(benchmark::State& state)
+{
+  osc_receive_fixture f(state.range(0), false);
+  ossia::net::osc_address_index idx;
+  idx.attach(f.device);
+  ossia::net::network_logger logger;
+
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    auto& p = f.packets[i++ % f.packets.size()];
+    oscpack::ReceivedMessage m(oscpack::ReceivedPacket{p.data(), p.size()});
+    ossia::net::handle_osc_message<false>(m, idx, f.device, logger);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_osc_receive_pattern_tree(benchmark::State& state)
+{
+  osc_receive_fixture f(state.range(0), true);
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    auto& p = f.packets[i++ % f.packets.size()];
+    oscpack::ReceivedMessage m(oscpack::ReceivedPacket{p.data(), p.size()});
+    for (auto n :
+         ossia::net::find_nodes(f.device.get_root_node(), m.AddressPattern()))
+      if (auto param = n->get_parameter())
+        ossia::net::update_value(*param, m);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_osc_receive_pattern_index(benchmark::State& state)
+{
+  osc_receive_fixture f(state.range(0), true);
+  ossia::net::osc_address_index idx;
+  idx.attach(f.device);
+  ossia::net::network_logger logger;
+
+  std::size_t i = 0;
+  for (auto _ : state)
+  {
+    auto& p = f.packets[i++ % f.packets.size()];
+    oscpack::ReceivedMessage m(oscpack::ReceivedPacket{p.data(), p.size()});
+    ossia::net::handle_osc_message<false>(m, idx, f.device, logger);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_osc_receive_tree_lookup)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_osc_receive_index)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_osc_receive_pattern_tree)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(BM_osc_receive_pattern_index)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK_MAIN();
@@ -0,0 +1,114 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <ossia/network/generic/generic_device.hpp>
+#include <ossia/network/generic/generic_parameter.hpp>
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Reads of a parameter by N threads, like the audio thread reading through
+// copy_from_global, while a network thread writes it at 10 kHz.
+// Measures the reads done by each reader thread.
+namespace
+{
+struct contention_fixture
+{
+  ossia::net::generic_device device{"bench"};
+  ossia::net::parameter_base* param{};
+  std::atomic_bool running{true};
+  std::thread writer;
+
+  explicit contention_fixture(ossia::val_type t)
+  {
+    auto& node = ossia::net::create_node(device.get_root_node(), "/foo");
+    param = node.create_parameter(t);
+  }
+
+  template <typename F>
+  void start(F make_value)
+  {
+    writer = std::thread{[this, make_value] {
+      using namespace std::chrono;
+      auto next = steady_clock::now();
+      int i = 0;
+      while (running)
+      {
+        param->set_value(make_value(i++));
+        next += microseconds(100);
+        std::this_thread::sleep_until(next);
+      }
+    }};
+  }
+
+  ~contention_fixture()
+  {
+    running = false;
+    if (writer.joinable())
+      writer.join();
+  }
+};
+
+contention_fixture* g_fixture{};
+
+template <typename F>
+void setup(const benchmark::State& state, ossia::val_type t, F make_value)
+{
+  if (state.thread_index() == 0)
+  {
+    g_fixture = new contention_fixture{t};
+    g_fixture->start(make_value);
+  }
+}
+
+void teardown(const benchmark::State& state)
+{
+  if (state.thread_index() == 0)
+  {
+    delete g_fixture;
+    g_fixture = nullptr;
+  }
+}
+}
+
+static void BM_read_float(benchmark::State& state)
+{
+  setup(state, ossia::val_type::FLOAT, [](int i) {
+    return ossia::value{float(i)};
+  });
+  for (auto _ : state)
+    benchmark::DoNotOptimize(g_fixture->param->value());
+  state.SetItemsProcessed(state.iterations());
+  teardown(state);
+}
+
+static void BM_read_vec4f(benchmark::State& state)
+{
+  setup(state, ossia::val_type::VEC4F, [](int i) {
+    const float f = float(i);
+    return ossia::value{ossia::vec4f{f, f, f, f}};
+  });
+  for (auto _ : state)
+    benchmark::DoNotOptimize(g_fixture->param->value());
+  state.SetItemsProcessed(state.iterations());
+  teardown(state);
+}
+
+static void BM_read_string(benchmark::State& state)
+{
+  setup(state, ossia::val_type::STRING, [](int i) {
+    return ossia::value{"message number " + std::to_string(i)};
+  });
+  for (auto _ : state)
+    benchmark::DoNotOptimize(g_fixture->param->value());
+  state.SetItemsProcessed(state.iterations());
+  teardown(state);
+}
+
+BENCHMARK(BM_read_float)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_read_vec4f)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_read_string)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <ossia/network/osc/detail/receiver.hpp>
+#include <ossia/network/osc/detail/udp_batch.hpp>
+#include <benchmark/benchmark.h>
+
+#include <oscpack/ip/UdpSocket.h>
+#include <oscpack/osc/OscOutboundPacketStream.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Loopback throughput of OSC messages, sent and received one datagram per
+// system call (oscpack) or many at once (sendmmsg / recvmmsg).
+// The range is the number of messages sent per "tick".
+static const constexpr unsigned int bench_port = 17123;
+
+static std::vector<std::string> make_packets(int n)
+{
+  std::vector<std::string> packets;
+  char buffer[256];
+  for (int i = 0; i < n; i++)
+  {
+    oscpack::OutboundPacketStream str(buffer, sizeof(buffer));
+    str << oscpack::BeginMessageN("/light." + std::to_string(i) + "/value")
+        << float(i) << oscpack::EndMessage();
+    packets.emplace_back(str.Data(), str.Size());
+  }
+  return packets;
+}
+
+// Waits until the receiver got the whole tick, with a timeout in case of loss
+static void wait_for(const std::atomic_int& received, int expected)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  while (received.load() < expected
+         && std::chrono::steady_clock::now() - t0 < std::chrono::seconds(1))
+    std::this_thread::yield();
+}
+
+static void BM_udp_oscpack(benchmark::State& state)
+{
+  const int n = state.range(0);
+  auto packets = make_packets(n);
+
+  std::atomic_int received{};
+  osc::receiver recv{
+      bench_port,
+      [&](const oscpack::ReceivedMessage&, const oscpack::IpEndpointName&) {
+        received++;
+      }};
+  recv.run();
+
+  oscpack::UdpTransmitSocket socket{
+      oscpack::IpEndpointName("127.0.0.1", recv.port())};
+  int total = 0;
+  for (auto _ : state)
+  {
+    for (auto& p : packets)
+      socket.Send(p.data(), p.size());
+    total += n;
+    wait_for(received, total);
+  }
+  state.SetItemsProcessed(received.load());
+}
+
+#if defined(OSSIA_UDP_BATCH)
+static void BM_udp_batch(benchmark::State& state)
+{
+  const int n = state.range(0);
+  auto packets = make_packets(n);
+
+  std::atomic_int received{};
+  osc::receiver recv{
+      bench_port,
+      [&](const oscpack::ReceivedMessage&, const oscpack::IpEndpointName&) {
+        received++;
+      },
+      true};
+  recv.run();
+
+  oscpack::IpEndpointName remote{"127.0.0.1", int(recv.port())};
+  const int socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+  osc::udp_batch_sender sender;
+  int total = 0;
+  for (auto _ : state)
+  {
+    for (auto& p : packets)
+      sender.queue(socket, remote, p.data(), p.size());
+    sender.flush();
+    total += n;
+    wait_for(received, total);
+  }
+  ::close(socket);
+  state.SetItemsProcessed(received.load());
+}
+BENCHMARK(BM_udp_batch)->RangeMultiplier(4)->Range(1, 1024);
+#endif
+
+BENCHMARK(BM_udp_oscpack)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK_MAIN();
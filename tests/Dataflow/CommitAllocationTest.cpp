@@ -0,0 +1,117 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <catch.hpp>
+#include <ossia/detail/config.hpp>
+#include <ossia/dataflow/execution_state.hpp>
+#include <ossia/dataflow/typed_value.hpp>
+#include <ossia/network/base/node_attributes.hpp>
+#include <ossia/network/generic/generic_device.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts the heap allocations done while g_count_allocations is set
+static std::atomic_bool g_count_allocations{};
+static std::atomic_int g_allocations{};
+
+void* operator new(std::size_t sz)
+{
+  if (g_count_allocations)
+    g_allocations++;
+  if (auto p = std::malloc(sz > 0 ? sz : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+struct commit_fixture
+{
+  ossia::net::generic_device device{"test"};
+  ossia::execution_state e;
+  std::vector<ossia::net::parameter_base*> params;
+
+  explicit commit_fixture(bool dispatched = false)
+  {
+    e.set_dispatched_commits(dispatched);
+    for (int i = 0; i < 100; i++)
+    {
+      auto& node = ossia::net::create_node(
+          device.get_root_node(), "/foo." + std::to_string(i));
+      params.push_back(node.create_parameter(ossia::val_type::FLOAT));
+      ossia::net::set_priority(node, float(i % 7));
+    }
+    e.register_device(&device);
+  }
+
+  template <typename Commit>
+  int allocations(Commit commit)
+  {
+    auto tick = [&](int t) {
+      e.begin_tick();
+      for (auto p : params)
+      {
+        // Two messages for the same parameter are merged
+        e.insert(*p, ossia::typed_value{ossia::value{float(t)}});
+        e.insert(*p, ossia::typed_value{ossia::value{float(t + 1)}});
+      }
+      commit();
+    };
+
+    // The first ticks fill the persistent buffers
+    for (int t = 0; t < 10; t++)
+      tick(t);
+
+    g_allocations = 0;
+    g_count_allocations = true;
+    for (int t = 0; t < 100; t++)
+      tick(t);
+    g_count_allocations = false;
+
+    return g_allocations;
+  }
+};
+
+TEST_CASE ("test_commit_ordered_no_alloc", "test_commit_ordered_no_alloc")
+{
+  commit_fixture f;
+  REQUIRE(f.allocations([&] { f.e.commit_ordered(); }) == 0);
+  REQUIRE(f.params[3]->value() == ossia::value{float(100)});
+}
+
+TEST_CASE ("test_commit_priorized_no_alloc", "test_commit_priorized_no_alloc")
+{
+  commit_fixture f;
+  REQUIRE(f.allocations([&] { f.e.commit_priorized(); }) == 0);
+  REQUIRE(f.params[3]->value() == ossia::value{float(100)});
+}
+
+TEST_CASE ("test_commit_dispatched", "test_commit_dispatched")
+{
+  commit_fixture f{true};
+  REQUIRE(f.allocations([&] { f.e.commit_dispatched(); }) == 0);
+
+  // The local values are set by the execution thread
+  REQUIRE(f.params[3]->value() == ossia::value{float(100)});
+
+  f.e.unregister_device(&f.device);
+  f.e.begin_tick();
+  f.e.sync_dispatched();
+
+  // Once the worker is stopped, every message was either sent or merged
+  const auto m = f.e.dispatch_metrics();
+  REQUIRE(m.dropped == 0);
+  REQUIRE(m.queued == 110 * f.params.size());
+  REQUIRE(m.sent + m.coalesced == m.queued);
+  REQUIRE(m.batches > 0);
+}
@@ -3,6 +3,8 @@
 
 #include <catch.hpp>
 #include <ossia/detail/config.hpp>
+#include <ossia/dataflow/dataflow.hpp>
+#include <ossia/dataflow/execution_state.hpp>
 #include <ossia/dataflow/graph/graph.hpp>
 #include <ossia/dataflow/graph/graph_static.hpp>
 #include <ossia/network/base/parameter.hpp>
@@ -954,3 +956,295 @@ TEST_CASE ("hierarchical_ordering", "hierarchical_ordering")
 {
 
 }
+
+TEST_CASE ("path_cache", "path_cache")
+{
+  using namespace ossia;
+  ossia::net::generic_device dev{"dev"};
+  ossia::net::create_node(dev, "/synth.1/gain").create_parameter(val_type::FLOAT);
+  ossia::net::create_node(dev, "/synth.2/gain").create_parameter(val_type::FLOAT);
+
+  execution_state e;
+  e.register_device(&dev);
+  e.begin_tick();
+
+  destination_t address = *traversal::make_path("dev:/synth.*/gain");
+  path_cache cache;
+  auto count = [&] {
+    int n = 0;
+    apply_to_destination(
+        address, e.exec_devices(), e.tree_generation(), cache,
+        [&](net::parameter_base*, bool) { n++; }, do_nothing_for_nodes{});
+    return n;
+  };
+
+  REQUIRE(count() == 2);
+  const auto gen = cache.generation;
+  REQUIRE(count() == 2);
+  REQUIRE(cache.generation == gen);
+
+  // The cache follows the changes of the tree
+  ossia::net::create_node(dev, "/synth.3/gain").create_parameter(val_type::FLOAT);
+  REQUIRE(count() == 3);
+  REQUIRE(cache.generation != gen);
+
+  dev.get_root_node().remove_child("synth.1");
+  REQUIRE(count() == 2);
+
+  ossia::net::find_node(dev, "/synth.2")->set_name("drums");
+  REQUIRE(count() == 1);
+
+  // And the changes of the address
+  address = *traversal::make_path("dev:/drums/gain");
+  REQUIRE(count() == 1);
+  REQUIRE(cache.nodes.front() == ossia::net::find_node(dev, "/drums/gain"));
+}
+
+TEST_CASE ("audio_forwarding", "audio_forwarding")
+{
+  using namespace ossia;
+  execution_state e;
+  tc_graph g;
+
+  auto n1_out = new audio_outlet;
+  auto n1 = std::make_shared<node_mock>(inlets{}, outlets{n1_out});
+  auto n2_in = new audio_inlet;
+  auto n2 = std::make_shared<node_mock>(inlets{n2_in}, outlets{});
+  auto n3_in = new audio_inlet;
+  auto n3 = std::make_shared<node_mock>(inlets{n3_in}, outlets{});
+  g.add_node(n1);
+  g.add_node(n2);
+  g.add_node(n3);
+
+  const audio_vector expected{audio_channel{1., 2., 3.}, audio_channel{4., 5., 6.}};
+
+  // Single consumer with another channel layout: the data is copied
+  g.connect(make_edge(immediate_strict_connection{}, n1_out, n2_in, n1, n2));
+  (*n1_out)->samples = expected;
+  graph_util::init_inlet(*n2_in, e);
+  REQUIRE((*n2_in)->samples == expected);
+  REQUIRE((*n1_out)->samples == expected);
+  graph_util::teardown_inlet(*n2_in, e);
+  REQUIRE((*n2_in)->samples.size() == 2);
+
+  // Same layout: the inlet takes the channels of the outlet, which keeps
+  // its channel count
+  graph_util::init_inlet(*n2_in, e);
+  REQUIRE((*n2_in)->samples == expected);
+  REQUIRE((*n1_out)->samples.size() == 2);
+  for (auto& chan : (*n1_out)->samples)
+    REQUIRE(chan.empty());
+  graph_util::teardown_inlet(*n2_in, e);
+
+  // Two consumers: both get a copy
+  g.connect(make_edge(immediate_strict_connection{}, n1_out, n3_in, n1, n3));
+  (*n1_out)->samples = expected;
+  graph_util::init_inlet(*n2_in, e);
+  graph_util::init_inlet(*n3_in, e);
+  REQUIRE((*n2_in)->samples == expected);
+  REQUIRE((*n3_in)->samples == expected);
+  REQUIRE((*n1_out)->samples == expected);
+}
+
+TEST_CASE ("buffer_planner", "buffer_planner")
+{
+  using namespace ossia;
+  execution_state e;
+  tc_graph g;
+
+  // n1 -> n2 -> n3 -> n4: each node adds 1 to its input
+  auto n1_out = new audio_outlet;
+  auto n1 = std::make_shared<node_mock>(inlets{}, outlets{n1_out});
+  auto n2_in = new audio_inlet;
+  auto n2_out = new audio_outlet;
+  auto n2 = std::make_shared<node_mock>(inlets{n2_in}, outlets{n2_out});
+  auto n3_in = new audio_inlet;
+  auto n3_out = new audio_outlet;
+  auto n3 = std::make_shared<node_mock>(inlets{n3_in}, outlets{n3_out});
+  auto n4_in = new audio_inlet;
+  auto n4 = std::make_shared<node_mock>(inlets{n4_in}, outlets{});
+
+  audio_vector result;
+  n1->fun = [&](auto&&...) {
+    (*n1_out)->samples = audio_vector{audio_channel{1., 2., 3.}, audio_channel{4., 5., 6.}};
+  };
+  auto add_one = [](audio_inlet* in, audio_outlet* out) {
+    return [=](auto&&...) {
+      auto& src = (*in)->samples;
+      auto& sink = (*out)->samples;
+      sink.resize(src.size());
+      for (std::size_t c = 0; c < src.size(); c++)
+      {
+        sink[c].resize(src[c].size());
+        for (std::size_t i = 0; i < src[c].size(); i++)
+          sink[c][i] = src[c][i] + 1.;
+      }
+    };
+  };
+  n2->fun = add_one(n2_in, n2_out);
+  n3->fun = add_one(n3_in, n3_out);
+  n4->fun = [&](auto&&...) { result = (*n4_in)->samples; };
+
+  g.add_node(n1);
+  g.add_node(n2);
+  g.add_node(n3);
+  g.add_node(n4);
+  g.connect(make_edge(immediate_strict_connection{}, n1_out, n2_in, n1, n2));
+  g.connect(make_edge(immediate_strict_connection{}, n2_out, n3_in, n2, n3));
+  g.connect(make_edge(immediate_strict_connection{}, n3_out, n4_in, n3, n4));
+
+  const audio_vector expected{audio_channel{3., 4., 5.}, audio_channel{6., 7., 8.}};
+  auto tick = [&] {
+    result.clear();
+    for (auto& n : {n1, n2, n3, n4})
+      n->set_enabled(true);
+    g.state(e);
+    REQUIRE(result == expected);
+  };
+
+  tick();
+
+  // Six ports, but at most three of them are used at the same time
+  REQUIRE(g.buffers().size() == 4);
+  REQUIRE(g.buffers().ports() == 6);
+  REQUIRE(g.buffers().buffers() == 3);
+
+  // The ports got their channels while running: the buffers have room for
+  // them, and are reused from one tick to the next
+  REQUIRE(!g.buffers().outdated());
+  tick();
+  REQUIRE(!g.buffers().outdated());
+
+  // Removing a node forgets its ports, and gives a new plan
+  g.remove_node(n4);
+  REQUIRE(g.buffers().size() == 0);
+  REQUIRE(g.buffers().buffers() == 3);
+  for (auto& n : {n1, n2, n3})
+    n->set_enabled(true);
+  g.state(e);
+  REQUIRE(g.buffers().size() == 3);
+  REQUIRE(g.buffers().ports() == 5);
+
+  g.add_node(n4);
+  g.connect(make_edge(immediate_strict_connection{}, n3_out, n4_in, n3, n4));
+  tick();
+
+  g.set_buffer_planning(false);
+  tick();
+  REQUIRE(g.buffers().buffers() == 0);
+  g.set_buffer_planning(true);
+  tick();
+
+  // More channels than the buffers: the extra ones keep their own memory
+  // until the graph is updated
+  n1->fun = [&](auto&&...) {
+    (*n1_out)->samples = audio_vector{
+        audio_channel{1., 2., 3.}, audio_channel{4., 5., 6.},
+        audio_channel{7., 8., 9.}};
+  };
+  const audio_vector expected3{
+      audio_channel{3., 4., 5.}, audio_channel{6., 7., 8.},
+      audio_channel{9., 10., 11.}};
+  for (int i = 0; i < 2; i++)
+  {
+    result.clear();
+    for (auto& n : {n1, n2, n3, n4})
+      n->set_enabled(true);
+    g.state(e);
+    REQUIRE(result == expected3);
+    REQUIRE(g.buffers().outdated());
+  }
+
+  g.mark_dirty();
+  result.clear();
+  for (auto& n : {n1, n2, n3, n4})
+    n->set_enabled(true);
+  g.state(e);
+  REQUIRE(result == expected3);
+  REQUIRE(!g.buffers().outdated());
+}
+
+TEST_CASE ("incremental_enabled_nodes", "incremental_enabled_nodes")
+{
+  using namespace ossia;
+  execution_state e;
+  tc_graph g;
+
+  std::vector<std::shared_ptr<node_mock>> nodes;
+  std::vector<int> runs(10);
+  for (int i = 0; i < 10; i++)
+  {
+    auto n = std::make_shared<node_mock>(inlets{}, outlets{});
+    n->fun = [&runs, i](auto&&...) { runs[i]++; };
+    g.add_node(n);
+    nodes.push_back(n);
+  }
+
+  // Only the requested nodes run
+  nodes[2]->set_enabled(true);
+  nodes[7]->set_enabled(true);
+  g.state(e);
+  REQUIRE(runs == std::vector<int>{0, 0, 1, 0, 0, 0, 0, 1, 0, 0});
+  REQUIRE(g.m_activated.empty());
+  for (auto& n : nodes)
+    REQUIRE(!n->enabled());
+
+  // A node requested twice runs once per token
+  nodes[3]->request({});
+  nodes[3]->request({});
+  REQUIRE(g.m_activated.size() == 1);
+  g.state(e);
+  REQUIRE(runs == std::vector<int>{0, 0, 1, 2, 0, 0, 0, 1, 0, 0});
+
+  // A node requested and then disabled does not run
+  nodes[4]->set_enabled(true);
+  nodes[4]->set_enabled(false);
+  nodes[5]->set_enabled(true);
+  g.state(e);
+  REQUIRE(runs == std::vector<int>{0, 0, 1, 2, 0, 1, 0, 1, 0, 0});
+
+  // Nothing is requested: nothing runs
+  g.state(e);
+  REQUIRE(runs == std::vector<int>{0, 0, 1, 2, 0, 1, 0, 1, 0, 0});
+
+  // A requested node which is removed is forgotten
+  nodes[6]->set_enabled(true);
+  g.remove_node(nodes[6]);
+  REQUIRE(g.m_activated.empty());
+  g.state(e);
+  REQUIRE(runs[6] == 0);
+  nodes[6]->set_enabled(true);
+  REQUIRE(g.m_activated.empty());
+  nodes[6]->set_enabled(false);
+}
+
+TEST_CASE ("connect_rejects_cycles", "connect_rejects_cycles")
+{
+  using namespace ossia;
+  TestDevice test;
+  base_graph g{test};
+
+  auto n1 = std::make_shared<node_mock>(
+      inlets{new value_inlet(*test.tuple_addr)},
+      outlets{new value_outlet(*test.tuple_addr)});
+  auto n2 = std::make_shared<node_mock>(
+      inlets{new value_inlet(*test.tuple_addr)},
+      outlets{new value_outlet(*test.tuple_addr)});
+  g.g.add_node(n1);
+  g.g.add_node(n2);
+
+  REQUIRE(g.g.connect(make_edge(
+      connection{immediate_strict_connection{}}, n1->root_outputs()[0],
+      n2->root_inputs()[0], n1, n2)));
+
+  // n2 -> n1 would close a cycle: neither the graph nor the ports get it
+  REQUIRE(!g.g.connect(make_edge(
+      connection{immediate_strict_connection{}}, n2->root_outputs()[0],
+      n1->root_inputs()[0], n2, n1)));
+  REQUIRE(boost::num_edges(g.g.m_graph) == 1);
+  REQUIRE(g.g.m_edges.size() == 1);
+  REQUIRE(n1->root_inputs()[0]->sources.empty());
+  REQUIRE(n2->root_outputs()[0]->targets.empty());
+
+  REQUIRE(!g.g.connect(nullptr));
+}
@@ -2,12 +2,14 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 #include <ossia/dataflow/graph/graph.hpp>
 #include <ossia/dataflow/graph/graph_static.hpp>
+#include <ossia/dataflow/graph/graph_parallel.hpp>
 #include <ossia/network/base/node_functions.hpp>
 #include "../Editor/TestUtils.hpp"
 #include <valgrind/callgrind.h>
 #include <ossia/detail/for_each.hpp>
 #include <brigand/sequences/list.hpp>
 #include <random>
+#include <cmath>
 #include <QCoreApplication>
 #include <QTextStream>
 #include <QFile>
@@ -68,6 +70,26 @@ public:
   }
 };
 
+// A node which does some work, to measure the gains of parallel execution
+class node_busy_mock final : public graph_node {
+public:
+  node_busy_mock()
+  {
+    m_inlets.push_back(new ossia::value_inlet);
+    m_outlets.push_back(new ossia::value_outlet);
+  }
+
+  void run(const token_request& t, exec_state_facade e) noexcept override
+  {
+    float x = 0.f;
+    for(int i = 0; i < 20000; i++)
+      x += std::sin(float(i));
+    sink = x;
+  }
+
+  volatile float sink{};
+};
+
 using value_mock = node_empty_mock<ossia::value_port>;
 using audio_mock = node_empty_mock<ossia::audio_port>;
 using midi_mock = node_empty_mock<ossia::midi_port>;
@@ -402,8 +424,95 @@ struct setup_random
   }
 };
 
+// Wide graphs: num_nodes / 2 independent chains of two busy nodes
+struct setup_wide_busy
+{
+  template<typename T>
+  auto operator()(int num_nodes, T& g) const
+  {
+    std::vector<std::shared_ptr<ossia::graph_node>> nodes;
+
+    for(int i = 0; i < num_nodes; i+=2)
+    {
+      auto n1 = std::make_shared<node_busy_mock>();
+      auto n2 = std::make_shared<node_busy_mock>();
+
+      nodes.push_back(n1);
+      nodes.push_back(n2);
+
+      auto edge = ossia::make_edge(ossia::immediate_strict_connection{}, n1->root_outputs()[0], n2->root_inputs()[0], n1, n2);
+      g.add_node(std::move(n1));
+      g.add_node(std::move(n2));
+      g.connect(edge);
+    }
+
+    return nodes;
+  }
+};
+
+#if defined(OSSIA_PARALLEL)
+static const constexpr auto NUM_THREADS = {1, 2, 4, 8};
+
+// Clean ticks of the parallel graph, for each thread count
+template<typename Fun>
+auto test_parallel_graph(Fun setup_fun)
+{
+  std::map<int, benchmark> benchs;
+  for(int threads : NUM_THREADS)
+  {
+    for(int num_nodes : NUM_NODES)
+    {
+      ossia::parallel_tc_graph g;
+      g.update_fun.set_thread_count(threads);
+      auto nodes = setup_fun(num_nodes, g);
+
+      ossia::execution_state e;
+      g.state(e);
+
+      double count = 0;
+      for(int i = 0; i < NUM_TAKES; i++)
+      {
+        for(auto& node : nodes)
+          node->request({});
+        auto t0 = std::chrono::high_resolution_clock::now();
+        g.state(e);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        count += std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+      }
+      benchs[threads].insert({num_nodes, count / double(NUM_TAKES)});
+    }
+  }
+  return benchs;
+}
+
+void write_parallel_bench(const std::string& name, const std::map<int, benchmark>& benchs)
+{
+  QFile f(name.c_str());
+  f.open(QIODevice::WriteOnly);
+  QTextStream ts(&f);
+  ts << "$N$";
+  for(int threads : NUM_THREADS)
+    ts << "\t" << "Par" << threads;
+  ts << "\n";
+
+  for(int n : NUM_NODES)
+  {
+    ts << n;
+    for(int threads : NUM_THREADS)
+      ts << "\t" << benchs.at(threads).at(n);
+    ts << "\n";
+  }
+}
+#endif
+
 int main()
 {
+#if defined(OSSIA_PARALLEL)
+  write_parallel_bench("parallel wide (threads)", test_parallel_graph(setup_wide_busy{}));
+  write_parallel_bench("parallel connected (threads)", test_parallel_graph(setup_parallel_connected{}));
+  write_parallel_bench("parallel address (threads)", test_parallel_graph(setup_parallel_address{}));
+#endif
+
   ossia::string_map<benchmarks> benchs;
   benchs.insert(std::make_pair("serial connected", test_graph(setup_serial_connected{})));
   benchs.insert(std::make_pair("serial address", test_graph(setup_serial_address{})));
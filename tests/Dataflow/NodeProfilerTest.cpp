@@ -0,0 +1,121 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <catch.hpp>
+#include <ossia/detail/config.hpp>
+#include <ossia/dataflow/bench_map.hpp>
+#include <ossia/dataflow/graph/graph_interface.hpp>
+#include <ossia/dataflow/graph/node_profiler.hpp>
+#include <ossia/dataflow/graph_node.hpp>
+#include <ossia/dataflow/execution_state.hpp>
+
+namespace
+{
+class labeled_node final : public ossia::graph_node
+{
+public:
+  explicit labeled_node(std::string lbl) : m_label{std::move(lbl)}
+  {
+  }
+
+  std::string label() const noexcept override
+  {
+    return m_label;
+  }
+
+  void run(const ossia::token_request&, ossia::exec_state_facade) noexcept override
+  {
+  }
+
+private:
+  std::string m_label;
+};
+}
+
+TEST_CASE("test_node_profiler", "test_node_profiler")
+{
+  auto profiler = std::make_shared<ossia::node_profiler>(64);
+
+  ossia::graph_setup_options opt;
+  opt.scheduling = ossia::graph_setup_options::StaticTC;
+  opt.profiler = profiler;
+  auto g = ossia::make_graph(opt);
+
+  auto n1 = std::make_shared<labeled_node>("first");
+  auto n2 = std::make_shared<labeled_node>("second");
+  g->add_node(n1);
+  g->add_node(n2);
+
+  ossia::execution_state e;
+  for (int i = 0; i < 10; i++)
+  {
+    n1->request({});
+    n2->request({});
+    g->state(e);
+  }
+
+  auto stats = profiler->statistics();
+  REQUIRE(stats.size() == 2);
+  for (auto& st : stats)
+  {
+    REQUIRE(st.count == 10);
+    REQUIRE((st.label == "first" || st.label == "second"));
+    REQUIRE(st.min <= st.p50);
+    REQUIRE(st.p50 <= st.p99);
+    REQUIRE(st.p99 <= st.max);
+  }
+
+  auto trace = profiler->chrome_trace();
+  REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+  REQUIRE(trace.find("\"second\"") != std::string::npos);
+
+  // More events than the capacity of the ring buffer: the oldest are lost
+  for (int i = 0; i < 100; i++)
+  {
+    n1->request({});
+    n2->request({});
+    g->state(e);
+  }
+  stats = profiler->statistics();
+  uint64_t total = 0;
+  for (auto& st : stats)
+    total += st.count;
+  REQUIRE(total + profiler->dropped() == 220);
+
+  // The statistics of the nodes removed from the graph are forgotten
+  g->remove_node(n2);
+  n1->request({});
+  g->state(e);
+  stats = profiler->statistics();
+  REQUIRE(stats.size() == 1);
+  REQUIRE(stats[0].label == "first");
+
+  g->clear();
+}
+
+TEST_CASE("test_node_profiler_bench", "test_node_profiler_bench")
+{
+  // The profiler does not replace the benchmark when both are requested
+  auto profiler = std::make_shared<ossia::node_profiler>(64);
+  auto bench = std::make_shared<ossia::bench_map>();
+  bench->measure = true;
+
+  ossia::graph_setup_options opt;
+  opt.scheduling = ossia::graph_setup_options::StaticTC;
+  opt.profiler = profiler;
+  opt.bench = bench;
+  auto g = ossia::make_graph(opt);
+
+  auto n1 = std::make_shared<labeled_node>("first");
+  g->add_node(n1);
+
+  ossia::execution_state e;
+  n1->request({});
+  g->state(e);
+
+  REQUIRE(profiler->statistics().size() == 1);
+  REQUIRE(bench->count(n1.get()) == 1);
+  REQUIRE((*bench)[n1.get()].has_value());
+
+  g->clear();
+}
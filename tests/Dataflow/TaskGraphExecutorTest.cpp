@@ -0,0 +1,52 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <catch.hpp>
+#include <ossia/dataflow/graph/task_graph_executor.hpp>
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+TEST_CASE("test_task_graph_executor", "test_task_graph_executor")
+{
+  std::mt19937 mt{1234};
+
+  for (int threads : {1, 2, 4, 8})
+  {
+    ossia::task_graph_executor ex{threads};
+    REQUIRE(ex.thread_count() == threads);
+
+    for (int graph = 0; graph < 10; graph++)
+    {
+      const int N = std::uniform_int_distribution<int>{0, 200}(mt);
+      std::vector<std::pair<int, int>> precedences;
+      for (int i = 0; i < N; i++)
+        for (int j = i + 1; j < N; j++)
+          if (std::uniform_real_distribution<double>{}(mt) < 0.03)
+            precedences.emplace_back(i, j);
+
+      ex.set_graph(N, precedences);
+
+      for (int run = 0; run < 20; run++)
+      {
+        std::vector<std::atomic_int> done(N);
+        std::atomic_int errors{};
+        auto task = [&](int t) {
+          for (auto [before, after] : precedences)
+            if (after == t && !done[before].load())
+              errors++;
+          if (done[t].exchange(1))
+            errors++;
+        };
+
+        ex.run(task);
+
+        for (int i = 0; i < N; i++)
+          if (!done[i].load())
+            errors++;
+        REQUIRE(errors == 0);
+      }
+    }
+  }
+}
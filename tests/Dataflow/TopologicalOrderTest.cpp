@@ -0,0 +1,86 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <catch.hpp>
+#include <ossia/dataflow/graph/dynamic_topological_order.hpp>
+
+#include <random>
+#include <vector>
+
+using edge_list = std::vector<std::pair<int, int>>;
+
+static bool has_path(int n, const edge_list& edges, int from, int to)
+{
+  std::vector<int> stack{from};
+  std::vector<char> visited(n);
+  visited[from] = true;
+  while (!stack.empty())
+  {
+    int v = stack.back();
+    stack.pop_back();
+    if (v == to)
+      return true;
+    for (auto [a, b] : edges)
+    {
+      if (a == v && !visited[b])
+      {
+        visited[b] = true;
+        stack.push_back(b);
+      }
+    }
+  }
+  return false;
+}
+
+TEST_CASE("test_dynamic_topological_order", "test_dynamic_topological_order")
+{
+  std::mt19937 mt{42};
+
+  for (int graph = 0; graph < 100; graph++)
+  {
+    ossia::dynamic_topological_order order;
+    edge_list edges;
+    int n = 0;
+
+    for (int step = 0; step < 200; step++)
+    {
+      const int op = mt() % 10;
+      if (op < 2 || n < 2)
+      {
+        REQUIRE(order.add_vertex() == n);
+        n++;
+      }
+      else if (op < 7)
+      {
+        const int a = mt() % n, b = mt() % n;
+        const bool cycle = a == b || has_path(n, edges, b, a);
+        REQUIRE(order.add_edge(a, b) == !cycle);
+        if (!cycle)
+          edges.emplace_back(a, b);
+      }
+      else if (op < 9 && !edges.empty())
+      {
+        const int k = mt() % edges.size();
+        order.remove_edge(edges[k].first, edges[k].second);
+        edges.erase(edges.begin() + k);
+      }
+      else
+      {
+        const int v = mt() % n;
+        edge_list remaining;
+        for (auto [a, b] : edges)
+          if (a != v && b != v)
+            remaining.emplace_back(a - (a > v), b - (b > v));
+        edges = std::move(remaining);
+        order.remove_vertex(v);
+        n--;
+      }
+
+      REQUIRE(int(order.size()) == n);
+      for (int v = 0; v < n; v++)
+        REQUIRE(order.order()[order.position(v)] == v);
+      for (auto [a, b] : edges)
+        REQUIRE(order.position(a) < order.position(b));
+    }
+  }
+}
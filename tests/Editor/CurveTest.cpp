@@ -11,6 +11,7 @@
 #include <catch2/catch_approx.hpp>
 
 #include <iostream>
+#include <vector>
 
 using namespace ossia;
 
@@ -135,3 +136,32 @@ TEST_CASE ("test_destination", "test_destination")
   REQUIRE(c->value_at(0.5) == 0.5);
   REQUIRE(c->value_at(1.) == 1.);
 }
+
+TEST_CASE ("test_value_at_block", "test_value_at_block")
+{
+  curve<double, float> c;
+  c.set_x0(0.);
+  c.set_y0(0.);
+  c.add_point(curve_segment_linear<float>{}, 1., 1.);
+  c.add_point(curve_segment_power<float>{}(2.), 2., 0.);
+  c.add_point(
+      [](double ratio, float start, float end) {
+        return start + float(ratio) * (end - start);
+      },
+      3., 2.);
+
+  // Goes past both ends of the curve
+  const double x0 = -0.5;
+  const double dx = 0.01;
+  std::vector<float> block(400);
+  c.value_at_block(x0, dx, block.size(), block.data());
+
+  curve<double, float> ref = c;
+  for (std::size_t i = 0; i < block.size(); i++)
+    REQUIRE(block[i] == Catch::Approx(ref.value_at(x0 + i * dx)));
+
+  // Backwards
+  c.value_at_block(3.5, -dx, block.size(), block.data());
+  for (std::size_t i = 0; i < block.size(); i++)
+    REQUIRE(block[i] == Catch::Approx(ref.value_at(3.5 - i * dx)));
+}
@@ -4,8 +4,12 @@
 #include <catch.hpp>
 #include <ossia/detail/config.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <ossia/network/value/value.hpp>
+#include <ossia/network/value/value_cell.hpp>
 #include <ossia/network/value/detail/value_parse_impl.hpp>
 #include <ossia/network/generic/generic_device.hpp>
 #include "TestUtils.hpp"
@@ -601,3 +605,87 @@ TEST_CASE ("test_behavior", "test_behavior")
 {
   //! \todo test clone()
 }
+
+/*! test value_cell */
+TEST_CASE ("test_value_cell", "test_value_cell")
+{
+  value_cell cell;
+  REQUIRE(!cell.load().valid());
+
+  const std::vector<ossia::value> values{
+      float(1.5), int(3), vec2f{1., 2.}, vec3f{1., 2., 3.},
+      vec4f{1., 2., 3., 4.}, impulse{}, true, 'c', std::string("foo"),
+      std::vector<ossia::value>{int(1), std::string("bar")}};
+
+  for (auto& v : values)
+  {
+    cell.store(v);
+    REQUIRE(cell.load() == v);
+  }
+
+  // From a string to an inline value and back
+  cell.store(int(4));
+  REQUIRE(cell.load() == ossia::value{int(4)});
+  cell.store(std::string("baz"));
+  REQUIRE(cell.load() == ossia::value{std::string("baz")});
+
+  // Readers always see one of the values written, never a mix of two
+  cell.store(vec4f{0., 0., 0., 0.});
+  std::atomic_bool running{true};
+  std::atomic_int errors{};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++)
+  {
+    readers.emplace_back([&] {
+      while (running)
+      {
+        auto v = cell.load();
+        if (auto vec = v.target<vec4f>())
+        {
+          if ((*vec)[0] != (*vec)[3])
+            errors++;
+        }
+        else if (auto str = v.target<std::string>())
+        {
+          if (str->size() != 16 || str->front() != str->back())
+            errors++;
+        }
+        else
+        {
+          errors++;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < 20000; i++)
+  {
+    const float f = float(i);
+    if (i % 2)
+      cell.store(vec4f{f, f, f, f});
+    else
+      cell.store(std::string(16, char('a' + i % 26)));
+  }
+
+  // The previous values may be freed after the writers' lock is released
+  std::mutex write_mutex;
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 2; w++)
+  {
+    writers.emplace_back([&, w] {
+      for (int i = 0; i < 10000; i++)
+      {
+        value_cell::retired previous;
+        std::lock_guard<std::mutex> lock{write_mutex};
+        previous = cell.store(std::string(16, char('a' + (i + w) % 26)));
+      }
+    });
+  }
+  for (auto& t : writers)
+    t.join();
+  running = false;
+  for (auto& t : readers)
+    t.join();
+
+  REQUIRE(errors == 0);
+}
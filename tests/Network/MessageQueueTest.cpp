@@ -0,0 +1,133 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <catch.hpp>
+#include <ossia/detail/config.hpp>
+
+#include <ossia/network/base/message_queue.hpp>
+#include <ossia/network/generic/generic_device.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace ossia;
+
+static std::vector<received_value> drain(message_queue& mq)
+{
+  std::vector<received_value> res;
+  received_value v;
+  while (mq.try_dequeue(v))
+    res.push_back(v);
+  return res;
+}
+
+TEST_CASE ("test_message_queue_unbounded", "test_message_queue_unbounded")
+{
+  net::generic_device device{"test"};
+  auto p = net::create_node(device.get_root_node(), "/a").create_parameter(val_type::INT);
+
+  message_queue mq{device};
+  mq.reg(*p);
+  for (int i = 0; i < 100; i++)
+    p->push_value(i);
+
+  auto values = drain(mq);
+  REQUIRE(values.size() == 100);
+  REQUIRE(values.front().address == p);
+  REQUIRE(values.back().value == ossia::value{99});
+  REQUIRE(mq.stats().dropped == 0);
+  REQUIRE(mq.stats().coalesced == 0);
+}
+
+TEST_CASE ("test_message_queue_bounded", "test_message_queue_bounded")
+{
+  net::generic_device device{"test"};
+  auto p = net::create_node(device.get_root_node(), "/a").create_parameter(val_type::INT);
+
+  message_queue mq{device};
+  mq.reg(*p, {message_queue_policy::bounded, 10});
+  for (int i = 0; i < 100; i++)
+    p->push_value(i);
+
+  // The first values are kept
+  auto values = drain(mq);
+  REQUIRE(values.size() == 10);
+  REQUIRE(values.back().value == ossia::value{9});
+  REQUIRE(mq.stats().dropped == 90);
+
+  // Once dequeued, there is room again
+  p->push_value(100);
+  values = drain(mq);
+  REQUIRE(values.size() == 1);
+  REQUIRE(values.front().value == ossia::value{100});
+}
+
+TEST_CASE ("test_message_queue_coalescing", "test_message_queue_coalescing")
+{
+  net::generic_device device{"test"};
+  auto a = net::create_node(device.get_root_node(), "/a").create_parameter(val_type::INT);
+  auto b = net::create_node(device.get_root_node(), "/b").create_parameter(val_type::INT);
+
+  message_queue mq{device};
+  mq.reg(*a, {message_queue_policy::coalescing, 1});
+  mq.reg(*b, {message_queue_policy::coalescing, 3});
+
+  for (int i = 0; i < 100; i++)
+  {
+    a->push_value(i);
+    b->push_value(i);
+  }
+
+  // The last values are kept, in order
+  auto values = drain(mq);
+  REQUIRE(values.size() == 4);
+  std::vector<int> from_b;
+  for (auto& v : values)
+  {
+    if (v.address == a)
+      REQUIRE(v.value == ossia::value{99});
+    else
+      from_b.push_back(v.value.get<int>());
+  }
+  REQUIRE(from_b == std::vector<int>{97, 98, 99});
+  REQUIRE(mq.stats().coalesced == 99 + 97);
+
+  // The slots are queued again by the next values
+  a->push_value(1000);
+  values = drain(mq);
+  REQUIRE(values.size() == 1);
+  REQUIRE(values.front().value == ossia::value{1000});
+  REQUIRE(drain(mq).empty());
+
+  // Values set from another thread while the queue is drained
+  std::thread t{[&] {
+    for (int i = 0; i <= 10000; i++)
+      a->push_value(i);
+  }};
+  int last = -1;
+  while (last != 10000)
+  {
+    received_value v;
+    while (mq.try_dequeue(v))
+    {
+      const int cur = v.value.get<int>();
+      REQUIRE(cur > last);
+      last = cur;
+    }
+  }
+  t.join();
+
+  // The coalesced values come before the older unbounded ones
+  auto c = net::create_node(device.get_root_node(), "/c").create_parameter(val_type::INT);
+  mq.reg(*c);
+  c->push_value(1);
+  a->push_value(2);
+  values = drain(mq);
+  REQUIRE(values.size() == 2);
+  REQUIRE(values[0].address == a);
+  REQUIRE(values[1].address == c);
+
+  mq.unreg(*a);
+  a->push_value(1);
+  REQUIRE(drain(mq).empty());
+}
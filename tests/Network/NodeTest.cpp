@@ -71,6 +71,61 @@ TEST_CASE ("test_instances", "test_instances")
   REQUIRE((ossia::net::create_node(dev, "/foo/flop.2").get_name()) == "flop.5");
 }
 
+TEST_CASE ("test_wide_tree", "test_wide_tree")
+{
+  // Enough children for the parent to look them up by hash
+  ossia::net::generic_device dev;
+  auto& root = dev.get_root_node();
+  for(int i = 0; i < 100; i++)
+  {
+    auto n = root.create_child("light");
+    REQUIRE(n->get_name() == (i == 0 ? "light" : "light." + std::to_string(i)));
+  }
+  REQUIRE(root.children().size() == 100);
+  REQUIRE(root.find_child("light.42")->get_name() == "light.42");
+  REQUIRE(root.find_child("light.100") == nullptr);
+
+  REQUIRE(root.remove_child("light.99"));
+  REQUIRE(root.find_child("light.99") == nullptr);
+  REQUIRE(root.create_child("light")->get_name() == "light.99");
+
+  auto n = root.find_child("light.42");
+  n->set_name("dimmer");
+  REQUIRE(root.find_child("light.42") == nullptr);
+  REQUIRE(root.find_child("dimmer") == n);
+  root.find_child("light.12")->set_name("dimmer");
+  REQUIRE(root.find_child("dimmer.1")->get_name() == "dimmer.1");
+
+  REQUIRE(root.add_child(std::make_unique<generic_node>("dimmer", dev, root)) == nullptr);
+  REQUIRE(root.add_child(std::make_unique<generic_node>("spot", dev, root)) != nullptr);
+  REQUIRE(root.find_child("spot") != nullptr);
+
+  auto created = root.create_children({"light", "light.5", "bar", "bar"});
+  REQUIRE(created.size() == 4);
+  REQUIRE(created[0]->get_name() == "light.100");
+  REQUIRE(created[1]->get_name() == "light.101");
+  REQUIRE(created[2]->get_name() == "bar");
+  REQUIRE(created[3]->get_name() == "bar.1");
+  REQUIRE(root.find_child("bar.1") == created[3]);
+
+  // Removals keep the order of the remaining children
+  REQUIRE(root.remove_child("light"));
+  REQUIRE(root.remove_child("light.3"));
+  REQUIRE(root.remove_child(*root.find_child("light.2")));
+  REQUIRE(root.remove_child("bar.1"));
+  REQUIRE(!root.remove_child("light.3"));
+  auto names = root.children_names();
+  REQUIRE(names.size() == 100);
+  REQUIRE(names[0] == "light.1");
+  REQUIRE(names[1] == "light.4");
+  REQUIRE(names.back() == "bar");
+  REQUIRE(root.find_child("light.4") == root.children_copy()[1]);
+
+  root.clear_children();
+  REQUIRE(root.find_child("light") == nullptr);
+  REQUIRE(root.create_child("light")->get_name() == "light");
+}
+
 /*! test edition functions */
 TEST_CASE ("test_edition", "test_edition")
 {
@@ -183,8 +238,56 @@ TEST_CASE ("test_path", "test_path")
 TEST_CASE ("test_callback", "test_callback")
 {
   ossia::net::generic_device device{"test"};
-
-  /* TODO */
+  auto& node = create_node(device.get_root_node(), "/foo");
+  auto param = node.create_parameter(val_type::INT);
+
+  int received = 0;
+  auto first = param->add_callback([&](const ossia::value& v) {
+    received += v.get<int>();
+  });
+  REQUIRE(param->callback_count() == 1);
+
+  param->push_value(1);
+  REQUIRE(received == 1);
+
+  // A callback can remove itself, and add other callbacks, while it runs
+  ossia::net::parameter_base::callback_index self;
+  int self_calls = 0;
+  self = param->add_callback([&](const ossia::value&) {
+    self_calls++;
+    param->remove_callback(self);
+    param->add_callback([&](const ossia::value& v) {
+      received += 10 * v.get<int>();
+    });
+  });
+  REQUIRE(param->callback_count() == 2);
+
+  param->push_value(2);
+  REQUIRE(self_calls == 1);
+  REQUIRE(received == 3);
+  REQUIRE(param->callback_count() == 2);
+
+  param->push_value(3);
+  REQUIRE(self_calls == 1);
+  REQUIRE(received == 36);
+
+  param->remove_callback(first);
+  REQUIRE(param->callback_count() == 1);
+
+  // The state of a callback is kept when the others change
+  int calls = 0;
+  param->add_callback([&calls, n = 0](const ossia::value&) mutable {
+    calls = ++n;
+  });
+  param->push_value(4);
+  auto other = param->add_callback([](const ossia::value&) {});
+  param->push_value(5);
+  param->remove_callback(other);
+  param->push_value(6);
+  REQUIRE(calls == 3);
+
+  param->callbacks_clear();
+  REQUIRE(param->callbacks_empty());
 }
 
 TEST_CASE ("test_complex_type", "test_complex_type")
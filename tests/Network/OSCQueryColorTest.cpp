@@ -46,9 +46,10 @@ TEST_CASE ("test_osc_receive_rgba8", "test_osc_receive_rgba8")
 
   oscpack::ReceivedMessage m(oscpack::ReceivedPacket{expected.data(), expected.size()});
 
-  ossia::net::listened_parameters p;
+  ossia::net::osc_address_index idx;
+  idx.attach(dev.device);
   network_logger l;
-  ossia::net::handle_osc_message<true>(m, p, dev.device, l);
+  ossia::net::handle_osc_message<true>(m, idx, dev.device, l);
 
   REQUIRE(dev.vec4f_addr->value() == ossia::value{ossia::make_vec(0, 59, 111, 255)});
 }
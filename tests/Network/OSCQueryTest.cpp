@@ -7,6 +7,8 @@
 #include <ossia/context.hpp>
 #include <ossia/network/oscquery/detail/json_parser.hpp>
 #include <ossia/network/oscquery/detail/json_writer.hpp>
+#include <ossia/network/oscquery/detail/namespace_cache.hpp>
+#include <ossia/network/oscquery/detail/outbound_queue.hpp>
 #include <iostream>
 #include <ossia/network/oscquery/oscquery_mirror.hpp>
 #include <ossia/network/oscquery/oscquery_server.hpp>
@@ -1142,3 +1144,313 @@ TEST_CASE ("test_oscquery_value", "test_oscquery_value")
     REQUIRE(v == std::vector<value>{"yes",true,std::vector<value>{2,3},4.4f,2,'a'});
   }
 }
+
+TEST_CASE ("test_oscquery_listen_filter", "test_oscquery_listen_filter")
+{
+  // Here we check that the server only sends a value to the clients
+  // which asked for it with LISTEN
+  auto serv_proto = new ossia::oscquery::oscquery_server_protocol{1234, 5678};
+  generic_device serv{std::unique_ptr<ossia::net::protocol_base>(serv_proto), "A"};
+  auto a = find_or_create_node(serv, "/a").create_parameter(ossia::val_type::FLOAT);
+  auto b = find_or_create_node(serv, "/b").create_parameter(ossia::val_type::FLOAT);
+  a->push_value(1.f);
+  b->push_value(1.f);
+
+  // WS client
+  auto ws_proto = new ossia::oscquery::oscquery_mirror_protocol("ws://127.0.0.1:5678", 10001);
+  std::unique_ptr<generic_device> ws_clt{new generic_device{std::unique_ptr<ossia::net::protocol_base>(ws_proto), "B"}};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ws_proto->update(ws_clt->get_root_node());
+
+  auto clt_a = find_node(ws_clt->get_root_node(), "/a");
+  auto clt_b = find_node(ws_clt->get_root_node(), "/b");
+  REQUIRE(clt_a);
+  REQUIRE(clt_b);
+  REQUIRE(clt_a->get_parameter()->value() == ossia::value(1.f));
+  REQUIRE(clt_b->get_parameter()->value() == ossia::value(1.f));
+
+  // A client which never sent LISTEN gets every value
+  b->push_value(1.5f);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  REQUIRE(clt_b->get_parameter()->value() == ossia::value(1.5f));
+
+  // Sends LISTEN for /a
+  auto cb = clt_a->get_parameter()->add_callback([] (const ossia::value&) { });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  a->push_value(2.f);
+  b->push_value(2.f);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  REQUIRE(clt_a->get_parameter()->value() == ossia::value(2.f));
+  REQUIRE(clt_b->get_parameter()->value() == ossia::value(1.5f));
+
+  // Without the filter, every client gets every value
+  serv_proto->set_listen_filter(false);
+  b->push_value(3.f);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  REQUIRE(clt_b->get_parameter()->value() == ossia::value(3.f));
+
+  clt_a->get_parameter()->remove_callback(cb);
+}
+
+TEST_CASE ("test_oscquery_outbound_queue", "test_oscquery_outbound_queue")
+{
+  ossia::oscquery::outbound_queue q{4};
+  REQUIRE(q.empty());
+
+  // Appended while the client keeps up
+  q.push("/a", "a1");
+  q.push("/a", "a2");
+  REQUIRE(q.size() == 2);
+  REQUIRE(q.stats().coalesced == 0);
+
+  // Replaced while it does not
+  q.set_coalescing(true);
+  q.push("/b", "b1");
+  q.push("/a", "a3");
+  REQUIRE(q.size() == 3);
+  REQUIRE(q.stats().coalesced == 1);
+
+  // Critical messages are never replaced, and keep their order
+  q.push("/a", "c1", true);
+  q.push("/a", "a4");
+  q.push("/a", "a5");
+  REQUIRE(q.size() == 5);
+  REQUIRE(q.stats().coalesced == 2);
+
+  // A full queue replaces the messages too, but never drops a new path
+  q.set_coalescing(false);
+  q.push("/b", "b2");
+  q.push("/c", "c2");
+  REQUIRE(q.size() == 6);
+  REQUIRE(q.stats().coalesced == 3);
+
+  std::string sent;
+  q.flush([&] (const char* data, std::size_t sz) { sent.assign(data, sz); });
+  REQUIRE(q.empty());
+
+  // A single bundle, in order
+  std::string expected{"#bundle\0", 8};
+  expected += std::string{"\0\0\0\0\0\0\0\1", 8};
+  for (auto m : {"a1", "a3", "b2", "c1", "a5", "c2"})
+    expected += std::string{"\0\0\0\2", 4} + m;
+  REQUIRE(sent == expected);
+  REQUIRE(q.stats().sent_bytes == expected.size());
+}
+
+TEST_CASE ("test_oscquery_push_bundle", "test_oscquery_push_bundle")
+{
+  auto serv_proto = new ossia::oscquery::oscquery_server_protocol{1234, 5678};
+  generic_device serv{std::unique_ptr<ossia::net::protocol_base>(serv_proto), "A"};
+  std::vector<const ossia::net::parameter_base*> params;
+  for (auto name : {"/a", "/b", "/c"})
+  {
+    auto p = find_or_create_node(serv, name).create_parameter(ossia::val_type::INT);
+    p->push_value(0);
+    params.push_back(p);
+  }
+
+  // WS client
+  auto ws_proto = new ossia::oscquery::oscquery_mirror_protocol("ws://127.0.0.1:5678", 10001);
+  std::unique_ptr<generic_device> ws_clt{new generic_device{std::unique_ptr<ossia::net::protocol_base>(ws_proto), "B"}};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ws_proto->update(ws_clt->get_root_node());
+
+  auto clt_a = find_node(ws_clt->get_root_node(), "/a");
+  auto clt_b = find_node(ws_clt->get_root_node(), "/b");
+  auto clt_c = find_node(ws_clt->get_root_node(), "/c");
+  REQUIRE(clt_a);
+  REQUIRE(clt_b);
+  REQUIRE(clt_c);
+
+  // Sends LISTEN for /a and /b
+  auto cb_a = clt_a->get_parameter()->add_callback([] (const ossia::value&) { });
+  auto cb_b = clt_b->get_parameter()->add_callback([] (const ossia::value&) { });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  for (auto p : params)
+    const_cast<ossia::net::parameter_base*>(p)->set_value(5);
+  REQUIRE(serv_proto->push_bundle(params));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  REQUIRE(clt_a->get_parameter()->value() == ossia::value(5));
+  REQUIRE(clt_b->get_parameter()->value() == ossia::value(5));
+  REQUIRE(clt_c->get_parameter()->value() == ossia::value(0));
+
+  clt_a->get_parameter()->remove_callback(cb_a);
+  clt_b->get_parameter()->remove_callback(cb_b);
+}
+
+TEST_CASE ("test_oscquery_client_metrics", "test_oscquery_client_metrics")
+{
+  auto serv_proto = new ossia::oscquery::oscquery_server_protocol{1234, 5678};
+  generic_device serv{std::unique_ptr<ossia::net::protocol_base>(serv_proto), "A"};
+  serv_proto->set_client_metrics(true);
+
+  // WS client
+  auto ws_proto = new ossia::oscquery::oscquery_mirror_protocol("ws://127.0.0.1:5678", 10001);
+  std::unique_ptr<generic_device> ws_clt{new generic_device{std::unique_ptr<ossia::net::protocol_base>(ws_proto), "B"}};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+  serv_proto->run_commands();
+
+  for (auto name : {"queue", "coalesced", "bytes_per_second"})
+  {
+    auto node = find_node(serv, std::string("/ossia/clients/1/") + name);
+    REQUIRE(node);
+    REQUIRE(node->get_parameter());
+    REQUIRE(node->get_parameter()->value().valid());
+  }
+
+  // The node is removed with the client
+  ws_clt.reset();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  serv_proto->run_commands();
+  REQUIRE(!find_node(serv, "/ossia/clients/1"));
+}
+
+TEST_CASE ("test_oscquery_namespace_cache", "test_oscquery_namespace_cache")
+{
+  // The cached namespace must be the same as the one written from scratch
+  TestDevice d;
+  auto& dev = d.device;
+  auto& n = find_or_create_node(dev, "/foo/bar");
+  auto p = n.create_parameter(ossia::val_type::FLOAT);
+  p->push_value(1.5);
+  n.set(description_attribute{}, "a parameter");
+  d.tuple_addr->push_value(std::vector<ossia::value>{1, "two", 3.f});
+
+  auto expected = [&] (const node_base& node) {
+    auto str = ossia::oscquery::json_writer::query_namespace(node);
+    return std::string(str.GetString(), str.GetSize());
+  };
+
+  ossia::oscquery::namespace_cache cache;
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+  REQUIRE(cache.size() > 0);
+
+  // Served from the cache
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+  REQUIRE(cache.query_namespace(n) == expected(n));
+
+  // The values are not cached
+  p->push_value(2.5);
+  d.string_addr->push_value("hello");
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+
+  // Neither are the children
+  find_or_create_node(dev, "/foo/baz").create_parameter(ossia::val_type::INT);
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+
+  // The attributes are, until they are invalidated
+  n.set(description_attribute{}, "another description");
+  cache.invalidate(n);
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+
+  auto foo = find_node(dev, "/foo");
+  REQUIRE(foo);
+  foo->set_name("qux");
+  cache.invalidate_subtree(*foo);
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+
+  // A node which gains or loses its parameter without being invalidated
+  // is written anew
+  auto& plain = find_or_create_node(dev, "/plain");
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+  plain.create_parameter(ossia::val_type::INT)->push_value(3);
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+  plain.remove_parameter();
+  REQUIRE(cache.query_namespace(dev) == expected(dev));
+}
+
+TEST_CASE ("test_oscquery_lazy_mirror", "test_oscquery_lazy_mirror")
+{
+  auto serv_proto = new ossia::oscquery::oscquery_server_protocol{1234, 5678};
+  generic_device serv{std::unique_ptr<ossia::net::protocol_base>(serv_proto), "A"};
+  for (auto name : {"/a/x/1", "/a/y/1", "/b/x/1", "/c/x/1"})
+    find_or_create_node(serv, name).create_parameter(ossia::val_type::INT)->push_value(1);
+
+  {
+    // With DEPTH, the children of the last level are left out
+    ossia::oscquery::namespace_cache cache;
+    auto str = cache.query_namespace(serv.get_root_node(), 1);
+    REQUIRE(str.find("\"CONTENTS\":{}") != std::string::npos);
+    REQUIRE(str.find("/a/x") == std::string::npos);
+  }
+
+  // WS client
+  auto ws_proto = new ossia::oscquery::oscquery_mirror_protocol("ws://127.0.0.1:5678", 10001);
+  ws_proto->set_zombie_on_remove(false);
+  std::unique_ptr<generic_device> ws_clt{new generic_device{std::unique_ptr<ossia::net::protocol_base>(ws_proto), "B"}};
+  ws_proto->set_lazy(true, 3);
+  auto& root = ws_clt->get_root_node();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  REQUIRE(ws_proto->update(root));
+
+  // Only the first level is mirrored
+  REQUIRE(root.children().size() == 3);
+  REQUIRE(find_node(root, "/a"));
+  REQUIRE(!find_node(root, "/a/x"));
+
+  // The other levels are requested on demand
+  auto a_x_1 = ws_proto->find_node("/a/x/1");
+  REQUIRE(a_x_1);
+  REQUIRE(a_x_1->get_parameter());
+  REQUIRE(a_x_1->get_parameter()->value() == ossia::value(1));
+  REQUIRE(!find_node(root, "/a/y/1"));
+  REQUIRE(ws_proto->expanded_count() == 3);
+
+  // The least recently used nodes lose their children
+  auto b_x_1 = ws_proto->find_node("/b/x/1");
+  REQUIRE(b_x_1);
+  REQUIRE(ws_proto->expanded_count() == 3);
+  REQUIRE(find_node(root, "/a"));
+  REQUIRE(!find_node(root, "/a/x"));
+
+  // ... unless they are in use
+  auto cb = b_x_1->get_parameter()->add_callback([] (const ossia::value&) { });
+  ws_proto->prefetch("/c/x");
+  REQUIRE(ws_proto->find_node("/c/x/1"));
+  REQUIRE(find_node(root, "/b/x/1") == b_x_1);
+
+  // The changes are applied to the mirrored nodes only
+  find_or_create_node(serv, "/c/x/2");
+  find_or_create_node(serv, "/a/z");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ws_proto->run_commands();
+  REQUIRE(find_node(root, "/c/x/2"));
+  REQUIRE(!find_node(root, "/a/z"));
+
+  serv.get_root_node().find_child("c")->find_child("x")->remove_child("2");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ws_proto->run_commands();
+  REQUIRE(!find_node(root, "/c/x/2"));
+
+  // The others get them when they are requested
+  REQUIRE(ws_proto->find_node("/a/z"));
+
+  // update_async gets the reply in the background, and applies it in
+  // run_commands
+  auto a = find_node(root, "/a");
+  REQUIRE(a);
+  auto fut = ws_proto->update_async(*a);
+  REQUIRE(fut.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+  for (int i = 0; i < 30; i++)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ws_proto->run_commands();
+    if (fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      break;
+  }
+  REQUIRE(fut.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+  fut.get();
+  REQUIRE(find_node(root, "/a/z"));
+
+  b_x_1->get_parameter()->remove_callback(cb);
+}
@@ -8,6 +8,7 @@
 
 #if defined(OSSIA_PROTOCOL_OSC)
 #include <ossia/network/osc/osc.hpp>
+#include <ossia/network/osc/detail/bundle.hpp>
 #endif
 
 #if defined(OSSIA_PROTOCOL_OSC)
@@ -126,3 +127,83 @@ TEST_CASE ("test_comm_osc", "test_comm_osc")
                       [] { return std::make_unique<ossia::net::osc_protocol>("127.0.0.1", 9997, 9996); });
   }
 #endif
+
+#if defined(OSSIA_PROTOCOL_OSC)
+TEST_CASE ("test_bundle_encoder_header", "test_bundle_encoder_header")
+  {
+    using namespace std::chrono;
+    // The unix epoch is 2208988800 seconds after the NTP one
+    REQUIRE(ossia::net::osc_timetag(system_clock::time_point{}) == (2208988800ULL << 32));
+    REQUIRE(ossia::net::osc_timetag(system_clock::time_point{milliseconds{500}}) == ((2208988800ULL << 32) | 0x80000000ULL));
+
+    std::vector<std::string> packets;
+    auto send = [&] (const char* data, std::size_t sz) { packets.emplace_back(data, sz); };
+
+    ossia::net::osc_bundle_encoder enc;
+    enc.begin(0x0102030405060708ULL);
+    enc.add_encoded("abcd", 4, send);
+    enc.end(send);
+
+    REQUIRE(packets.size() == 1);
+    std::string expected{"#bundle\0", 8};
+    expected += std::string{"\1\2\3\4\5\6\7\x08", 8};
+    expected += std::string{"\0\0\0\4abcd", 8};
+    REQUIRE(packets[0] == expected);
+
+    // Nothing is sent for an empty bundle
+    enc.begin();
+    enc.end(send);
+    REQUIRE(packets.size() == 1);
+  }
+
+TEST_CASE ("test_bundle_encoder_split", "test_bundle_encoder_split")
+  {
+    std::vector<std::string> packets;
+    auto send = [&] (const char* data, std::size_t sz) { packets.emplace_back(data, sz); };
+
+    // Room for the header and two 8-byte messages
+    ossia::net::osc_bundle_encoder enc;
+    enc.set_max_packet_size(ossia::net::osc_bundle_encoder::header_size + 2 * (4 + 8));
+
+    enc.begin(42);
+    for (auto msg : {"message1", "message2", "message3"})
+      enc.add_encoded(msg, 8, send);
+    enc.end(send);
+
+    REQUIRE(packets.size() == 2);
+    REQUIRE(packets[0].size() == enc.max_packet_size());
+    REQUIRE(packets[1].size() == ossia::net::osc_bundle_encoder::header_size + 4 + 8);
+
+    // Each packet is a complete bundle with the same time tag
+    for (const auto& p : packets)
+      REQUIRE(p.substr(0, 16) == packets[0].substr(0, 16));
+    REQUIRE(packets[0].substr(16 + 4, 8) == "message1");
+    REQUIRE(packets[0].substr(16 + 12 + 4, 8) == "message2");
+    REQUIRE(packets[1].substr(16 + 4, 8) == "message3");
+  }
+
+TEST_CASE ("test_bundle_encoder_oversized", "test_bundle_encoder_oversized")
+  {
+    std::vector<std::string> packets;
+    auto send = [&] (const char* data, std::size_t sz) { packets.emplace_back(data, sz); };
+
+    ossia::net::osc_bundle_encoder enc;
+    enc.set_max_packet_size(32);
+
+    // Bigger than the limit, and than the initial buffer
+    const std::string big(8192, 'x');
+
+    enc.begin();
+    enc.add_encoded("abcd", 4, send);
+    enc.add_encoded(big.data(), big.size(), send);
+    enc.add_encoded("efgh", 4, send);
+    enc.end(send);
+
+    // The big message goes alone in its own bundle
+    REQUIRE(packets.size() == 3);
+    REQUIRE(packets[0].size() == ossia::net::osc_bundle_encoder::header_size + 8);
+    REQUIRE(packets[1].size() == ossia::net::osc_bundle_encoder::header_size + 4 + big.size());
+    REQUIRE(packets[1].substr(20) == big);
+    REQUIRE(packets[2].substr(20) == "efgh");
+  }
+#endif